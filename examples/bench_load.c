@@ -0,0 +1,190 @@
+/**
+ * @file
+ * @brief Benchmark for loading large serialized tables with hpdftbl_load() and hpdftbl_stream_load()
+ *
+ * A synthetic serialized table of approximately 1 MB, 10 MB and 100 MB
+ * is written to the "out/" directory and then read back with both hpdftbl_load()
+ * and the streaming loader hpdftbl_stream_load(). The time to load each file is
+ * printed together with the throughput.
+ *
+ * This program is not built by default. Build and run it with
+ * ```shell
+ * $ make bench
+ * ```
+ * in the examples directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <hpdf.h>
+#include "hpdftbl.h"
+
+/** Number of columns in the synthetic table */
+#define BENCH_COLS 10
+
+/** Approximate number of bytes each cell occupies in the serialized table */
+#define BENCH_BYTES_PER_CELL 640
+
+/**
+ * @brief Write a text style block in the same format as hpdftbl_dump()
+ * @param fh File to write to
+ * @param indent Number of spaces to indent the block with
+ * @param key Name of style
+ * @param font Font name
+ * @param fsize Font size
+ * @param last TRUE if this is the last element in the enclosing block
+ */
+static void
+write_style(FILE *fh, int indent, const char *key, const char *font, double fsize, _Bool last) {
+    fprintf(fh, "%*s\"%s\": {\n", indent, "", key);
+    fprintf(fh, "%*s\"font\": \"%s\",\n", indent + 2, "", font);
+    fprintf(fh, "%*s\"fsize\": %.8f,\n", indent + 2, "", fsize);
+    fprintf(fh, "%*s\"color\": [0.20000, 0.20000, 0.20000],\n", indent + 2, "");
+    fprintf(fh, "%*s\"background\": [1.00000, 1.00000, 1.00000],\n", indent + 2, "");
+    fprintf(fh, "%*s\"halign\": 0 \n", indent + 2, "");
+    fprintf(fh, "%*s}%c\n", indent, "", last ? ' ' : ',');
+}
+
+/**
+ * @brief Write a grid style block in the same format as hpdftbl_dump()
+ * @param fh File to write to
+ * @param key Name of grid
+ */
+static void
+write_grid(FILE *fh, const char *key) {
+    fprintf(fh, "  \"%s\": {\n", key);
+    fprintf(fh, "    \"width\": 0.69999999,\n");
+    fprintf(fh, "    \"color\": [0.50000, 0.50000, 0.50000],\n");
+    fprintf(fh, "    \"dashstyle\": 0 \n");
+    fprintf(fh, "  },\n");
+}
+
+/**
+ * @brief Create a serialized table with the given number of rows
+ * @param filename File to write to
+ * @param rows Number of rows in table
+ * @return 0 on success, -1 on failure
+ */
+static int
+write_table(const char *filename, size_t rows) {
+    FILE *fh = fopen(filename, "w");
+    if (fh == NULL)
+        return -1;
+
+    fprintf(fh, "{\n\"version\": %d,\n\"table\": {\n", TABLE_JSON_VERSION);
+    fprintf(fh, "  \"tag\": \"\",\n  \"rows\": %zu,\n  \"cols\": %d,\n", rows, BENCH_COLS);
+    fprintf(fh, "  \"posx\": 28.34645653,\n  \"posy\": 813.54333496,\n");
+    fprintf(fh, "  \"height\": 0.00000000,\n  \"minrowheight\": 0.00000000,\n");
+    fprintf(fh, "  \"width\": 538.58264160,\n  \"bottom_vmargin_factor\": 0.50000000,\n");
+    fprintf(fh, "  \"title_txt\": \"Benchmark\",\n");
+    fprintf(fh, "  \"anchor_is_top_left\": true,\n  \"use_header_row\": false,\n");
+    fprintf(fh, "  \"use_cell_labels\": true,\n  \"use_label_grid_style\": true,\n");
+    fprintf(fh, "  \"use_zebra\": false,\n  \"zebra_phase\": 0,\n");
+    fprintf(fh, "  \"zebra_color1\": [1.00000, 1.00000, 1.00000],\n");
+    fprintf(fh, "  \"zebra_color2\": [0.95000, 0.95000, 0.95000],\n");
+    write_grid(fh, "outer_grid");
+    write_grid(fh, "inner_vgrid");
+    write_grid(fh, "inner_hgrid");
+    write_grid(fh, "inner_tgrid");
+    write_style(fh, 2, "content_style", "Courier", 10, FALSE);
+    write_style(fh, 2, "title_style", "Helvetica-Bold", 11, FALSE);
+    write_style(fh, 2, "header_style", "Helvetica-Bold", 10, FALSE);
+    write_style(fh, 2, "label_style", "Times-Italic", 9, FALSE);
+    fprintf(fh, "  \"col_width_percent\": [\n    ");
+    for (size_t c = 0; c < BENCH_COLS; c++) {
+        fprintf(fh, "%05f%s", 100.0 / BENCH_COLS, c < BENCH_COLS - 1 ? ", " : "");
+    }
+    fprintf(fh, "\n  ],\n");
+    fprintf(fh, "  \"label_dyncb\": \"\",\n  \"content_dyncb\": \"\",\n");
+    fprintf(fh, "  \"content_style_dyncb\": \"\",\n  \"canvas_dyncb\": \"\",\n");
+    fprintf(fh, "  \"post_dyncb\": \"\",\n  \"cells\": [\n");
+
+    for (size_t r = 0; r < rows; r++) {
+        for (size_t c = 0; c < BENCH_COLS; c++) {
+            fprintf(fh, "    {\n");
+            fprintf(fh, "      \"row\": %zu,\n      \"col\": %zu,\n", r, c);
+            fprintf(fh, "      \"label\": \"Label %zu:\",\n", c);
+            fprintf(fh, "      \"content\": \"Content %zu\",\n", r * BENCH_COLS + c);
+            fprintf(fh, "      \"colspan\": 1,\n      \"rowspan\": 1,\n");
+            fprintf(fh, "      \"height\": 0.00000000,\n      \"width\": 0.00000000,\n");
+            fprintf(fh, "      \"delta_x\": 0.00000000,\n      \"delta_y\": 0.00000000,\n");
+            fprintf(fh, "      \"textwidth\": 0.00000000,\n");
+            fprintf(fh, "      \"content_dyncb\": \"\",\n      \"label_dyncb\": \"\",\n");
+            fprintf(fh, "      \"content_style_dyncb\": \"\",\n      \"canvas_dyncb\": \"\",\n");
+            write_style(fh, 6, "content_style", "", 0, TRUE);
+            fprintf(fh, "    }%c\n", r == rows - 1 && c == BENCH_COLS - 1 ? ' ' : ',');
+        }
+    }
+    fprintf(fh, "\n  ] \n  } \n}\n");
+    return fclose(fh) == 0 ? 0 : -1;
+}
+
+/**
+ * @brief Return monotonic time in seconds
+ * @return Time in seconds
+ */
+static double
+now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Time one load of a serialized table
+ * @param loader Load function to use
+ * @param filename File to load
+ * @return Time in seconds or a negative value on failure
+ */
+static double
+time_load(int (*loader)(hpdftbl_t, char *), char *filename) {
+    hpdftbl_t tbl = hpdftbl_calloc(1, sizeof(struct hpdftbl));
+    const double start = now();
+    if (loader(tbl, filename)) {
+        fprintf(stderr, "Failed to load \"%s\"\n", filename);
+        return -1;
+    }
+    const double secs = now() - start;
+    hpdftbl_destroy(tbl);
+    return secs;
+}
+
+/**
+ * @brief Run the load benchmark for the specified file sizes
+ * @return EXIT_SUCCESS or EXIT_FAILURE
+ */
+int
+main(void) {
+    const size_t sizes_mb[] = {1, 10, 100};
+    char filename[256];
+
+    mkdir("out", 0755);
+    printf("%8s %10s %12s %10s %10s %10s %10s\n", "target", "cells", "bytes", "secs", "MB/s", "stream", "MB/s");
+
+    for (size_t i = 0; i < sizeof(sizes_mb) / sizeof(sizes_mb[0]); i++) {
+        const size_t rows = sizes_mb[i] * 1024 * 1024 / (BENCH_COLS * BENCH_BYTES_PER_CELL);
+        snprintf(filename, sizeof filename, "out/bench_load_%zuMB.json", sizes_mb[i]);
+        if (write_table(filename, rows)) {
+            fprintf(stderr, "Cannot write \"%s\"\n", filename);
+            return EXIT_FAILURE;
+        }
+
+        struct stat st;
+        stat(filename, &st);
+        const double mb = (double) st.st_size / (1024 * 1024);
+
+        const double secs = time_load(hpdftbl_load, filename);
+        const double stream_secs = time_load(hpdftbl_stream_load, filename);
+        if (secs < 0 || stream_secs < 0)
+            return EXIT_FAILURE;
+
+        printf("%6zuMB %10zu %12lld %10.3f %10.1f %10.3f %10.1f\n", sizes_mb[i], rows * BENCH_COLS,
+               (long long) st.st_size, secs, mb / secs, stream_secs, mb / stream_secs);
+        remove(filename);
+    }
+
+    return EXIT_SUCCESS;
+}
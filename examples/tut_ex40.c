@@ -19,7 +19,7 @@
  */
 void
 create_table_ex40(HPDF_Doc pdf_doc, HPDF_Page pdf_page) {
-    hpdftbl_t tbl=calloc(1, sizeof(struct hpdftbl));
+    hpdftbl_t tbl=hpdftbl_calloc(1, sizeof(struct hpdftbl));
 
 #if FROM_JSON == 1
     if(0 == hpdftbl_load(tbl, mkfullpath("tut_ex40.json"))  ) {
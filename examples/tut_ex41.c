@@ -21,7 +21,7 @@ void
 create_table_ex41(HPDF_Doc pdf_doc, HPDF_Page pdf_page) {
 
 #if FROM_JSON == 0
-    hpdftbl_t tbl = calloc(1, sizeof (struct hpdftbl));
+    hpdftbl_t tbl = hpdftbl_calloc(1, sizeof (struct hpdftbl));
     hpdftbl_theme_t theme;
 
     if(0 == hpdftbl_load(tbl, mkfullpath("tut_ex41.json"))) {
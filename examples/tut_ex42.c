@@ -0,0 +1,61 @@
+/**
+ * @file
+ */
+
+#include "unit_test.inc.h"
+
+/**
+ * Table 42 example - dump/load table in compact binary format
+ */
+void
+create_table_ex42(HPDF_Doc pdf_doc, HPDF_Page pdf_page) {
+    const size_t num_rows = 5;
+    const size_t num_cols = 4;
+    char *table_title = "tut_ex42: Table read back from binary image";
+    hpdftbl_t tbl = hpdftbl_create_title(num_rows, num_cols, table_title);
+    content_t content, labels;
+
+    setup_dummy_content_label(&content, &labels, num_rows, num_cols);
+    hpdftbl_set_content(tbl, content);
+    hpdftbl_set_labels(tbl, labels);
+
+    hpdftbl_use_labels(tbl, TRUE);
+    hpdftbl_use_labelgrid(tbl, TRUE);
+    hpdftbl_set_zebra(tbl, TRUE, 1);
+    hpdftbl_set_cellspan(tbl, 0, 0, 1, 3);
+    hpdftbl_set_cellspan(tbl, 2, 1, 2, 2);
+    hpdftbl_set_cell_content_style(tbl, 1, 1, HPDF_FF_COURIER_BOLD, 10, HPDF_COLOR_DARK_RED, HPDF_COLOR_LIGHT_GRAY);
+    hpdftbl_set_cell_content_style(tbl, 4, 3, HPDF_FF_COURIER_BOLD, 10, HPDF_COLOR_DARK_RED, HPDF_COLOR_LIGHT_GRAY);
+
+    HPDF_REAL xpos = hpdftbl_cm2dpi(1);
+    HPDF_REAL ypos = hpdftbl_cm2dpi(A4PAGE_HEIGHT_CM - 1);
+    HPDF_REAL width = hpdftbl_cm2dpi(18);
+    HPDF_REAL height = 0;  // Calculate height automatically
+    hpdftbl_setpos(tbl, xpos, ypos, width, height);
+
+    char *buff, *buff2;
+    size_t size, size2;
+    if (hpdftbl_dumpb(tbl, &buff, &size)) {
+        fprintf(stderr, "Failed to dump table\n");
+        exit(1);
+    }
+    hpdftbl_destroy(tbl);
+
+    hpdftbl_t tbl2 = hpdftbl_calloc(1, sizeof(struct hpdftbl));
+    if (hpdftbl_loadb(tbl2, buff, size)) {
+        fprintf(stderr, "Failed to load binary table image\n");
+        exit(1);
+    }
+
+    // A table read back must serialize to exactly the same image
+    if (hpdftbl_dumpb(tbl2, &buff2, &size2) || size != size2 || memcmp(buff, buff2, size)) {
+        fprintf(stderr, "Binary table image differs after read back\n");
+        exit(1);
+    }
+    hpdftbl_free(buff);
+    hpdftbl_free(buff2);
+
+    hpdftbl_stroke_pos(pdf_doc, pdf_page, tbl2);
+}
+
+TUTEX_MAIN(create_table_ex42, FALSE)
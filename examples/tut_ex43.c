@@ -0,0 +1,73 @@
+/**
+ * @file
+ */
+
+#include "unit_test.inc.h"
+
+/**
+ * Table 43 example - use a memory mapped binary image as a table template
+ */
+void
+create_table_ex43(HPDF_Doc pdf_doc, HPDF_Page pdf_page) {
+    const size_t num_rows = 4;
+    const size_t num_cols = 3;
+    char *table_title = "tut_ex43: Table created from a mapped template";
+    hpdftbl_t tbl = hpdftbl_create_title(num_rows, num_cols, table_title);
+
+    hpdftbl_use_labels(tbl, TRUE);
+    hpdftbl_use_labelgrid(tbl, TRUE);
+    hpdftbl_set_cellspan(tbl, 0, 0, 1, 3);
+    hpdftbl_set_cell(tbl, 0, 0, "Customer:", NULL);
+    hpdftbl_set_cell(tbl, 1, 0, "Item:", "Widget");
+    hpdftbl_set_cell(tbl, 1, 1, "Quantity:", NULL);
+    hpdftbl_set_cell(tbl, 1, 2, "Price:", NULL);
+    hpdftbl_set_cell(tbl, 2, 0, "Item:", "Gadget");
+    hpdftbl_set_cell(tbl, 2, 1, "Quantity:", NULL);
+    hpdftbl_set_cell(tbl, 2, 2, "Price:", NULL);
+    hpdftbl_set_cellspan(tbl, 3, 0, 1, 2);
+    hpdftbl_set_cell(tbl, 3, 0, "Note:", "Template content");
+    hpdftbl_set_cell(tbl, 3, 2, "Total:", NULL);
+
+    HPDF_REAL xpos = hpdftbl_cm2dpi(1);
+    HPDF_REAL ypos = hpdftbl_cm2dpi(A4PAGE_HEIGHT_CM - 1);
+    HPDF_REAL width = hpdftbl_cm2dpi(15);
+    HPDF_REAL height = 0;  // Calculate height automatically
+    hpdftbl_setpos(tbl, xpos, ypos, width, height);
+
+    // Store the template once
+    char template_file[] = "/tmp/tut_ex43_XXXXXX";
+    int fd = mkstemp(template_file);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot create template file\n");
+        exit(1);
+    }
+    close(fd);
+    if (hpdftbl_dump_image(tbl, template_file)) {
+        fprintf(stderr, "Failed to write template \"%s\"\n", template_file);
+        exit(1);
+    }
+    hpdftbl_destroy(tbl);
+
+    // Each render maps the template and only overlays its own content
+    char *customers[] = {"ACME Inc", "Globex Corp"};
+    char *totals[] = {"$ 120.00", "$ 12.50"};
+    for (size_t i = 0; i < 2; i++) {
+        hpdftbl_t t = hpdftbl_open_image(template_file);
+        if (t == NULL) {
+            fprintf(stderr, "Failed to open template \"%s\"\n", template_file);
+            exit(1);
+        }
+        hpdftbl_set_cell(t, 0, 0, "Customer:", customers[i]);
+        hpdftbl_set_cell(t, 1, 1, "Quantity:", i ? "1" : "10");
+        hpdftbl_set_cell(t, 1, 2, "Price:", i ? "$ 2.50" : "$ 10.00");
+        hpdftbl_set_cell(t, 2, 1, "Quantity:", i ? "2" : "4");
+        hpdftbl_set_cell(t, 2, 2, "Price:", i ? "$ 5.00" : "$ 5.00");
+        hpdftbl_set_cell(t, 3, 2, "Total:", totals[i]);
+        hpdftbl_stroke(pdf_doc, pdf_page, t, xpos, ypos - (HPDF_REAL) i * hpdftbl_cm2dpi(6), width, height);
+        hpdftbl_destroy(t);
+    }
+
+    remove(template_file);
+}
+
+TUTEX_MAIN(create_table_ex43, FALSE)
@@ -0,0 +1,49 @@
+/**
+ * @file
+ */
+
+#include "unit_test.inc.h"
+
+/**
+ * Table 45 example - column widths calculated from the content
+ */
+void
+create_table_ex45(HPDF_Doc pdf_doc, HPDF_Page pdf_page) {
+    const size_t num_rows = 4;
+    const size_t num_cols = 4;
+    char *content[] = {
+            "Id", "Product", "Description", "Price",
+            "1", "Widget", "A small widget", "$ 10.00",
+            "2", "Gadget", "A gadget with many features", "$ 125.00",
+            "3", "Gizmo", "Gizmo", "$ 1.50"};
+    char *long_content[] = {
+            "Id", "Product", "Description", "Price",
+            "1", "Widget", "A small widget that is used in almost every machine ever built", "$ 10.00",
+            "2", "Gadget", "A gadget with so many features that the description does not fit", "$ 125.00",
+            "3", "Gizmo", "Gizmo", "$ 1.50"};
+
+    // A table that is only as wide as its content
+    hpdftbl_t tbl = hpdftbl_create_title(num_rows, num_cols, "tut_ex45: Column width from content");
+    hpdftbl_use_header(tbl, TRUE);
+    hpdftbl_set_content(tbl, content);
+    hpdftbl_set_auto_colwidth(tbl, TRUE);
+
+    HPDF_REAL xpos = hpdftbl_cm2dpi(1);
+    HPDF_REAL ypos = hpdftbl_cm2dpi(A4PAGE_HEIGHT_CM - 1);
+    hpdftbl_stroke(pdf_doc, pdf_page, tbl, xpos, ypos, 0, 0);
+    hpdftbl_destroy(tbl);
+
+    // A table whose content is wider than the maximum width is shrunk but the
+    // price column is never narrower than 2cm
+    tbl = hpdftbl_create_title(num_rows, num_cols, "tut_ex45: Column width shrunk to 15cm");
+    hpdftbl_use_header(tbl, TRUE);
+    hpdftbl_set_content(tbl, long_content);
+    hpdftbl_set_auto_colwidth(tbl, TRUE);
+    hpdftbl_set_colwidth_min(tbl, 3, hpdftbl_cm2dpi(2));
+
+    ypos -= hpdftbl_cm2dpi(5);
+    hpdftbl_stroke(pdf_doc, pdf_page, tbl, xpos, ypos, hpdftbl_cm2dpi(15), 0);
+    hpdftbl_destroy(tbl);
+}
+
+TUTEX_MAIN(create_table_ex45, FALSE)
@@ -0,0 +1,35 @@
+/**
+ * @file
+ */
+
+#include "unit_test.inc.h"
+
+/**
+ * Table 46 example - word wrapped content
+ */
+void
+create_table_ex46(HPDF_Doc pdf_doc, HPDF_Page pdf_page) {
+    const size_t num_rows = 4;
+    const size_t num_cols = 3;
+    char *content[] = {
+            "Product", "Description", "Price",
+            "Widget", "A small widget that is used in almost every machine that has ever been built", "$ 10.00",
+            "Gadget", "A gadget with so many features that the description needs several lines. "
+                      "There is even a second sentence.", "$ 125.00",
+            "Gizmo", "Short", "$ 1.50"};
+
+    // Wrap the description column. The row heights grow with the number of lines.
+    hpdftbl_t tbl = hpdftbl_create_title(num_rows, num_cols, "tut_ex46: Word wrapped description column");
+    hpdftbl_use_header(tbl, TRUE);
+    hpdftbl_set_content(tbl, content);
+    hpdftbl_set_colwidth_percent(tbl, 0, 20);
+    hpdftbl_set_colwidth_percent(tbl, 2, 20);
+    hpdftbl_set_col_wrap_mode(tbl, 1, WRAP_WORD);
+
+    HPDF_REAL xpos = hpdftbl_cm2dpi(1);
+    HPDF_REAL ypos = hpdftbl_cm2dpi(A4PAGE_HEIGHT_CM - 1);
+    hpdftbl_stroke(pdf_doc, pdf_page, tbl, xpos, ypos, hpdftbl_cm2dpi(12), 0);
+    hpdftbl_destroy(tbl);
+}
+
+TUTEX_MAIN(create_table_ex46, FALSE)
@@ -0,0 +1,50 @@
+/**
+ * @file
+ */
+
+#include "unit_test.inc.h"
+
+/**
+ * Table 47 example - row heights calculated from the content
+ */
+void
+create_table_ex47(HPDF_Doc pdf_doc, HPDF_Page pdf_page) {
+    const size_t num_rows = 5;
+    const size_t num_cols = 3;
+    char *labels[] = {
+            "", "", "",
+            "Name:", "Notes:", "Status:",
+            "Name:", "Notes:", "Status:",
+            "Name:", "", "Status:",
+            "Name:", "Notes:", "Status:"};
+    char *content[] = {
+            "Task", "Notes", "Status",
+            "Design", "Agreed with the customer after the second review meeting", "Done",
+            "Implementation", "The new layout engine is ready but the old API must still work "
+                              "and all existing examples must give identical output", "Ongoing",
+            "Test", "", "Planned",
+            "Release", "-", "Planned"};
+
+    hpdftbl_t tbl = hpdftbl_create_title(num_rows, num_cols, "tut_ex47: Row height from content");
+    hpdftbl_use_header(tbl, TRUE);
+    hpdftbl_use_labels(tbl, TRUE);
+    hpdftbl_use_labelgrid(tbl, TRUE);
+    hpdftbl_set_labels(tbl, labels);
+    hpdftbl_set_content(tbl, content);
+    hpdftbl_set_colwidth_percent(tbl, 0, 25);
+    hpdftbl_set_colwidth_percent(tbl, 2, 20);
+    hpdftbl_set_col_wrap_mode(tbl, 1, WRAP_WORD);
+    hpdftbl_set_auto_rowheight(tbl, TRUE);
+
+    // The notes for the test spans two rows and the release row uses a larger font
+    hpdftbl_set_cellspan(tbl, 3, 1, 2, 1);
+    hpdftbl_set_cell_content_style(tbl, 4, 0, HPDF_FF_HELVETICA_BOLD, 14,
+                                   HPDF_COLOR_DARK_RED, HPDF_COLOR_WHITE);
+
+    HPDF_REAL xpos = hpdftbl_cm2dpi(1);
+    HPDF_REAL ypos = hpdftbl_cm2dpi(A4PAGE_HEIGHT_CM - 1);
+    hpdftbl_stroke(pdf_doc, pdf_page, tbl, xpos, ypos, hpdftbl_cm2dpi(15), 0);
+    hpdftbl_destroy(tbl);
+}
+
+TUTEX_MAIN(create_table_ex47, FALSE)
@@ -0,0 +1,39 @@
+/**
+ * @file
+ */
+
+#include "unit_test.inc.h"
+
+/**
+ * Table 48 example - handling of content that is wider than its cell
+ */
+void
+create_table_ex48(HPDF_Doc pdf_doc, HPDF_Page pdf_page) {
+    const size_t num_rows = 4;
+    const size_t num_cols = 4;
+    char *content[] = {
+            "Account", "Description", "Reference", "Amount",
+            "1910", "Cash and cash equivalents held in the main bank account", "BANK-2022-000123-A", "1 234 567.89",
+            "2440", "Accounts payable", "AP-77", "-98 765 432.10",
+            "3010", "Sales of goods and services, domestic customers", "INV-2022-004711", "123 456 789 012.34"};
+
+    hpdftbl_t tbl = hpdftbl_create_title(num_rows, num_cols, "tut_ex48: Clip, ellipsis and shrink");
+    hpdftbl_use_header(tbl, TRUE);
+    hpdftbl_set_content(tbl, content);
+    hpdftbl_set_colwidth_percent(tbl, 0, 12);
+    hpdftbl_set_colwidth_percent(tbl, 1, 40);
+    hpdftbl_set_colwidth_percent(tbl, 2, 28);
+
+    // Long descriptions are cut and end with "...", references are just cut and
+    // amounts are never cut but written with a smaller font when necessary.
+    hpdftbl_set_col_overflow(tbl, 1, OVERFLOW_ELLIPSIS);
+    hpdftbl_set_col_overflow(tbl, 2, OVERFLOW_CLIP);
+    hpdftbl_set_col_overflow(tbl, 3, OVERFLOW_SHRINK);
+
+    HPDF_REAL xpos = hpdftbl_cm2dpi(1);
+    HPDF_REAL ypos = hpdftbl_cm2dpi(A4PAGE_HEIGHT_CM - 1);
+    hpdftbl_stroke(pdf_doc, pdf_page, tbl, xpos, ypos, hpdftbl_cm2dpi(15), 0);
+    hpdftbl_destroy(tbl);
+}
+
+TUTEX_MAIN(create_table_ex48, FALSE)
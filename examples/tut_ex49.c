@@ -0,0 +1,46 @@
+/**
+ * @file
+ */
+
+#include "unit_test.inc.h"
+
+/**
+ * Table 49 example - calculating the size of a table before it is stroked
+ */
+void
+create_table_ex49(HPDF_Doc pdf_doc, HPDF_Page pdf_page) {
+    const size_t num_rows = 4;
+    const size_t num_cols = 3;
+    char *content[] = {
+            "Quarter", "Comment", "Result",
+            "Q1", "Slow start of the year because of the late delivery of the new production line", "-12%",
+            "Q2", "Back on track", "+8%",
+            "Q3", "Record sales in all regions after the launch of the new product family", "+23%"};
+
+    HPDF_REAL xpos = hpdftbl_cm2dpi(1);
+    HPDF_REAL ypos = hpdftbl_cm2dpi(A4PAGE_HEIGHT_CM - 1);
+    const HPDF_REAL width = hpdftbl_cm2dpi(12);
+    const HPDF_REAL spacing = hpdftbl_cm2dpi(0.5);
+
+    // Stack three tables with a fixed spacing. The height of each table depends on the
+    // wrapped content so the layout is calculated before the table is stroked. The table
+    // is then stroked with the already calculated layout.
+    for (int i = 0; i < 3; i++) {
+        hpdftbl_t tbl = hpdftbl_create_title(num_rows, num_cols, "tut_ex49: Stacked tables");
+        hpdftbl_use_header(tbl, TRUE);
+        hpdftbl_set_content(tbl, content);
+        hpdftbl_set_colwidth_percent(tbl, 0, 20);
+        hpdftbl_set_colwidth_percent(tbl, 2, 15);
+        hpdftbl_set_col_wrap_mode(tbl, 1, WRAP_WORD);
+        hpdftbl_set_auto_rowheight(tbl, TRUE);
+
+        hpdftbl_layout_t layout;
+        if (0 == hpdftbl_layout(pdf_doc, tbl, width, 0, &layout)) {
+            hpdftbl_stroke_layout(pdf_doc, pdf_page, tbl, xpos, ypos);
+            ypos -= layout.total_height + spacing;
+        }
+        hpdftbl_destroy(tbl);
+    }
+}
+
+TUTEX_MAIN(create_table_ex49, FALSE)
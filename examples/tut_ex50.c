@@ -0,0 +1,53 @@
+/**
+ * @file
+ */
+
+#include "unit_test.inc.h"
+
+/**
+ * @brief Number of tables in the flow
+ */
+#define NUM_FLOW_TABLES 12
+
+/**
+ * Table 50 example - placing many tables after each other over several pages
+ */
+void
+create_table_ex50(HPDF_Doc pdf_doc, HPDF_Page pdf_page) {
+    const size_t num_cols = 3;
+    char *content[] = {
+            "Item", "Comment", "Amount",
+            "Rent", "Office and storage", "1 200.00",
+            "Travel", "Customer visits during the month including hotel nights and train tickets", "845.50",
+            "Equipment", "New laptop", "1 599.00",
+            "Misc", "Coffee, paper and other consumables", "123.45"};
+
+    hpdftbl_t tables[NUM_FLOW_TABLES];
+    char title[64];
+
+    hpdftbl_flow_t flow = hpdftbl_flow_create(pdf_doc, pdf_page, hpdftbl_cm2dpi(1),
+                                              hpdftbl_cm2dpi(A4PAGE_HEIGHT_CM - 1), hpdftbl_cm2dpi(15));
+    hpdftbl_flow_set_spacing(flow, hpdftbl_cm2dpi(0.8));
+
+    // Tables get a different number of rows to give them different heights
+    for (size_t i = 0; i < NUM_FLOW_TABLES; i++) {
+        const size_t num_rows = 2 + i % 4;
+        snprintf(title, sizeof(title), "tut_ex50: Expenses for month %zu", i + 1);
+        tables[i] = hpdftbl_create_title(num_rows, num_cols, title);
+        hpdftbl_use_header(tables[i], TRUE);
+        hpdftbl_set_content(tables[i], content);
+        hpdftbl_set_colwidth_percent(tables[i], 0, 20);
+        hpdftbl_set_colwidth_percent(tables[i], 2, 20);
+        hpdftbl_set_col_wrap_mode(tables[i], 1, WRAP_WORD);
+        hpdftbl_flow_add(flow, tables[i]);
+    }
+
+    hpdftbl_flow_stroke(flow);
+    hpdftbl_flow_destroy(flow);
+
+    for (size_t i = 0; i < NUM_FLOW_TABLES; i++) {
+        hpdftbl_destroy(tables[i]);
+    }
+}
+
+TUTEX_MAIN(create_table_ex50, FALSE)
@@ -0,0 +1,82 @@
+/**
+ * @file
+ */
+
+#include "unit_test.inc.h"
+
+#ifndef _MSC_VER
+// Silent gcc about unused "arg" in the callback and error functions
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+static char *
+cb_content(void *tag, size_t r, size_t c) {
+    static char buf[32];
+    if (0 == c) {
+        if (0 == r) {
+            return "Device";
+        }
+        snprintf(buf, sizeof buf, "Sensor %02zu", r);
+        return buf;
+    } else if (0 == r && 1 == c) {
+        return "Power";
+    } else if (0 == r && 2 == c) {
+        return "Signal";
+    } else if (0 == r && 3 == c) {
+        return "Battery";
+    }
+    return NULL;
+}
+
+static void
+cb_draw_widget(HPDF_Doc doc, HPDF_Page page, void *tag, size_t r, size_t c,
+               HPDF_REAL xpos, HPDF_REAL ypos, HPDF_REAL width, HPDF_REAL height) {
+    // The states are made up from the row number. Real data would come from e.g. a DB.
+    if (0 == r) {
+        return;
+    } else if (1 == c) {
+        hpdftbl_widget_slide_button(doc, page, xpos + 6, ypos + 3, 38, 11, r % 3 != 0);
+    } else if (2 == c) {
+        hpdftbl_widget_strength_meter(doc, page, xpos + 6, ypos + 2, 30, 14, 5, HPDF_COLOR_DARK_GREEN, r % 6);
+    } else if (3 == c) {
+        hpdftbl_widget_segment_hbar(doc, page, xpos + 6, ypos + 5, width * 0.6, 7, 10, HPDF_COLOR_DARK_RED,
+                                    (r % 5) * 0.25, FALSE);
+    }
+}
+
+#ifndef _MSC_VER
+#pragma GCC diagnostic pop
+#endif
+
+/**
+ * Table 51 example - Table with many widgets drawn through the widget cache
+ */
+void
+create_table_ex51(HPDF_Doc pdf_doc, HPDF_Page pdf_page) {
+    const size_t num_rows = 36;
+    const size_t num_cols = 4;
+
+    // Each distinct widget appearance is only written once to the PDF
+    hpdftbl_use_widget_cache(TRUE);
+
+    hpdftbl_t tbl = hpdftbl_create_title(num_rows, num_cols, "tut_ex51: Status of all sensors");
+    hpdftbl_use_header(tbl, TRUE);
+    hpdftbl_set_min_rowheight(tbl, 18);
+    hpdftbl_set_content_cb(tbl, cb_content);
+    hpdftbl_set_canvas_cb(tbl, cb_draw_widget);
+
+    HPDF_REAL xpos = hpdftbl_cm2dpi(1);
+    HPDF_REAL ypos = hpdftbl_cm2dpi(A4PAGE_HEIGHT_CM - 1);
+    HPDF_REAL width = hpdftbl_cm2dpi(16);
+    HPDF_REAL height = 0;  // Calculate height automatically
+
+    hpdftbl_stroke(pdf_doc, pdf_page, tbl, xpos, ypos, width, height);
+    hpdftbl_destroy(tbl);
+
+    // The cache refers to objects in this document
+    hpdftbl_clear_widget_cache();
+    hpdftbl_use_widget_cache(FALSE);
+}
+
+TUTEX_MAIN(create_table_ex51, FALSE)
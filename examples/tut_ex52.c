@@ -0,0 +1,49 @@
+/**
+ * @file
+ */
+
+#include "unit_test.inc.h"
+
+/**
+ * @brief Number of pages in the example
+ */
+#define NUM_PAGES 5
+
+/**
+ * Table 52 example - The same legend table placed on several pages
+ */
+void
+create_table_ex52(HPDF_Doc pdf_doc, HPDF_Page pdf_page) {
+    const size_t num_rows = 4;
+    const size_t num_cols = 2;
+    char *content[] = {
+            "Symbol", "Meaning",
+            "A", "Approved by the project board",
+            "P", "Pending approval",
+            "R", "Rejected, see the comments for the reason"};
+
+    // The legend is only created once
+    hpdftbl_t tbl = hpdftbl_create_title(num_rows, num_cols, "tut_ex52: Legend");
+    hpdftbl_use_header(tbl, TRUE);
+    hpdftbl_set_content(tbl, content);
+    hpdftbl_set_colwidth_percent(tbl, 0, 20);
+
+    hpdftbl_stamp_t legend;
+    if (hpdftbl_stamp_create(pdf_doc, pdf_page, tbl, hpdftbl_cm2dpi(12), 0, &legend)) {
+        hpdftbl_destroy(tbl);
+        return;
+    }
+    hpdftbl_destroy(tbl);
+
+    // .. and then placed at the top of every page. The PDF only holds one copy of the table.
+    HPDF_Page page = pdf_page;
+    for (size_t i = 0; i < NUM_PAGES; i++) {
+        if (i > 0) {
+            page = HPDF_AddPage(pdf_doc);
+            HPDF_Page_SetSize(page, HPDF_PAGE_SIZE_A4, HPDF_PAGE_PORTRAIT);
+        }
+        hpdftbl_stamp_place(page, &legend, hpdftbl_cm2dpi(1), hpdftbl_cm2dpi(A4PAGE_HEIGHT_CM - 1));
+    }
+}
+
+TUTEX_MAIN(create_table_ex52, FALSE)
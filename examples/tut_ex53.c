@@ -0,0 +1,116 @@
+/**
+ * @file
+ */
+
+#include "unit_test.inc.h"
+#include <math.h>
+
+/**
+ * @brief Number of values in each series
+ */
+#define NUM_VALUES 50000
+
+/**
+ * @brief Number of series, one in each row
+ */
+#define NUM_SERIES 4
+
+/**
+ * @brief The series of values to show
+ */
+static double series[NUM_SERIES][NUM_VALUES];
+
+/**
+ * @brief Create series of values with a trend and some noise. A simple
+ * linear congruential generator is used so the values are always the same.
+ */
+static void
+create_series(void) {
+    unsigned long seed = 12345;
+    for (size_t s = 0; s < NUM_SERIES; s++) {
+        for (size_t i = 0; i < NUM_VALUES; i++) {
+            seed = (seed * 1103515245UL + 12345UL) % 2147483648UL;
+            const double noise = (double) seed / 2147483648.0 - 0.5;
+            series[s][i] = sin((double) i / (2000.0 * (s + 1))) * (s + 1) + noise;
+        }
+    }
+}
+
+#ifndef _MSC_VER
+// Silent gcc about unused "arg" in the callback and error functions
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+static char *
+cb_content(void *tag, size_t r, size_t c) {
+    static char buf[32];
+    if (0 == r) {
+        if (0 == c)
+            return "Series";
+        else if (1 == c)
+            return "Sparkline";
+        else if (2 == c)
+            return "Mini bars";
+        else
+            return "Min/Max band";
+    }
+    if (0 == c) {
+        snprintf(buf, sizeof buf, "Sensor %zu", r);
+        return buf;
+    }
+    return NULL;
+}
+
+static void
+cb_draw_chart(HPDF_Doc doc, HPDF_Page page, void *tag, size_t r, size_t c,
+              HPDF_REAL xpos, HPDF_REAL ypos, HPDF_REAL width, HPDF_REAL height) {
+    if (0 == r || 0 == c) {
+        return;
+    }
+    const double *values = series[r - 1];
+    const HPDF_REAL x = xpos + 4;
+    const HPDF_REAL y = ypos + 4;
+    const HPDF_REAL w = width - 8;
+    const HPDF_REAL h = height - 8;
+    if (1 == c) {
+        hpdftbl_widget_sparkline(doc, page, x, y, w, h, HPDF_COLOR_DARK_BLUE, values, NUM_VALUES);
+    } else if (2 == c) {
+        hpdftbl_widget_minibar(doc, page, x, y, w, h, HPDF_COLOR_DARK_GREEN, HPDF_COLOR_DARK_RED, values, NUM_VALUES);
+    } else {
+        hpdftbl_widget_minmax_band(doc, page, x, y, w, h, HPDF_COLOR_LIGHT_GRAY, HPDF_COLOR_DARK_BLUE, values,
+                                   NUM_VALUES);
+    }
+}
+
+#ifndef _MSC_VER
+#pragma GCC diagnostic pop
+#endif
+
+/**
+ * Table 53 example - Charts of long series of values in table cells
+ */
+void
+create_table_ex53(HPDF_Doc pdf_doc, HPDF_Page pdf_page) {
+    const size_t num_rows = NUM_SERIES + 1;
+    const size_t num_cols = 4;
+
+    create_series();
+
+    hpdftbl_t tbl = hpdftbl_create_title(num_rows, num_cols, "tut_ex53: Charts of 50 000 values in each cell");
+    hpdftbl_use_header(tbl, TRUE);
+    hpdftbl_set_min_rowheight(tbl, 40);
+    hpdftbl_set_colwidth_percent(tbl, 0, 16);
+    hpdftbl_set_content_cb(tbl, cb_content);
+    hpdftbl_set_canvas_cb(tbl, cb_draw_chart);
+
+    HPDF_REAL xpos = hpdftbl_cm2dpi(1);
+    HPDF_REAL ypos = hpdftbl_cm2dpi(A4PAGE_HEIGHT_CM - 1);
+    HPDF_REAL width = hpdftbl_cm2dpi(18);
+    HPDF_REAL height = 0;  // Calculate height automatically
+
+    hpdftbl_stroke(pdf_doc, pdf_page, tbl, xpos, ypos, width, height);
+    hpdftbl_destroy(tbl);
+}
+
+TUTEX_MAIN(create_table_ex53, FALSE)
@@ -0,0 +1,58 @@
+/**
+ * @file
+ */
+
+#include "unit_test.inc.h"
+
+/**
+ * @brief Number of tables that share the theme
+ */
+#define NUM_TABLES 3
+
+/**
+ * Table 54 example - Several tables that use the same shared theme
+ */
+void
+create_table_ex54(HPDF_Doc pdf_doc, HPDF_Page pdf_page) {
+    const size_t num_rows = 4;
+    const size_t num_cols = 3;
+    char *content[] = {
+            "Quarter", "Revenue", "Margin",
+            "Q1", "1 200", "12%",
+            "Q2", "1 350", "14%",
+            "Q3", "1 100", "9%"};
+
+    hpdftbl_theme_t theme = *hpdftbl_get_builtin_theme(THEME_DEFAULT);
+    theme.use_header_row = TRUE;
+    hpdftbl_shared_theme_t corporate = hpdftbl_shared_theme_create(&theme);
+    if (NULL == corporate)
+        return;
+
+    hpdftbl_t tbl[NUM_TABLES];
+    for (size_t i = 0; i < NUM_TABLES; i++) {
+        tbl[i] = hpdftbl_create_title(num_rows, num_cols, "tut_ex54: Shared theme");
+        hpdftbl_set_content(tbl[i], content);
+        hpdftbl_use_shared_theme(tbl[i], corporate);
+    }
+    // The tables keep their own references to the shared theme
+    hpdftbl_shared_theme_release(corporate);
+
+    // A style set on a table overrides the shared theme for that table only
+    hpdftbl_set_title_style(tbl[1], HPDF_FF_HELVETICA_BOLD, 11, HPDF_COLOR_WHITE, HPDF_COLOR_DARK_GRAY);
+
+    HPDF_REAL ypos = hpdftbl_cm2dpi(A4PAGE_HEIGHT_CM - 1);
+    for (size_t i = 0; i < NUM_TABLES; i++) {
+        hpdftbl_stroke(pdf_doc, pdf_page, tbl[i], hpdftbl_cm2dpi(1), ypos, hpdftbl_cm2dpi(10), 0);
+        ypos -= hpdftbl_cm2dpi(4);
+    }
+
+    // Changing the shared theme changes all tables without touching them
+    hpdftbl_shared_theme_set(corporate, hpdftbl_get_builtin_theme(THEME_ZEBRA));
+    for (size_t i = 0; i < NUM_TABLES; i++) {
+        hpdftbl_stroke(pdf_doc, pdf_page, tbl[i], hpdftbl_cm2dpi(11), hpdftbl_cm2dpi(A4PAGE_HEIGHT_CM - 1) - (HPDF_REAL)i * hpdftbl_cm2dpi(4),
+                       hpdftbl_cm2dpi(8), 0);
+        hpdftbl_destroy(tbl[i]);
+    }
+}
+
+TUTEX_MAIN(create_table_ex54, FALSE)
@@ -0,0 +1,56 @@
+/**
+ * @file
+ */
+
+#include "unit_test.inc.h"
+
+/**
+ * @brief Conditional formatting rules used in the example
+ *
+ * Negative numbers are red, the three largest numbers have a yellow background
+ * and every cell in the status column that starts with "Late" is bold.
+ */
+static hpdftbl_rule_t rules[] = {
+        {-1, RULE_LT, 0, 0, NULL, RULE_SET_COLOR,
+                {NULL, 0, {0.8f, 0, 0}, {1, 1, 1}, LEFT}},
+        {-1, RULE_TOP_N, 3, 0, NULL, RULE_SET_BACKGROUND,
+                {NULL, 0, {0, 0, 0}, {1.0f, 0.95f, 0.6f}, LEFT}},
+        {4, RULE_STR_PREFIX, 0, 0, "Late", RULE_SET_FONT | RULE_SET_COLOR,
+                {HPDF_FF_COURIER_BOLD, 0, {0.6f, 0, 0}, {1, 1, 1}, LEFT}}
+};
+
+/**
+ * Table 55 example - Conditional formatting with rules
+ */
+void
+create_table_ex55(HPDF_Doc pdf_doc, HPDF_Page pdf_page) {
+    const size_t num_rows = 6;
+    const size_t num_cols = 5;
+    char *content[] = {
+            "Region", "Q1", "Q2", "Q3", "Status",
+            "North", "120", "-15", "98", "On time",
+            "South", "87", "142", "-3", "Late 2 days",
+            "East", "-40", "65", "110", "On time",
+            "West", "150", "12", "77", "Late 1 day",
+            "Central", "33", "-8", "131", "On time"};
+
+    // The rules are part of the theme and would be serialized with hpdftbl_theme_dump()
+    hpdftbl_theme_t theme = *hpdftbl_get_builtin_theme(THEME_DEFAULT);
+    theme.use_header_row = TRUE;
+    theme.rules = rules;
+    theme.num_rules = sizeof(rules) / sizeof(rules[0]);
+
+    hpdftbl_t tbl = hpdftbl_create_with_theme(num_rows, num_cols, "tut_ex55: Conditional formatting", &theme);
+    hpdftbl_set_content(tbl, content);
+    hpdftbl_set_colwidth_percent(tbl, 0, 25);
+    hpdftbl_set_colwidth_percent(tbl, 4, 30);
+
+    HPDF_REAL xpos = hpdftbl_cm2dpi(1);
+    HPDF_REAL ypos = hpdftbl_cm2dpi(A4PAGE_HEIGHT_CM - 1);
+    HPDF_REAL width = hpdftbl_cm2dpi(15);
+    HPDF_REAL height = 0;
+    hpdftbl_stroke(pdf_doc, pdf_page, tbl, xpos, ypos, width, height);
+    hpdftbl_destroy(tbl);
+}
+
+TUTEX_MAIN(create_table_ex55, FALSE)
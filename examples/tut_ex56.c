@@ -0,0 +1,60 @@
+/**
+ * @file
+ */
+
+#include "unit_test.inc.h"
+
+/**
+ * @brief Content callback that returns the cell position as the content
+ *
+ * @param tag Table tag (unused)
+ * @param r Row
+ * @param c Column
+ * @return The content of the cell
+ */
+static char *
+cb_content(void *tag, size_t r, size_t c) {
+    (void) tag;
+    static char buf[32];
+    snprintf(buf, sizeof buf, "Content %zu:%zu", r, c);
+    return buf;
+}
+
+/**
+ * Table 56 example - Instrumentation counters
+ */
+void
+create_table_ex56(HPDF_Doc pdf_doc, HPDF_Page pdf_page) {
+    const size_t num_rows = 20;
+    const size_t num_cols = 5;
+
+    hpdftbl_t tbl = hpdftbl_create_title(num_rows, num_cols, "tut_ex56: Instrumentation counters");
+    hpdftbl_use_labels(tbl, TRUE);
+    hpdftbl_use_labelgrid(tbl, TRUE);
+    hpdftbl_set_zebra(tbl, TRUE, 0);
+    hpdftbl_set_content_cb(tbl, cb_content);
+
+    hpdftbl_reset_stats();
+
+    HPDF_REAL xpos = hpdftbl_cm2dpi(1);
+    HPDF_REAL ypos = hpdftbl_cm2dpi(A4PAGE_HEIGHT_CM - 1);
+    HPDF_REAL width = hpdftbl_cm2dpi(18);
+    HPDF_REAL height = 0;
+    hpdftbl_stroke(pdf_doc, pdf_page, tbl, xpos, ypos, width, height);
+    hpdftbl_destroy(tbl);
+
+    // The counters are always zero unless the library is configured with --enable-stats
+    for (hpdftbl_stat_id_t id = STAT_DRAW; id < STAT_NUM_COUNTERS; id++) {
+        hpdftbl_stat_t stat;
+        hpdftbl_get_stat(id, &stat);
+        printf("%-14s %6lu calls %6lu ops %9.3f ms\n", hpdftbl_get_stat_name(id), stat.calls, stat.ops,
+               stat.seconds * 1000);
+    }
+
+    char buff[1024];
+    if (0 == hpdftbl_stats_dumps(buff, sizeof buff)) {
+        printf("%s\n", buff);
+    }
+}
+
+TUTEX_MAIN(create_table_ex56, FALSE)
@@ -0,0 +1,64 @@
+/**
+ * @file
+ */
+
+#include "unit_test.inc.h"
+
+/**
+ * @brief Label callback that returns the column name as the label
+ *
+ * @param tag Table tag (unused)
+ * @param r Row (unused)
+ * @param c Column
+ * @return The label of the cell
+ */
+static char *
+cb_label(void *tag, size_t r, size_t c) {
+    (void) tag;
+    (void) r;
+    static char *labels[] = {"Item", "Qty", "Price", "Total"};
+    return labels[c];
+}
+
+/**
+ * Table 57 example - Render statistics for a table
+ */
+void
+create_table_ex57(HPDF_Doc pdf_doc, HPDF_Page pdf_page) {
+    const size_t num_rows = 5;
+    const size_t num_cols = 4;
+    char *content[] = {
+            "Apples", "10", "2.50", "25.00",
+            "Pears", "4", "3.00", "12.00",
+            "Plums", "12", "1.20", "14.40",
+            "Figs", "3", "4.00", "12.00",
+            "Sum", "", "", "63.40"};
+
+    hpdftbl_t tbl = hpdftbl_create_title(num_rows, num_cols, "tut_ex57: Render statistics");
+    hpdftbl_use_labels(tbl, TRUE);
+    hpdftbl_set_label_cb(tbl, cb_label);
+    hpdftbl_set_content(tbl, content);
+    hpdftbl_set_cellspan(tbl, 4, 0, 1, 3);
+
+    HPDF_REAL xpos = hpdftbl_cm2dpi(1);
+    HPDF_REAL ypos = hpdftbl_cm2dpi(A4PAGE_HEIGHT_CM - 1);
+    HPDF_REAL width = hpdftbl_cm2dpi(15);
+    HPDF_REAL height = 0;
+    hpdftbl_stroke(pdf_doc, pdf_page, tbl, xpos, ypos, width, height);
+
+    // Log the statistics for the table, e.g. to find tables with a lot of color changes
+    char buff[512];
+    if (0 == hpdftbl_render_stats_dumps(tbl, buff, sizeof buff)) {
+        printf("%s\n", buff);
+    }
+
+    hpdftbl_render_stats_t stats;
+    hpdftbl_get_render_stats(tbl, &stats);
+    if (stats.cells + stats.spanned_cells != num_rows * num_cols) {
+        fprintf(stderr, "Unexpected number of cells %zu + %zu\n", stats.cells, stats.spanned_cells);
+        exit(1);
+    }
+    hpdftbl_destroy(tbl);
+}
+
+TUTEX_MAIN(create_table_ex57, FALSE)
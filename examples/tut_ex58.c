@@ -0,0 +1,109 @@
+/**
+ * @file
+ */
+
+#include "unit_test.inc.h"
+
+/** Number of bytes currently allocated by the library */
+static size_t allocated = 0;
+
+/**
+ * @brief Allocation function that keeps track of the allocated memory
+ *
+ * The size of each block is stored just before the returned memory.
+ *
+ * @param size Number of bytes
+ * @return Allocated memory
+ */
+static void *
+counting_malloc(size_t size) {
+    size_t *p = malloc(sizeof(size_t) + size);
+    if (p == NULL)
+        return NULL;
+    *p = size;
+    allocated += size;
+    return p + 1;
+}
+
+/**
+ * @brief Release function that keeps track of the allocated memory
+ *
+ * @param ptr Memory to release
+ */
+static void
+counting_free(void *ptr) {
+    if (ptr) {
+        size_t *p = (size_t *) ptr - 1;
+        allocated -= *p;
+        free(p);
+    }
+}
+
+/**
+ * @brief Reallocation function that keeps track of the allocated memory
+ *
+ * @param ptr Memory to reallocate
+ * @param size New size
+ * @return Reallocated memory
+ */
+static void *
+counting_realloc(void *ptr, size_t size) {
+    if (ptr == NULL)
+        return counting_malloc(size);
+    size_t *p = (size_t *) ptr - 1;
+    const size_t old_size = *p;
+    p = realloc(p, sizeof(size_t) + size);
+    if (p == NULL)
+        return NULL;
+    *p = size;
+    allocated = allocated - old_size + size;
+    return p + 1;
+}
+
+/**
+ * Table 58 example - Memory accounting
+ */
+void
+create_table_ex58(HPDF_Doc pdf_doc, HPDF_Page pdf_page) {
+    const size_t num_rows = 10;
+    const size_t num_cols = 4;
+
+    hpdftbl_set_alloc_funcs(counting_malloc, counting_realloc, counting_free);
+
+    hpdftbl_t tbl = hpdftbl_create_title(num_rows, num_cols, "tut_ex58: Memory accounting");
+    hpdftbl_use_labels(tbl, TRUE);
+    hpdftbl_set_auto_colwidth(tbl, TRUE);
+    char buf[32];
+    for (size_t r = 0; r < num_rows; r++) {
+        for (size_t c = 0; c < num_cols; c++) {
+            snprintf(buf, sizeof buf, "Cell %zu:%zu", r, c);
+            hpdftbl_set_cell(tbl, r, c, "Label", buf);
+        }
+    }
+
+    HPDF_REAL xpos = hpdftbl_cm2dpi(1);
+    HPDF_REAL ypos = hpdftbl_cm2dpi(A4PAGE_HEIGHT_CM - 1);
+    HPDF_REAL width = 0;
+    HPDF_REAL height = 0;
+    hpdftbl_stroke(pdf_doc, pdf_page, tbl, xpos, ypos, width, height);
+
+    // All memory allocated by the library is either owned by the table or by the caches
+    size_t bytes;
+    hpdftbl_get_memory_usage(tbl, &bytes);
+    printf("Table: %zu bytes, caches: %zu bytes, allocated: %zu bytes\n", bytes,
+           hpdftbl_get_cache_memory_usage(), allocated);
+    if (bytes + hpdftbl_get_cache_memory_usage() != allocated) {
+        fprintf(stderr, "Memory accounting mismatch\n");
+        exit(1);
+    }
+
+    hpdftbl_destroy(tbl);
+    hpdftbl_clear_glyph_cache();
+    if (allocated != 0) {
+        fprintf(stderr, "%zu bytes not released\n", allocated);
+        exit(1);
+    }
+    hpdftbl_set_alloc_funcs(NULL, NULL, NULL);
+}
+
+TUTEX_MAIN(create_table_ex58, FALSE)
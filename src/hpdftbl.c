@@ -35,6 +35,7 @@
 #endif
 
 #include <string.h>
+#include <stdint.h>
 #include <iconv.h>
 #include <hpdf.h>
 #include <libgen.h>
@@ -163,6 +164,9 @@ hpdftbl_get_anchor_top_left(hpdftbl_t tbl) {
  * northern europe accented characters.
  * The conversion is internally handled by the standard iconv()
  * routines.
+ * The fonts of the table are loaded with the target encoding so the
+ * encoded strings are shown with the right glyphs.
+ *
  * @param target The target encoding. See HPDF documentation for
  * supported encodings.
  * @param source The source encodings, i.e. what encodings are sth
@@ -174,6 +178,16 @@ hpdftbl_set_text_encoding(char *target, char *source) {
     source_encoding = source;
 }
 
+/**
+ * @brief Internal function. Get the target encoding used to load fonts.
+ *
+ * @return The target encoding set with hpdftbl_set_text_encoding()
+ */
+const char *
+hpdftbl_get_target_encoding(void) {
+    return target_encoding;
+}
+
 /**
  * @brief Internal function to do text encoding
  *
@@ -219,25 +233,29 @@ do_encoding(char *input, char *output, const size_t out_len) {
 int
 hpdftbl_encoding_text_out(HPDF_Page page, HPDF_REAL xpos, HPDF_REAL ypos, char *text) {
     // Assume that the encoding we are converting to never exceeds three times the
-    // original string
+    // original string plus the terminating NULL
 
     if (NULL == text)
         return 0;
 
-    const size_t out_len = 3 * strlen(text);
+    _HPDFTBL_STAT_BEGIN(STAT_TEXT_ENCODING);
+    const size_t out_len = 3 * strlen(text) + 1;
 #ifdef __cplusplus
-    char *output = static_cast<char*>(calloc(1, out_len));
+    char *output = static_cast<char*>(hpdftbl_calloc(1, out_len));
 #else
-    char *output = calloc(1, out_len);
+    char *output = hpdftbl_calloc(1, out_len);
 #endif
     if (-1 == do_encoding(text, output, out_len)) {
         _HPDFTBL_SET_ERR(NULL, -4, (int) xpos, (int) ypos);
         HPDF_Page_TextOut(page, xpos, ypos, "???");
+        hpdftbl_free(output);
+        _HPDFTBL_STAT_END(STAT_TEXT_ENCODING, 2);
         return -1;
     } else {
         HPDF_Page_TextOut(page, xpos, ypos, output);
     }
-    free(output);
+    hpdftbl_free(output);
+    _HPDFTBL_STAT_END(STAT_TEXT_ENCODING, 2);
     return 0;
 }
 
@@ -296,6 +314,7 @@ HPDF_RoundedCornerRectangle(HPDF_Page page, HPDF_REAL xpos, HPDF_REAL ypos, HPDF
 void
 hpdftbl_set_bottom_vmargin_factor(hpdftbl_t t, HPDF_REAL f) {
     t->bottom_vmargin_factor = f;
+    t->theme_override |= THEME_OVR_VMARGIN;
 }
 
 /**
@@ -324,12 +343,35 @@ hpdftbl_create(size_t rows, size_t cols) {
  */
 hpdftbl_t
 hpdftbl_create_title(size_t rows, size_t cols, char *title) {
+    return hpdftbl_create_with_theme(rows, cols, title, hpdftbl_get_builtin_theme(THEME_DEFAULT));
+}
+
+/**
+ * @brief Create a new table with the styles from a theme
+ *
+ * Create a new table structure with all styles copied from the given theme. With one
+ * of the built-in themes from hpdftbl_get_builtin_theme() no memory is allocated for the
+ * theme. The theme is not referenced by the table after this call.
+ * @param rows Number of rows
+ * @param cols Number of columns
+ * @param title Title of table, NULL for no title
+ * @param theme Theme to use for the table
+ * @return A handle to a table, NULL in case of OOM or if theme is NULL
+ * @see hpdftbl_get_builtin_theme(), hpdftbl_apply_theme()
+ */
+hpdftbl_t
+hpdftbl_create_with_theme(size_t rows, size_t cols, char *title, const hpdftbl_theme_t *theme) {
+
+    if (NULL == theme) {
+        _HPDFTBL_SET_ERR(NULL, -9, -1, -1);
+        return NULL;
+    }
 
     // Initializing to zero means default color is black
 #ifdef __cplusplus
-    hpdftbl_t t = static_cast<hpdftbl_t>(calloc(1, sizeof(struct hpdftbl)));
+    hpdftbl_t t = static_cast<hpdftbl_t>(hpdftbl_calloc(1, sizeof(struct hpdftbl)));
 #else
-    hpdftbl_t t = calloc(1, sizeof(struct hpdftbl));
+    hpdftbl_t t = hpdftbl_calloc(1, sizeof(struct hpdftbl));
 #endif
     if (t == NULL) {
         _HPDFTBL_SET_ERR(t, -5, -1, -1);
@@ -339,13 +381,13 @@ hpdftbl_create_title(size_t rows, size_t cols, char *title) {
     t->anchor_is_top_left = TRUE;
 
 #ifdef __cplusplus
-    t->cells = static_cast<hpdftbl_cell_t*>(calloc(cols*rows, sizeof(hpdftbl_cell_t)));
+    t->cells = static_cast<hpdftbl_cell_t*>(hpdftbl_calloc(cols*rows, sizeof(hpdftbl_cell_t)));
 #else
-    t->cells = calloc(cols * rows, sizeof(hpdftbl_cell_t));
+    t->cells = hpdftbl_calloc(cols * rows, sizeof(hpdftbl_cell_t));
 #endif
     if (t->cells == NULL) {
-        free(t);
-        _HPDFTBL_SET_ERR(t, -5, -1, -1);
+        hpdftbl_free(t);
+        _HPDFTBL_SET_ERR(NULL, -5, -1, -1);
         return NULL;
     }
 
@@ -363,14 +405,14 @@ hpdftbl_create_title(size_t rows, size_t cols, char *title) {
 
     // Setup common column widths
 #ifdef __cplusplus
-    t->col_width_percent = static_cast<float*>(calloc(cols, sizeof(float)));
+    t->col_width_percent = static_cast<float*>(hpdftbl_calloc(cols, sizeof(float)));
 #else
-    t->col_width_percent = calloc(cols, sizeof(float));
+    t->col_width_percent = hpdftbl_calloc(cols, sizeof(float));
 #endif
     if (t->col_width_percent == NULL) {
-        free(t->cells);
-        free(t);
-        _HPDFTBL_SET_ERR(t, -5, -1, -1);
+        hpdftbl_free(t->cells);
+        hpdftbl_free(t);
+        _HPDFTBL_SET_ERR(NULL, -5, -1, -1);
         return NULL;
     }
 
@@ -381,19 +423,17 @@ hpdftbl_create_title(size_t rows, size_t cols, char *title) {
     }
 
     if (title) {
-        t->title_txt = strdup(title);
+        t->title_txt = hpdftbl_strdup(title);
         if (t->title_txt == NULL) {
-            free(t->col_width_percent);
-            free(t->cells);
-            free(t);
-            _HPDFTBL_SET_ERR(t, -5, -1, -1);
+            hpdftbl_free(t->col_width_percent);
+            hpdftbl_free(t->cells);
+            hpdftbl_free(t);
+            _HPDFTBL_SET_ERR(NULL, -5, -1, -1);
             return NULL;
         }
     }
 
-    hpdftbl_theme_t *theme = hpdftbl_get_default_theme();
     hpdftbl_apply_theme(t, theme);
-    hpdftbl_destroy_theme(theme);
 
     return t;
 }
@@ -419,6 +459,30 @@ hpdftbl_set_min_rowheight(hpdftbl_t t, float h) {
 }
 
 
+/**
+ * @brief Calculate the height of each row from its content.
+ *
+ * By default all rows in a table have the same height. With this setting each row gets the
+ * height needed by its content, i.e. the largest font size in the row, if labels are used
+ * and the number of lines of word wrapped content. Cell specific styles set with
+ * hpdftbl_set_cell_content_style() are taken into account but not style callbacks.
+ * No row will be lower than the minimum row height set with hpdftbl_set_min_rowheight().
+ *
+ * If the table height is specified when the table is stroked the height is distributed
+ * among the rows in proportion to their content height.
+ *
+ * @param t Table handle
+ * @param use TRUE to calculate row heights from the content, FALSE to use equal row heights
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_set_min_rowheight(), hpdftbl_set_wrap_mode()
+ */
+int
+hpdftbl_set_auto_rowheight(hpdftbl_t t, _Bool use) {
+    _HPDFTBL_CHK_TABLE(t);
+    t->use_auto_rowheight = use;
+    return 0;
+}
+
 /**
  * @brief Set column width as percentage of overall table width
  *
@@ -446,6 +510,178 @@ hpdftbl_set_colwidth_percent(hpdftbl_t t, size_t c, float w) {
     return 0;
 }
 
+/**
+ * @brief Calculate the column widths from the content of the table.
+ *
+ * When enabled the width of each column is calculated, when the table is stroked,
+ * to fit the widest text (content or label) in the column. Any percentage widths set with
+ * hpdftbl_set_colwidth_percent() are then ignored. The width given to hpdftbl_stroke() (or set with
+ * hpdftbl_setpos()) is used as the maximum width of the table. If the width is specified as 0
+ * the maximum width is the page width less the same margin on the right side as the
+ * table x-position on the left side.
+ *
+ * If the columns do not fit within the maximum width they are shrunk proportionally but never
+ * below the minimum width set with hpdftbl_set_colwidth_min(). The actual width of the table is
+ * available in the table after it has been stroked.
+ *
+ * The text widths are calculated with cached glyph metrics (see hpdftbl_text_width()) in a
+ * single pass over all cells. Cells that span several columns are not taken into account and
+ * style callbacks are not called, the static cell or table style is used to measure the text.
+ *
+ * @param t Table handle
+ * @param use TRUE to calculate the column widths from the content, FALSE to use the percentage widths
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_set_colwidth_min()
+ */
+int
+hpdftbl_set_auto_colwidth(hpdftbl_t t, _Bool use) {
+    _HPDFTBL_CHK_TABLE(t);
+    t->use_auto_colwidth = use;
+    return 0;
+}
+
+/**
+ * @brief Set the minimum width of a column when the column widths are calculated from the content.
+ *
+ * @param t Table handle
+ * @param c Column to set minimum width of. First column has index 0
+ * @param w Minimum width in points
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_set_auto_colwidth()
+ */
+int
+hpdftbl_set_colwidth_min(hpdftbl_t t, size_t c, HPDF_REAL w) {
+    _HPDFTBL_CHK_TABLE(t);
+    if (c >= t->cols) {
+        _HPDFTBL_SET_ERR(t, -2, -1, c);
+        return -1;
+    }
+    if (w < 0) {
+        _HPDFTBL_SET_ERR(t, -13, -1, c);
+        return -1;
+    }
+    if (t->col_min_width == NULL) {
+#ifdef __cplusplus
+        t->col_min_width = static_cast<HPDF_REAL*>(hpdftbl_calloc(t->cols, sizeof(HPDF_REAL)));
+#else
+        t->col_min_width = hpdftbl_calloc(t->cols, sizeof(HPDF_REAL));
+#endif
+        if (t->col_min_width == NULL) {
+            _HPDFTBL_SET_ERR(t, -5, -1, -1);
+            return -1;
+        }
+    }
+    t->col_min_width[c] = w;
+    return 0;
+}
+
+/**
+ * @brief Set how text wider than the cell is handled for the entire table.
+ *
+ * With `WRAP_WORD` the content of each cell is broken into several lines at word
+ * boundaries so that it fits within the width of the cell. If the table height is
+ * automatically calculated (height specified as 0 when stroked) each row gets
+ * enough height to fit the cell in the row with the most lines.
+ * The setting can be overridden for a column with hpdftbl_set_col_wrap_mode() and
+ * for an individual cell with hpdftbl_set_cell_wrap_mode().
+ *
+ * @param t Table handle
+ * @param mode Wrap mode. `WRAP_INHERIT` is the same as `WRAP_NONE` for the table.
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_set_col_wrap_mode(), hpdftbl_set_cell_wrap_mode()
+ */
+int
+hpdftbl_set_wrap_mode(hpdftbl_t t, hpdftbl_wrap_mode_t mode) {
+    _HPDFTBL_CHK_TABLE(t);
+    t->wrap_mode = mode;
+    return 0;
+}
+
+/**
+ * @brief Set how text wider than the cell is handled for a column.
+ *
+ * @param t Table handle
+ * @param c Column. First column has index 0
+ * @param mode Wrap mode. `WRAP_INHERIT` uses the table setting.
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_set_wrap_mode(), hpdftbl_set_cell_wrap_mode()
+ */
+int
+hpdftbl_set_col_wrap_mode(hpdftbl_t t, size_t c, hpdftbl_wrap_mode_t mode) {
+    _HPDFTBL_CHK_TABLE(t);
+    if (c >= t->cols) {
+        _HPDFTBL_SET_ERR(t, -2, -1, c);
+        return -1;
+    }
+    if (t->col_wrap_mode == NULL) {
+#ifdef __cplusplus
+        t->col_wrap_mode = static_cast<hpdftbl_wrap_mode_t*>(hpdftbl_calloc(t->cols, sizeof(hpdftbl_wrap_mode_t)));
+#else
+        t->col_wrap_mode = hpdftbl_calloc(t->cols, sizeof(hpdftbl_wrap_mode_t));
+#endif
+        if (t->col_wrap_mode == NULL) {
+            _HPDFTBL_SET_ERR(t, -5, -1, -1);
+            return -1;
+        }
+    }
+    t->col_wrap_mode[c] = mode;
+    return 0;
+}
+
+/**
+ * @brief Set how single line text that is wider than its cell is handled in a column.
+ *
+ * By default text that is wider than its cell overflows into the neighbouring cell. With this
+ * setting the text in the column is instead cut after the last character that fits (`OVERFLOW_CLIP`),
+ * cut and terminated with "..." (`OVERFLOW_ELLIPSIS`) or written with a smaller font size so
+ * that it fits (`OVERFLOW_SHRINK`). Word wrapped content is not affected.
+ *
+ * @param t Table handle
+ * @param c Column. First column has index 0
+ * @param overflow Overflow policy
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_set_col_wrap_mode()
+ */
+int
+hpdftbl_set_col_overflow(hpdftbl_t t, size_t c, hpdftbl_overflow_t overflow) {
+    _HPDFTBL_CHK_TABLE(t);
+    if (c >= t->cols) {
+        _HPDFTBL_SET_ERR(t, -2, -1, c);
+        return -1;
+    }
+    if (t->col_overflow == NULL) {
+#ifdef __cplusplus
+        t->col_overflow = static_cast<hpdftbl_overflow_t*>(hpdftbl_calloc(t->cols, sizeof(hpdftbl_overflow_t)));
+#else
+        t->col_overflow = hpdftbl_calloc(t->cols, sizeof(hpdftbl_overflow_t));
+#endif
+        if (t->col_overflow == NULL) {
+            _HPDFTBL_SET_ERR(t, -5, -1, -1);
+            return -1;
+        }
+    }
+    t->col_overflow[c] = overflow;
+    return 0;
+}
+
+/**
+ * @brief Set how text wider than the cell is handled for a cell.
+ *
+ * @param t Table handle
+ * @param r Row
+ * @param c Column
+ * @param mode Wrap mode. `WRAP_INHERIT` uses the column or table setting.
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_set_wrap_mode(), hpdftbl_set_col_wrap_mode()
+ */
+int
+hpdftbl_set_cell_wrap_mode(hpdftbl_t t, size_t r, size_t c, hpdftbl_wrap_mode_t mode) {
+    _HPDFTBL_CHK_TABLE(t);
+    if (!chktbl(t, r, c)) return -1;
+    t->cells[_HPDFTBL_IDX(r, c)].wrap_mode = mode;
+    return 0;
+}
+
 /**
  * @brief Set outer border grid style.
  *
@@ -462,6 +698,7 @@ hpdftbl_set_outer_grid_style(hpdftbl_t t, HPDF_REAL width, HPDF_RGBColor color,
     t->outer_grid.width = width;
     t->outer_grid.color = color;
     t->outer_grid.line_dashstyle = dashstyle;
+    t->theme_override |= THEME_OVR_OUTER_GRID;
     return 0;
 }
 
@@ -501,6 +738,7 @@ hpdftbl_set_inner_hgrid_style(hpdftbl_t t, HPDF_REAL width, HPDF_RGBColor color,
     t->inner_hgrid.width = width;
     t->inner_hgrid.color = color;
     t->inner_hgrid.line_dashstyle = dashstyle;
+    t->theme_override |= THEME_OVR_INNER_HGRID;
     return 0;
 }
 
@@ -520,6 +758,7 @@ hpdftbl_set_inner_vgrid_style(hpdftbl_t t, HPDF_REAL width, HPDF_RGBColor color,
     t->inner_vgrid.width = width;
     t->inner_vgrid.color = color;
     t->inner_vgrid.line_dashstyle = dashstyle;
+    t->theme_override |= THEME_OVR_INNER_VGRID;
     return 0;
 }
 
@@ -542,6 +781,7 @@ hpdftbl_set_inner_tgrid_style(hpdftbl_t t, HPDF_REAL width, HPDF_RGBColor color,
     t->inner_tgrid.width = width;
     t->inner_tgrid.color = color;
     t->inner_tgrid.line_dashstyle = dashstyle;
+    t->theme_override |= THEME_OVR_INNER_TGRID;
     return 0;
 }
 
@@ -556,6 +796,7 @@ int
 hpdftbl_set_zebra(hpdftbl_t t, _Bool use, int phase) {
     t->use_zebra = use;
     t->zebra_phase = phase;
+    t->theme_override |= THEME_OVR_ZEBRA;
     return 0;
 }
 
@@ -574,6 +815,7 @@ int
 hpdftbl_set_zebra_color(hpdftbl_t t, HPDF_RGBColor z1,  HPDF_RGBColor z2) {
     t->zebra_color1 = z1;
     t->zebra_color2 = z2;
+    t->theme_override |= THEME_OVR_ZEBRA_COLOR;
     return 0;
 }
 
@@ -600,6 +842,7 @@ hpdftbl_set_header_style(hpdftbl_t t, char *font, HPDF_REAL fsize, HPDF_RGBColor
     t->header_style.fsize = fsize;
     t->header_style.color = color;
     t->header_style.background = background;
+    t->theme_override |= THEME_OVR_HEADER_STYLE;
     return 0;
 }
 
@@ -614,6 +857,7 @@ int
 hpdftbl_set_background(hpdftbl_t t, HPDF_RGBColor background) {
     _HPDFTBL_CHK_TABLE(t);
     t->content_style.background = background;
+    t->theme_override |= THEME_OVR_CONTENT_BACKGROUND;
     return 0;
 }
 
@@ -628,6 +872,7 @@ int
 hpdftbl_set_header_halign(hpdftbl_t t, hpdftbl_text_align_t align) {
     _HPDFTBL_CHK_TABLE(t);
     t->header_style.halign = align;
+    t->theme_override |= THEME_OVR_HEADER_HALIGN;
     return 0;
 }
 
@@ -646,6 +891,7 @@ int
 hpdftbl_use_header(hpdftbl_t t, _Bool use) {
     _HPDFTBL_CHK_TABLE(t);
     t->use_header_row = use;
+    t->theme_override |= THEME_OVR_USE_HEADER;
     return 0;
 }
 
@@ -667,6 +913,7 @@ hpdftbl_use_labels(hpdftbl_t t, _Bool use) {
     _HPDFTBL_CHK_TABLE(t);
     t->use_cell_labels = use;
     t->use_label_grid_style = use;
+    t->theme_override |= THEME_OVR_USE_LABELS | THEME_OVR_USE_LABELGRID;
     return 0;
 }
 
@@ -687,6 +934,7 @@ int
 hpdftbl_use_labelgrid(hpdftbl_t t, _Bool use) {
     _HPDFTBL_CHK_TABLE(t);
     t->use_label_grid_style = use;
+    t->theme_override |= THEME_OVR_USE_LABELGRID;
     return 0;
 }
 
@@ -709,6 +957,23 @@ hpdftbl_set_tag(hpdftbl_t t, void *tag) {
     return 0;
 }
 
+/**
+ * @brief Internal function to check if a string is stored in place in the table image
+ *
+ * Strings in a table created with hpdftbl_create_from_image() may point directly into
+ * the binary image and must not be freed.
+ * @param t Table handle
+ * @param s String to check
+ * @return TRUE if the string is stored in the image, FALSE otherwise
+ * @see hpdftbl_create_from_image()
+ */
+static _Bool
+in_image(hpdftbl_t t, const char *s) {
+    if (t->image == NULL)
+        return FALSE;
+    return (uintptr_t) s >= (uintptr_t) t->image && (uintptr_t) s < (uintptr_t) t->image + t->image_size;
+}
+
 /**
  * @brief Internal function to destroy an individual cell
  *
@@ -722,18 +987,18 @@ static int
 cell_destroy(hpdftbl_t t, size_t r, size_t c) {
     _HPDFTBL_CHK_TABLE(t);
     hpdftbl_cell_t *cell = &t->cells[_HPDFTBL_IDX(r, c)];
-    if (cell->label)
-        free(cell->label);
-    if (cell->content)
-        free(cell->content);
+    if (cell->label && !in_image(t, cell->label))
+        hpdftbl_free(cell->label);
+    if (cell->content && !in_image(t, cell->content))
+        hpdftbl_free(cell->content);
     if (cell->content_dyncb)
-        free(cell->content_dyncb);
+        hpdftbl_free(cell->content_dyncb);
     if (cell->content_style_dyncb)
-        free(cell->content_style_dyncb);
+        hpdftbl_free(cell->content_style_dyncb);
     if (cell->label_dyncb)
-        free(cell->label_dyncb);
+        hpdftbl_free(cell->label_dyncb);
     if (cell->canvas_dyncb)
-        free(cell->canvas_dyncb);
+        hpdftbl_free(cell->canvas_dyncb);
     cell->parent_cell = NULL;
     return 0;
 }
@@ -749,26 +1014,115 @@ cell_destroy(hpdftbl_t t, size_t r, size_t c) {
 int
 hpdftbl_destroy(hpdftbl_t t) {
     _HPDFTBL_CHK_TABLE(t);
-    if (t->title_txt)
-        free(t->title_txt);
+    if (t->title_txt && !in_image(t, t->title_txt))
+        hpdftbl_free(t->title_txt);
     if (t->label_dyncb)
-        free(t->label_dyncb);
+        hpdftbl_free(t->label_dyncb);
     if (t->content_dyncb)
-        free(t->content_dyncb);
+        hpdftbl_free(t->content_dyncb);
     if (t->content_style_dyncb)
-        free(t->content_style_dyncb);
+        hpdftbl_free(t->content_style_dyncb);
     if (t->post_dyncb)
-        free(t->post_dyncb);
+        hpdftbl_free(t->post_dyncb);
     if (t->canvas_dyncb)
-        free(t->canvas_dyncb);
-    free(t->col_width_percent);
-    for (size_t r = 0; r < t->rows; r++) {
+        hpdftbl_free(t->canvas_dyncb);
+    hpdftbl_free(t->col_width_percent);
+    hpdftbl_free(t->col_min_width);
+    hpdftbl_free(t->col_wrap_mode);
+    hpdftbl_free(t->row_offset);
+    hpdftbl_free(t->col_overflow);
+    hpdftbl_free(t->text_off);
+    hpdftbl_free(t->text_pool);
+    // A table which failed to load may have a dimension but no cells
+    for (size_t r = 0; t->cells && r < t->rows; r++) {
         for (size_t c = 0; c < t->cols; c++) {
             cell_destroy(t, r, c);
         }
     }
-    free(t->cells);
-    free(t);
+    hpdftbl_release_theme(t);
+    hpdftbl_free(t->styles);
+    hpdftbl_free(t->errors);
+    hpdftbl_free(t->cells);
+    if (t->image_mapped)
+        hpdftbl_unmap_file((char *) t->image, t->image_size);
+    hpdftbl_free(t);
+    return 0;
+}
+
+/**
+ * @brief Internal function. Get the number of bytes allocated for a string owned by a table.
+ *
+ * @param t Table handle
+ * @param s String, may be NULL
+ * @return Number of bytes, 0 if the string is NULL or in the binary image of the table
+ */
+static size_t
+owned_strlen(hpdftbl_t t, const char *s) {
+    return s && !in_image(t, s) ? strlen(s) + 1 : 0;
+}
+
+/**
+ * @brief Get the number of bytes of memory owned by a table.
+ *
+ * This is all memory that is released by hpdftbl_destroy(), i.e. the table itself, the cells,
+ * the column settings, the labels and content set with hpdftbl_set_cell() and similar functions,
+ * the names of dynamic callbacks, the row offsets from the layout, the style pool and the
+ * collected errors. Labels and content that reference a binary image, see hpdftbl_open_image(),
+ * the shared theme and the caches common to all tables are not included. The memory used
+ * by the caches is given by hpdftbl_get_cache_memory_usage().
+ *
+ * @param t Table handle
+ * @param[out] bytes Number of bytes owned by the table
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_get_cache_memory_usage(), hpdftbl_set_alloc_funcs()
+ */
+int
+hpdftbl_get_memory_usage(hpdftbl_t t, size_t *bytes) {
+    _HPDFTBL_CHK_TABLE(t);
+    if (NULL == bytes) {
+        _HPDFTBL_SET_ERR(t, -18, -1, -1);
+        return -1;
+    }
+
+    size_t n = sizeof(struct hpdftbl);
+    n += owned_strlen(t, t->title_txt);
+    n += owned_strlen(t, t->label_dyncb);
+    n += owned_strlen(t, t->content_dyncb);
+    n += owned_strlen(t, t->content_style_dyncb);
+    n += owned_strlen(t, t->post_dyncb);
+    n += owned_strlen(t, t->canvas_dyncb);
+
+    // Column settings are allocated for all columns when first set
+    if (t->col_width_percent)
+        n += t->cols * sizeof(float);
+    if (t->col_min_width)
+        n += t->cols * sizeof(HPDF_REAL);
+    if (t->col_wrap_mode)
+        n += t->cols * sizeof(hpdftbl_wrap_mode_t);
+    if (t->col_overflow)
+        n += t->cols * sizeof(hpdftbl_overflow_t);
+    if (t->row_offset)
+        n += (t->rows + 1) * sizeof(HPDF_REAL);
+    if (t->text_off)
+        n += 2 * t->rows * t->cols * sizeof(size_t);
+    n += t->text_pool_size;
+
+    if (t->cells) {
+        n += t->rows * t->cols * sizeof(hpdftbl_cell_t);
+        for (size_t i = 0; i < t->rows * t->cols; i++) {
+            const hpdftbl_cell_t *cell = &t->cells[i];
+            n += owned_strlen(t, cell->label);
+            n += owned_strlen(t, cell->content);
+            n += owned_strlen(t, cell->content_dyncb);
+            n += owned_strlen(t, cell->content_style_dyncb);
+            n += owned_strlen(t, cell->label_dyncb);
+            n += owned_strlen(t, cell->canvas_dyncb);
+        }
+    }
+
+    n += t->styles_size * sizeof(hpdf_text_style_t);
+    n += t->errors_size * sizeof(hpdftbl_error_t);
+    *bytes = n;
     return 0;
 }
 
@@ -816,8 +1170,8 @@ hpdftbl_set_cell(hpdftbl_t t, size_t r, size_t c, char *label, char *content) {
 
     cell->colspan = 1;
     cell->rowspan = 1;
-    cell->label = label ? strdup(label) : NULL;
-    cell->content = content ? strdup(content) : NULL;
+    cell->label = label ? hpdftbl_strdup(label) : NULL;
+    cell->content = content ? hpdftbl_strdup(content) : NULL;
     return 0;
 }
 
@@ -913,9 +1267,80 @@ hpdftbl_clear_spanning(hpdftbl_t t) {
  */
 static void
 set_fontc(hpdftbl_t t, char *fontname, HPDF_REAL fsize, HPDF_RGBColor color) {
-    HPDF_Page_SetFontAndSize(t->pdf_page, HPDF_GetFont(t->pdf_doc, fontname, HPDFTBL_DEFAULT_TARGET_ENCODING), fsize);
+    _HPDFTBL_STAT_BEGIN(STAT_FONT_SWITCH);
+    t->stats.font_changes++;
+    t->stats.color_changes++;
+    HPDF_Page_SetFontAndSize(t->pdf_page, HPDF_GetFont(t->pdf_doc, fontname, target_encoding), fsize);
     HPDF_Page_SetRGBFill(t->pdf_page, color.r, color.g, color.b);
     HPDF_Page_SetTextRenderingMode(t->pdf_page, HPDF_FILL);
+    _HPDFTBL_STAT_END(STAT_FONT_SWITCH, 3);
+}
+
+/**
+ * @brief Internal function. Fill a rectangle with a background color.
+ *
+ * @param t Table handle
+ * @param color Background color
+ * @param x Lower left x-position of rectangle
+ * @param y Lower left y-position of rectangle
+ * @param width Width of rectangle
+ * @param height Height of rectangle
+ */
+static void
+table_fill_rect(hpdftbl_t t, HPDF_RGBColor color, HPDF_REAL x, HPDF_REAL y, HPDF_REAL width, HPDF_REAL height) {
+    _HPDFTBL_STAT_BEGIN(STAT_BACKGROUND);
+    t->stats.color_changes++;
+    t->stats.fill_ops++;
+    HPDF_Page_SetRGBFill(t->pdf_page, color.r, color.g, color.b);
+    HPDF_Page_Rectangle(t->pdf_page, x, y, width, height);
+    HPDF_Page_Fill(t->pdf_page);
+    _HPDFTBL_STAT_END(STAT_BACKGROUND, 3);
+}
+
+/**
+ * @brief Internal function. Stroke a grid line.
+ *
+ * @param t Table handle
+ * @param grid Grid style of the line
+ * @param x1 Start x-position
+ * @param y1 Start y-position
+ * @param x2 End x-position
+ * @param y2 End y-position
+ */
+static void
+table_grid_line(hpdftbl_t t, const hpdftbl_grid_style_t *grid, HPDF_REAL x1, HPDF_REAL y1, HPDF_REAL x2,
+                HPDF_REAL y2) {
+    _HPDFTBL_STAT_BEGIN(STAT_GRID);
+    t->stats.color_changes++;
+    t->stats.path_ops++;
+    HPDF_Page_SetRGBStroke(t->pdf_page, grid->color.r, grid->color.g, grid->color.b);
+    HPDF_Page_SetLineWidth(t->pdf_page, grid->width);
+    hpdftbl_set_line_dash(t, grid->line_dashstyle);
+    HPDF_Page_MoveTo(t->pdf_page, x1, y1);
+    HPDF_Page_LineTo(t->pdf_page, x2, y2);
+    HPDF_Page_Stroke(t->pdf_page);
+    _HPDFTBL_STAT_END(STAT_GRID, 6);
+}
+
+/**
+ * @brief Internal function. Write a text in a table with the current encoding.
+ *
+ * Internal function. Same as hpdftbl_encoding_text_out() but the text is also counted in
+ * the render statistics of the table.
+ *
+ * @param t Table handle
+ * @param xpos X coordinate
+ * @param ypos Y coordinate
+ * @param text Text to print, may be NULL
+ * @see hpdftbl_get_render_stats()
+ */
+static void
+table_text_out(hpdftbl_t t, HPDF_REAL xpos, HPDF_REAL ypos, char *text) {
+    if (NULL == text)
+        return;
+    t->stats.text_bytes += strlen(text);
+    if (-1 == hpdftbl_encoding_text_out(t->pdf_page, xpos, ypos, text))
+        t->stats.encoding_errors++;
 }
 
 /*static void
@@ -957,12 +1382,17 @@ table_title_stroke(hpdftbl_t t) {
     const HPDF_REAL height = 1.5f * t->title_style.fsize;
 
     // Stoke outer border and fill
+    _HPDFTBL_STAT_BEGIN(STAT_BACKGROUND);
+    t->stats.color_changes += 2;
+    t->stats.path_ops++;
+    t->stats.fill_ops++;
     HPDF_Page_SetRGBStroke(t->pdf_page, t->outer_grid.color.r, t->outer_grid.color.g, t->outer_grid.color.b);
     HPDF_Page_SetRGBFill(t->pdf_page, t->title_style.background.r, t->title_style.background.g,
                          t->title_style.background.b);
     HPDF_Page_SetLineWidth(t->pdf_page, t->outer_grid.width);
     HPDF_Page_Rectangle(t->pdf_page, x, y + t->height, t->width, height);
     HPDF_Page_FillStroke(t->pdf_page);
+    _HPDFTBL_STAT_END(STAT_BACKGROUND, 5);
 
     set_fontc(t, t->title_style.font, t->title_style.fsize, t->title_style.color);
 
@@ -977,7 +1407,7 @@ table_title_stroke(hpdftbl_t t) {
     }
 
     HPDF_Page_BeginText(t->pdf_page);
-    hpdftbl_encoding_text_out(t->pdf_page, xpos, ypos, t->title_txt);
+    table_text_out(t, xpos, ypos, t->title_txt);
     HPDF_Page_EndText(t->pdf_page);
 
     // Return height of the stroked bounding box
@@ -1013,7 +1443,7 @@ hpdftbl_set_labels(hpdftbl_t t, char **labels) {
         for (size_t c = 0; c < t->cols; c++) {
             size_t idx = r * t->cols + c;
             hpdftbl_cell_t *cell = &t->cells[idx];
-            cell->label = labels[idx] ? strdup(labels[idx]) : NULL;
+            cell->label = labels[idx] ? hpdftbl_strdup(labels[idx]) : NULL;
         }
     }
     return 0;
@@ -1051,7 +1481,7 @@ hpdftbl_set_content(hpdftbl_t t, char **content) {
         for (size_t c = 0; c < t->cols; c++) {
             size_t idx = r * t->cols + c;
             hpdftbl_cell_t *cell = &t->cells[idx];
-            cell->content = content[idx] ? strdup(content[idx]) : NULL;
+            cell->content = content[idx] ? hpdftbl_strdup(content[idx]) : NULL;
         }
     }
     return 0;
@@ -1077,6 +1507,7 @@ hpdftbl_set_label_style(hpdftbl_t t, char *font, HPDF_REAL fsize, HPDF_RGBColor
     t->label_style.fsize = fsize;
     t->label_style.color = color;
     t->label_style.background = background;
+    t->theme_override |= THEME_OVR_LABEL_STYLE;
     return 0;
 }
 
@@ -1103,9 +1534,37 @@ hpdftbl_set_content_style(hpdftbl_t t, char *font, HPDF_REAL fsize, HPDF_RGBColo
     t->content_style.fsize = fsize;
     t->content_style.color = color;
     t->content_style.background = background;
+    t->theme_override |= THEME_OVR_CONTENT_STYLE;
     return 0;
 }
 
+/**
+ * @brief Internal function. Get the style id for a cell content style.
+ *
+ * @param t Table handle
+ * @param font Font name. If NULL the table content style is used and the id is 0.
+ * @param fsize Font size
+ * @param color Color
+ * @param background Background color
+ * @param[out] id Style id
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_intern_style()
+ */
+static int
+content_style_id(hpdftbl_t t, char *font, HPDF_REAL fsize, HPDF_RGBColor color, HPDF_RGBColor background,
+                 unsigned *id) {
+    if (NULL == font) {
+        *id = 0;
+        return 0;
+    }
+#ifdef __cplusplus
+    hpdf_text_style_t style = {font, fsize, color, background, LEFT};
+#else
+    hpdf_text_style_t style = (hpdf_text_style_t) {font, fsize, color, background, LEFT};
+#endif
+    return hpdftbl_intern_style(t, &style, id);
+}
+
 /**
  * @brief Set the text style for an entire row of cells.
  *
@@ -1123,8 +1582,13 @@ hpdftbl_set_content_style(hpdftbl_t t, char *font, HPDF_REAL fsize, HPDF_RGBColo
 int
 hpdftbl_set_row_content_style(hpdftbl_t t, size_t r, char *font, HPDF_REAL fsize, HPDF_RGBColor color,
                               HPDF_RGBColor background) {
+    _HPDFTBL_CHK_TABLE(t);
+    if (!chktbl(t, r, 0)) return -1;
+    unsigned style_id;
+    if (-1 == content_style_id(t, font, fsize, color, background, &style_id))
+        return -1;
     for (size_t c = 0; c < t->cols; c++) {
-        hpdftbl_set_cell_content_style(t, r, c, font, fsize, color, background);
+        t->cells[_HPDFTBL_IDX(r, c)].style_id = style_id;
     }
     return 0;
 }
@@ -1146,8 +1610,13 @@ hpdftbl_set_row_content_style(hpdftbl_t t, size_t r, char *font, HPDF_REAL fsize
 int
 hpdftbl_set_col_content_style(hpdftbl_t t, size_t c, char *font, HPDF_REAL fsize, HPDF_RGBColor color,
                               HPDF_RGBColor background) {
+    _HPDFTBL_CHK_TABLE(t);
+    if (!chktbl(t, 0, c)) return -1;
+    unsigned style_id;
+    if (-1 == content_style_id(t, font, fsize, color, background, &style_id))
+        return -1;
     for (size_t r = 0; r < t->rows; r++) {
-        hpdftbl_set_cell_content_style(t, r, c, font, fsize, color, background);
+        t->cells[_HPDFTBL_IDX(r, c)].style_id = style_id;
     }
     return 0;
 }
@@ -1156,10 +1625,11 @@ hpdftbl_set_col_content_style(hpdftbl_t t, size_t c, char *font, HPDF_REAL fsize
  * @brief Set the text style for content of specified cell.
  *
  * SSet the font style for content of specified cell. This will override the global cell content setting.
+ * Each distinct style is only stored once in the table, see hpdftbl_intern_style().
  * @param t Table handle
  * @param r Cell row
  * @param c Cell column
- * @param font Font name
+ * @param font Font name. If NULL the cell will use the table content style.
  * @param fsize Font size
  * @param color Color
  * @param background Background color
@@ -1172,16 +1642,10 @@ hpdftbl_set_cell_content_style(hpdftbl_t t, size_t r, size_t c,
                                char *font, HPDF_REAL fsize, HPDF_RGBColor color,
                                HPDF_RGBColor background) {
     _HPDFTBL_CHK_TABLE(t);
-    chktbl(t, r, c);
-    hpdftbl_cell_t *cell = &t->cells[_HPDFTBL_IDX(r, c)];
-    cell->content_style.font = font;
-    cell->content_style.fsize = fsize;
-    cell->content_style.color = color;
-    cell->content_style.background = background;
-    return 0;
+    if (!chktbl(t, r, c)) return -1;
+    return content_style_id(t, font, fsize, color, background, &t->cells[_HPDFTBL_IDX(r, c)].style_id);
 }
 
-
 /**
  * @brief Set the table title text style
  *
@@ -1203,6 +1667,7 @@ hpdftbl_set_title_style(hpdftbl_t t, char *font, HPDF_REAL fsize, HPDF_RGBColor
     t->title_style.fsize = fsize;
     t->title_style.color = color;
     t->title_style.background = background;
+    t->theme_override |= THEME_OVR_TITLE_STYLE;
     return 0;
 }
 
@@ -1222,9 +1687,9 @@ hpdftbl_set_title_style(hpdftbl_t t, char *font, HPDF_REAL fsize, HPDF_RGBColor
 int
 hpdftbl_set_title(hpdftbl_t t, char *title) {
     _HPDFTBL_CHK_TABLE(t);
-    if (t->title_txt)
-        free(t->title_txt);
-    t->title_txt = strdup(title);
+    if (t->title_txt && !in_image(t, t->title_txt))
+        hpdftbl_free(t->title_txt);
+    t->title_txt = hpdftbl_strdup(title);
     return 0;
 }
 
@@ -1242,6 +1707,7 @@ int
 hpdftbl_set_title_halign(hpdftbl_t t, hpdftbl_text_align_t align) {
     _HPDFTBL_CHK_TABLE(t);
     t->title_style.halign = align;
+    t->theme_override |= THEME_OVR_TITLE_HALIGN;
     return 0;
 }
 
@@ -1314,43 +1780,449 @@ hpdftbl_stroke_from_data(HPDF_Doc pdf_doc, HPDF_Page pdf_page, hpdftbl_spec_t *t
 }
 
 /**
- * @brief Internal function.
- *
- * Internal function. Calculate the relative position of each cell in the
- * table taking row and column spanning into account. This function loops
- * through each cell and calculates its delta_X and delta_y positions which
- * are hen stored in each cell data structure.
- *
- * The calculation is done at the time of stroking and is not available
- * prior.
+ * @brief Offset of a cell text in the text pool when the callback did not give a text
+ */
+#define TEXT_NOT_SET SIZE_MAX
+
+/**
+ * @brief Internal function. Keep a copy of a text returned by a callback.
  *
  * @param t Table handle
- * @return 0 on success, -1 on failure
- *
- * @see hpdftbl_stroke()
+ * @param slot Index in `t->text_off`
+ * @param text Text to copy
+ * @return 0 on success, -1 on out of memory
  */
 static int
-calc_cell_pos(hpdftbl_t t) {
-    // Calculate relative position for all cells in relation
-    // to bottom left table corner
-    HPDF_REAL base_cell_height = (float)(t->height) / (float)(t->rows);
-    //HPDF_REAL base_cell_width = t->width / t->cols;
-    HPDF_REAL base_cell_width_percent = 100.0f / (float)t->cols;
-    HPDF_REAL delta_x = 0;
-    HPDF_REAL delta_y = 0;
-
-    // Recalculate column widths
-    // Pass 1. Determine how many columns have been manually specified
-    float tot_specified_width_percent = 0;
-    size_t num_specified_cols = 0;
-    for (size_t c = 0; c < t->cols; c++) {
-        if (t->col_width_percent[c] > 0) {
-            num_specified_cols++;
-            tot_specified_width_percent += t->col_width_percent[c];
+table_keep_text(hpdftbl_t t, size_t slot, const char *text) {
+    if (t->text_off == NULL) {
+#ifdef __cplusplus
+        t->text_off = static_cast<size_t*>(hpdftbl_calloc(t->rows * t->cols, 2 * sizeof(size_t)));
+#else
+        t->text_off = hpdftbl_calloc(t->rows * t->cols, 2 * sizeof(size_t));
+#endif
+        if (t->text_off == NULL) {
+            _HPDFTBL_SET_ERR(t, -5, -1, -1);
+            return -1;
+        }
+        for (size_t i = 0; i < 2 * t->rows * t->cols; i++) {
+            t->text_off[i] = TEXT_NOT_SET;
         }
     }
 
-    if (tot_specified_width_percent > 100.0) {
+    const size_t len = strlen(text) + 1;
+    if (t->text_pool_len + len > t->text_pool_size) {
+        size_t size = t->text_pool_size ? t->text_pool_size : 256;
+        while (size < t->text_pool_len + len) {
+            size *= 2;
+        }
+#ifdef __cplusplus
+        char *pool = static_cast<char*>(hpdftbl_realloc(t->text_pool, size));
+#else
+        char *pool = hpdftbl_realloc(t->text_pool, size);
+#endif
+        if (pool == NULL) {
+            _HPDFTBL_SET_ERR(t, -5, -1, -1);
+            return -1;
+        }
+        t->text_pool = pool;
+        t->text_pool_size = size;
+    }
+    memcpy(t->text_pool + t->text_pool_len, text, len);
+    t->text_off[slot] = t->text_pool_len;
+    t->text_pool_len += len;
+    return 0;
+}
+
+/**
+ * @brief Internal function. Call the content and label callbacks of all cells.
+ *
+ * Internal function. The callbacks are called once per cell when the table is laid out.
+ * The returned texts are copied to the table, since a callback may return a static buffer,
+ * and the copies are then used by the layout, the conditional formatting rules and the
+ * stroking of the table. A cell callback overrides the table callback.
+ *
+ * @param t Table handle
+ * @return 0 on success, -1 on out of memory
+ * @see hpdftbl_cell_content()
+ */
+static int
+table_resolve_text(hpdftbl_t t) {
+    t->text_pool_len = 0;
+    if (t->text_off) {
+        for (size_t i = 0; i < 2 * t->rows * t->cols; i++) {
+            t->text_off[i] = TEXT_NOT_SET;
+        }
+    }
+
+    for (size_t r = 0; r < t->rows; r++) {
+        for (size_t c = 0; c < t->cols; c++) {
+            hpdftbl_cell_t *cell = &t->cells[_HPDFTBL_IDX(r, c)];
+            if (cell->parent_cell != NULL)
+                continue;
+
+            hpdftbl_content_callback_t content_cb = cell->content_cb ? cell->content_cb : t->content_cb;
+            if (content_cb) {
+                _HPDFTBL_STAT_BEGIN(STAT_CONTENT_CB);
+                t->stats.content_cb_calls++;
+                char *content = content_cb(t->tag, r, c);
+                _HPDFTBL_STAT_END(STAT_CONTENT_CB, 0);
+                if (content && -1 == table_keep_text(t, 2 * _HPDFTBL_IDX(r, c), content))
+                    return -1;
+            }
+
+            // Labels are not used in the header row
+            hpdftbl_content_callback_t label_cb = cell->label_cb ? cell->label_cb : t->label_cb;
+            if (label_cb && t->use_cell_labels && !(t->use_header_row && r == 0)) {
+                _HPDFTBL_STAT_BEGIN(STAT_LABEL_CB);
+                t->stats.label_cb_calls++;
+                char *label = label_cb(t->tag, r, c);
+                _HPDFTBL_STAT_END(STAT_LABEL_CB, 0);
+                if (label && -1 == table_keep_text(t, 2 * _HPDFTBL_IDX(r, c) + 1, label))
+                    return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Internal function. Get the content text of a cell.
+ *
+ * Internal function. The text returned by a content callback when the table was laid out
+ * overrides the static cell content.
+ *
+ * @param t Table handle
+ * @param cell The cell
+ * @param r Row
+ * @param c Column
+ * @return The content text, may be NULL
+ * @see table_resolve_text()
+ */
+char *
+hpdftbl_cell_content(hpdftbl_t t, hpdftbl_cell_t *cell, size_t r, size_t c) {
+    if (t->text_off && t->text_off[2 * _HPDFTBL_IDX(r, c)] != TEXT_NOT_SET)
+        return t->text_pool + t->text_off[2 * _HPDFTBL_IDX(r, c)];
+    return cell->content;
+}
+
+/**
+ * @brief Internal function. Get the label text of a cell.
+ *
+ * Internal function. The text returned by a label callback when the table was laid out
+ * overrides the static cell label.
+ *
+ * @param t Table handle
+ * @param cell The cell
+ * @param r Row
+ * @param c Column
+ * @return The label text, may be NULL
+ * @see table_resolve_text()
+ */
+static char *
+cell_label(hpdftbl_t t, hpdftbl_cell_t *cell, size_t r, size_t c) {
+    if (t->text_off && t->text_off[2 * _HPDFTBL_IDX(r, c) + 1] != TEXT_NOT_SET)
+        return t->text_pool + t->text_off[2 * _HPDFTBL_IDX(r, c) + 1];
+    return cell->label;
+}
+
+/**
+ * @brief Internal function. Get the font and font size used for the content of a cell.
+ *
+ * Internal function. This is the header style in the header row, the cell style if the
+ * cell has its own style and otherwise the table content style. Style callbacks
+ * are not considered.
+ *
+ * @param t Table handle
+ * @param cell The cell
+ * @param r Row
+ * @param font Returned font name
+ * @param fsize Returned font size
+ */
+static void
+cell_font(hpdftbl_t t, hpdftbl_cell_t *cell, size_t r, char **font, HPDF_REAL *fsize) {
+    if (t->use_header_row && r == 0) {
+        *font = t->header_style.font;
+        *fsize = t->header_style.fsize;
+    } else if (hpdftbl_cell_style(t, cell)) {
+        *font = hpdftbl_cell_style(t, cell)->font;
+        *fsize = hpdftbl_cell_style(t, cell)->fsize;
+    } else {
+        *font = t->content_style.font;
+        *fsize = t->content_style.fsize;
+    }
+}
+
+/**
+ * @brief Internal function. Determine if the content of a cell should be word wrapped.
+ *
+ * @param t Table handle
+ * @param cell The cell
+ * @param c Column
+ * @return TRUE if the content should be wrapped, FALSE otherwise
+ */
+static _Bool
+cell_use_wrap(hpdftbl_t t, hpdftbl_cell_t *cell, size_t c) {
+    hpdftbl_wrap_mode_t mode = cell->wrap_mode;
+    if (mode == WRAP_INHERIT && t->col_wrap_mode)
+        mode = t->col_wrap_mode[c];
+    if (mode == WRAP_INHERIT)
+        mode = t->wrap_mode;
+    return mode == WRAP_WORD;
+}
+
+/**
+ * @brief Internal function. Calculate the column widths from the table content.
+ *
+ * Internal function. The natural width of each column is the width of the widest
+ * content or label text in the column plus the cell padding. This is calculated in a
+ * single pass over all cells using the cached glyph metrics. If the natural widths do
+ * not fit within the maximum width the columns are shrunk proportionally while still
+ * respecting the minimum width of each column.
+ *
+ * The resulting widths are stored as column width percentages and the table width
+ * is set to the total width of all columns.
+ *
+ * @param t Table handle
+ * @param max_width Maximum width of table. If <= 0 the width is not limited.
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_set_auto_colwidth()
+ */
+static int
+calc_auto_colwidth(hpdftbl_t t, HPDF_REAL max_width) {
+    // Natural width, minimum width and a flag for columns fixed at minimum width
+#ifdef __cplusplus
+    HPDF_REAL *w = static_cast<HPDF_REAL*>(hpdftbl_calloc(3 * t->cols, sizeof(HPDF_REAL)));
+#else
+    HPDF_REAL *w = hpdftbl_calloc(3 * t->cols, sizeof(HPDF_REAL));
+#endif
+    if (w == NULL) {
+        _HPDFTBL_SET_ERR(t, -5, -1, -1);
+        return -1;
+    }
+    HPDF_REAL *min_w = w + t->cols;
+    HPDF_REAL *at_min = w + 2 * t->cols;
+
+    for (size_t c = 0; c < t->cols; c++) {
+        const HPDF_REAL padding = (c == 0 ? t->outer_grid.width : t->inner_vgrid.width) + 2;
+        min_w[c] = 2 * padding;
+        if (t->col_min_width && t->col_min_width[c] > min_w[c])
+            min_w[c] = t->col_min_width[c];
+        w[c] = min_w[c];
+    }
+
+    for (size_t r = 0; r < t->rows; r++) {
+        const _Bool is_header = t->use_header_row && r == 0;
+        for (size_t c = 0; c < t->cols; c++) {
+            hpdftbl_cell_t *cell = &t->cells[_HPDFTBL_IDX(r, c)];
+            if (cell->parent_cell != NULL || cell->colspan > 1)
+                continue;
+
+            char *content = hpdftbl_cell_content(t, cell, r, c);
+            char *font;
+            HPDF_REAL fsize;
+            cell_font(t, cell, r, &font, &fsize);
+            HPDF_REAL tw = hpdftbl_text_width(t->pdf_doc, font, fsize, content);
+
+            if (t->use_cell_labels && !is_header) {
+                char *label = cell_label(t, cell, r, c);
+                const HPDF_REAL lw = hpdftbl_text_width(t->pdf_doc, t->label_style.font, t->label_style.fsize, label);
+                tw = max(tw, lw);
+            }
+
+            const HPDF_REAL padding = (c == 0 ? t->outer_grid.width : t->inner_vgrid.width) + 2;
+            w[c] = max(w[c], tw + 2 * padding);
+        }
+    }
+
+    HPDF_REAL total = 0;
+    HPDF_REAL total_min = 0;
+    for (size_t c = 0; c < t->cols; c++) {
+        total += w[c];
+        total_min += min_w[c];
+    }
+
+    if (max_width > 0 && total > max_width) {
+        if (total_min > max_width) {
+            hpdftbl_free(w);
+            _HPDFTBL_SET_ERR(t, -13, -1, -1);
+            return -1;
+        }
+
+        // Shrink proportionally. A column that would become narrower than its minimum
+        // width is fixed at the minimum and the remaining columns are shrunk more. This
+        // is repeated at most once per column.
+        _Bool changed = TRUE;
+        HPDF_REAL scale = 1;
+        while (changed) {
+            HPDF_REAL fixed = 0;
+            HPDF_REAL flexible = 0;
+            for (size_t c = 0; c < t->cols; c++) {
+                if (at_min[c] > 0)
+                    fixed += min_w[c];
+                else
+                    flexible += w[c];
+            }
+            scale = flexible > 0 ? (max_width - fixed) / flexible : 0;
+            changed = FALSE;
+            for (size_t c = 0; c < t->cols; c++) {
+                if (at_min[c] == 0 && w[c] * scale < min_w[c]) {
+                    at_min[c] = 1;
+                    changed = TRUE;
+                }
+            }
+        }
+        for (size_t c = 0; c < t->cols; c++) {
+            w[c] = at_min[c] > 0 ? min_w[c] : w[c] * scale;
+        }
+        total = max_width;
+    }
+
+    for (size_t c = 0; c < t->cols; c++) {
+        t->col_width_percent[c] = 100.0f * w[c] / total;
+    }
+    t->width = total;
+    hpdftbl_free(w);
+    return 0;
+}
+
+/**
+ * @brief Internal function. Calculate the height of each row.
+ *
+ * Internal function. The height of row `r` is stored in `t->row_offset[r+1]`.
+ *
+ * Without automatic row heights all rows get the same height. If the table height is
+ * automatically calculated a row with word wrapped content is made high enough to
+ * fit all lines.
+ *
+ * With automatic row heights each row gets the height needed by the highest cell in
+ * the row. This depends on the font size, the number of wrapped lines and if labels
+ * are used. A row is never lower than the minimum row height. A cell spanning several
+ * rows that needs more height than the rows it spans makes the last of those rows higher.
+ *
+ * Each cell is measured only once.
+ *
+ * @param t Table handle
+ * @param auto_height TRUE if the table height has been automatically calculated
+ * @param col_x Left x-position of each column, entry `t->cols` is the table width
+ * @param base_cell_height Row height when automatic row heights are not used
+ * @see hpdftbl_set_auto_rowheight()
+ */
+static void
+calc_row_heights(hpdftbl_t t, _Bool auto_height, const HPDF_REAL *col_x, HPDF_REAL base_cell_height) {
+    HPDF_REAL *row_height = t->row_offset + 1;
+    for (size_t r = 0; r < t->rows; r++) {
+        row_height[r] = t->use_auto_rowheight ? t->minrowheight : base_cell_height;
+    }
+    if (!t->use_auto_rowheight && !auto_height)
+        return;
+
+    _Bool has_rowspan = FALSE;
+    for (size_t r = 0; r < t->rows; r++) {
+        const _Bool is_header = t->use_header_row && r == 0;
+        for (size_t c = 0; c < t->cols; c++) {
+            hpdftbl_cell_t *cell = &t->cells[_HPDFTBL_IDX(r, c)];
+            const _Bool wrap = cell->parent_cell == NULL && cell_use_wrap(t, cell, c);
+
+            // With fixed row heights only wrapped content can make a row higher
+            if (!t->use_auto_rowheight && (!wrap || cell->rowspan > 1))
+                continue;
+
+            char *font;
+            HPDF_REAL fsize;
+            cell_font(t, cell, r, &font, &fsize);
+
+            size_t lines = 1;
+            if (wrap) {
+                const size_t last_col = min(c + max(cell->colspan, 1), t->cols);
+                const HPDF_REAL left_right_padding = c == 0 ? t->outer_grid.width + 2 : t->inner_vgrid.width + 2;
+                const size_t wrapped = hpdftbl_wrap_text(t->pdf_doc, font, fsize, hpdftbl_cell_content(t, cell, r, c),
+                                                         col_x[last_col] - col_x[c] - 2 * left_right_padding, NULL, 0);
+                lines = max(wrapped, 1);
+            }
+
+            HPDF_REAL h = base_cell_height;
+            if (t->use_auto_rowheight) {
+                // Same proportions as the automatically calculated table height in hpdftbl_stroke()
+                if (t->use_cell_labels && !is_header)
+                    h = (fsize + t->label_style.fsize) * 1.5f;
+                else
+                    h = fsize * 1.6f;
+            }
+            h += (HPDF_REAL) (lines - 1) * fsize * HPDFTBL_WRAP_LINE_SPACING;
+
+            if (cell->parent_cell == NULL && cell->rowspan > 1) {
+                // Resolved below when the height of all spanned rows are known
+                cell->height = h;
+                has_rowspan = TRUE;
+            } else {
+                row_height[r] = max(row_height[r], h);
+            }
+        }
+    }
+
+    if (!has_rowspan)
+        return;
+
+    for (size_t r = 0; r < t->rows; r++) {
+        for (size_t c = 0; c < t->cols; c++) {
+            hpdftbl_cell_t *cell = &t->cells[_HPDFTBL_IDX(r, c)];
+            if (cell->parent_cell != NULL || cell->rowspan <= 1)
+                continue;
+            const size_t last_row = min(r + cell->rowspan, t->rows);
+            HPDF_REAL h = 0;
+            for (size_t rr = r; rr < last_row; rr++) {
+                h += row_height[rr];
+            }
+            if (cell->height > h) {
+                row_height[last_row - 1] += cell->height - h;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Internal function.
+ *
+ * Internal function. Calculate the relative position of each cell in the
+ * table taking row and column spanning into account. This function loops
+ * through each cell and calculates its delta_X and delta_y positions which
+ * are hen stored in each cell data structure.
+ *
+ * The calculation is done at the time of stroking and is not available
+ * prior.
+ *
+ * The offset of each row from the top of the table is stored in `t->row_offset`
+ * which makes the position of any row available without summing row heights.
+ * If the table height is automatically calculated it is updated to the sum of
+ * the row heights.
+ *
+ * @param t Table handle
+ * @param auto_height TRUE if the table height has been automatically calculated
+ * @return 0 on success, -1 on failure
+ *
+ * @see hpdftbl_stroke()
+ */
+static int
+calc_cell_pos(hpdftbl_t t, _Bool auto_height) {
+    // Calculate relative position for all cells in relation
+    // to bottom left table corner
+    HPDF_REAL base_cell_height = (float)(t->height) / (float)(t->rows);
+    //HPDF_REAL base_cell_width = t->width / t->cols;
+    HPDF_REAL base_cell_width_percent = 100.0f / (float)t->cols;
+
+    // Recalculate column widths
+    // Pass 1. Determine how many columns have been manually specified
+    float tot_specified_width_percent = 0;
+    size_t num_specified_cols = 0;
+    for (size_t c = 0; c < t->cols; c++) {
+        if (t->col_width_percent[c] > 0) {
+            num_specified_cols++;
+            tot_specified_width_percent += t->col_width_percent[c];
+        }
+    }
+
+    // Allow for rounding when the widths have been calculated from the content
+    if (tot_specified_width_percent > 100.001) {
         _HPDFTBL_SET_ERR(t, -12, -1, -1);
         return -1;
     }
@@ -1361,12 +2233,12 @@ calc_cell_pos(hpdftbl_t t) {
     const float num_unspecified_cols = (float) (t->cols - num_specified_cols);
     if (num_unspecified_cols > 0) {
         base_cell_width_percent = remaining_width_percent / num_unspecified_cols;
-    }
 
-    // Sanity check
-    if (base_cell_width_percent < HPDFTBL_MIN_CALCULATED_PERCENT_CELL_WIDTH) {
-        _HPDFTBL_SET_ERR(t, -13, -1, -1);
-        return -1;
+        // Sanity check
+        if (base_cell_width_percent < HPDFTBL_MIN_CALCULATED_PERCENT_CELL_WIDTH) {
+            _HPDFTBL_SET_ERR(t, -13, -1, -1);
+            return -1;
+        }
     }
 
     for (size_t c = 0; c < t->cols; c++) {
@@ -1375,40 +2247,62 @@ calc_cell_pos(hpdftbl_t t) {
         }
     }
 
-    // Calculate the position for all cells.
-    //
-    // Pass 1. Give the basic position for all cells without
-    // taking spanning in consideration
-    for (int r = (int)t->rows - 1; r >= 0; r--) {
-        for (size_t c = 0; c < t->cols; c++) {
-            hpdftbl_cell_t *cell = &t->cells[_HPDFTBL_IDX(r, c)];
-            cell->delta_x = delta_x;
-            cell->delta_y = delta_y;
-            cell->width = (t->col_width_percent[c] / 100.0f) * t->width; //base_cell_width;
-            cell->height = base_cell_height;
-            delta_x += cell->width; //base_cell_width;
+    // Left x-position of each column relative to the table. Entry `cols` is the table width.
+#ifdef __cplusplus
+    HPDF_REAL *col_x = static_cast<HPDF_REAL*>(hpdftbl_calloc(t->cols + 1, sizeof(HPDF_REAL)));
+#else
+    HPDF_REAL *col_x = hpdftbl_calloc(t->cols + 1, sizeof(HPDF_REAL));
+#endif
+    if (col_x == NULL) {
+        _HPDFTBL_SET_ERR(t, -5, -1, -1);
+        return -1;
+    }
+    for (size_t c = 0; c < t->cols; c++) {
+        col_x[c + 1] = col_x[c] + (t->col_width_percent[c] / 100.0f) * t->width;
+    }
+
+    // Row heights are first stored in row_offset[r+1] and then accumulated
+    // to the offset of each row from the top of the table.
+    hpdftbl_free(t->row_offset);
+#ifdef __cplusplus
+    t->row_offset = static_cast<HPDF_REAL*>(hpdftbl_calloc(t->rows + 1, sizeof(HPDF_REAL)));
+#else
+    t->row_offset = hpdftbl_calloc(t->rows + 1, sizeof(HPDF_REAL));
+#endif
+    if (t->row_offset == NULL) {
+        hpdftbl_free(col_x);
+        _HPDFTBL_SET_ERR(t, -5, -1, -1);
+        return -1;
+    }
+    calc_row_heights(t, auto_height, col_x, base_cell_height);
+    for (size_t r = 0; r < t->rows; r++) {
+        t->row_offset[r + 1] += t->row_offset[r];
+    }
+
+    if (auto_height) {
+        t->height = t->row_offset[t->rows];
+    } else if (t->use_auto_rowheight && t->row_offset[t->rows] > 0) {
+        // Distribute the specified height in proportion to the content height of the rows
+        const HPDF_REAL scale = t->height / t->row_offset[t->rows];
+        for (size_t r = 1; r <= t->rows; r++) {
+            t->row_offset[r] *= scale;
         }
-        delta_x = 0;
-        delta_y += base_cell_height;
     }
 
-    // Adjust for row and column spanning
+    // Calculate the position for all cells. Spanning cells cover the rows
+    // and columns they span.
     for (size_t r = 0; r < t->rows; r++) {
         for (size_t c = 0; c < t->cols; c++) {
             hpdftbl_cell_t *cell = &t->cells[_HPDFTBL_IDX(r, c)];
-            if (cell->rowspan > 1) {
-                cell->delta_y = t->cells[(r + cell->rowspan - 1) * t->cols + c].delta_y;
-                cell->height = (float)cell->rowspan * base_cell_height;
-            }
-            if (cell->colspan > 1) {
-                HPDF_REAL col_span_with = 0.0f;
-                for (size_t cc = 0; cc < cell->colspan; cc++) {
-                    col_span_with += t->cells[_HPDFTBL_IDX(r, cc + c)].width;
-                }
-                cell->width = col_span_with;
-            }
+            const size_t last_row = min(r + max(cell->rowspan, 1), t->rows);
+            const size_t last_col = min(c + max(cell->colspan, 1), t->cols);
+            cell->delta_x = col_x[c];
+            cell->width = col_x[last_col] - col_x[c];
+            cell->delta_y = t->height - t->row_offset[last_row];
+            cell->height = t->row_offset[last_row] - t->row_offset[r];
         }
     }
+    hpdftbl_free(col_x);
 
 #ifdef ENABLE_DEBUG_TRACE_PRINT
     for (size_t c = 0; c < t->cols; c++) {
@@ -1451,6 +2345,158 @@ hpdftbl_get_last_auto_height(HPDF_REAL *height) {
 //}
 
 
+/**
+ * @brief Internal function. Stroke word wrapped cell content.
+ *
+ * Internal function. The content is broken into lines that fit the cell width. The last
+ * line is written at the same baseline as single line content would have been and the
+ * other lines above it. In the header row the lines are vertically centered around
+ * the baseline for single line content.
+ *
+ * @param t Table handle
+ * @param cell The cell
+ * @param r Row
+ * @param content Content text
+ * @param font Font name
+ * @param fsize Font size
+ * @param halign Horizontal alignment
+ * @param x Left x-position of cell
+ * @param ypos Baseline for single line content
+ * @param left_right_padding Padding on both sides of the text
+ */
+static void
+table_cell_stroke_wrapped(hpdftbl_t t, hpdftbl_cell_t *cell, const size_t r, char *content, char *font,
+                          HPDF_REAL fsize, hpdftbl_text_align_t halign, HPDF_REAL x, HPDF_REAL ypos,
+                          HPDF_REAL left_right_padding) {
+    // Most cells only have a few lines so avoid allocating memory for the lines in the common case
+    hpdftbl_text_line_t stack_lines[16];
+    hpdftbl_text_line_t *lines = stack_lines;
+    const HPDF_REAL width = cell->width - 2 * left_right_padding;
+    const size_t n = hpdftbl_wrap_text(t->pdf_doc, font, fsize, content, width, lines, 16);
+    if (n > 16) {
+#ifdef __cplusplus
+        lines = static_cast<hpdftbl_text_line_t*>(hpdftbl_calloc(n, sizeof(hpdftbl_text_line_t)));
+#else
+        lines = hpdftbl_calloc(n, sizeof(hpdftbl_text_line_t));
+#endif
+        if (lines == NULL) {
+            _HPDFTBL_SET_ERR(t, -5, r, -1);
+            return;
+        }
+        hpdftbl_wrap_text(t->pdf_doc, font, fsize, content, width, lines, n);
+    }
+
+    // Each line is temporarily terminated in a copy of the content
+    char *buff = hpdftbl_strdup(content);
+    if (buff == NULL) {
+        if (lines != stack_lines)
+            hpdftbl_free(lines);
+        _HPDFTBL_SET_ERR(t, -5, r, -1);
+        return;
+    }
+
+    const HPDF_REAL line_height = fsize * HPDFTBL_WRAP_LINE_SPACING;
+    HPDF_REAL y = ypos + (HPDF_REAL) (n - 1) * line_height;
+    if (t->use_header_row && r == 0) {
+        y = ypos + (HPDF_REAL) (n - 1) * line_height / 2;
+    }
+
+    HPDF_Page_BeginText(t->pdf_page);
+    for (size_t i = 0; i < n; i++, y -= line_height) {
+        if (lines[i].len == 0)
+            continue;
+        HPDF_REAL xpos = x + left_right_padding;
+        if (halign == RIGHT) {
+            xpos = x + cell->width - lines[i].width - left_right_padding;
+        } else if (halign == CENTER) {
+            xpos = x + (cell->width - lines[i].width) / 2.0f;
+        }
+        char *end = buff + lines[i].start + lines[i].len;
+        const char saved = *end;
+        *end = '\0';
+        table_text_out(t, xpos, y, buff + lines[i].start);
+        *end = saved;
+    }
+    HPDF_Page_EndText(t->pdf_page);
+
+    hpdftbl_free(buff);
+    if (lines != stack_lines)
+        hpdftbl_free(lines);
+}
+
+/**
+ * @brief Internal function. Stroke single line cell content that must fit in the cell.
+ *
+ * Internal function. The content is cut or written with a smaller font size according to
+ * the overflow policy if it is wider than the cell. The fit is found from the cached glyph
+ * metrics without measuring the text on the page.
+ *
+ * @param t Table handle
+ * @param cell The cell
+ * @param r Row
+ * @param content Content text
+ * @param font Font name
+ * @param fsize Font size
+ * @param halign Horizontal alignment
+ * @param x Left x-position of cell
+ * @param ypos Baseline of the text
+ * @param left_right_padding Padding on both sides of the text
+ * @param overflow Overflow policy
+ * @see hpdftbl_set_col_overflow()
+ */
+static void
+table_cell_stroke_fitted(hpdftbl_t t, hpdftbl_cell_t *cell, const size_t r, char *content, char *font,
+                         HPDF_REAL fsize, hpdftbl_text_align_t halign, HPDF_REAL x, HPDF_REAL ypos,
+                         HPDF_REAL left_right_padding, hpdftbl_overflow_t overflow) {
+    const HPDF_REAL width = cell->width - 2 * left_right_padding;
+    char *txt = content;
+    char *buff = NULL;
+    HPDF_REAL tw;
+
+    if (overflow == OVERFLOW_SHRINK) {
+        tw = hpdftbl_text_width(t->pdf_doc, font, fsize, content);
+        if (tw > width && width > 0) {
+            HPDF_Page_SetFontAndSize(t->pdf_page, HPDF_GetFont(t->pdf_doc, font, target_encoding),
+                                     fsize * width / tw);
+            tw = width;
+        }
+    } else {
+        const char *ellipsis = overflow == OVERFLOW_ELLIPSIS ? HPDFTBL_ELLIPSIS : "";
+        const size_t len = strlen(content);
+        const size_t k = hpdftbl_text_fit(t->pdf_doc, font, fsize, content, width, ellipsis, &tw);
+        if (k < len) {
+            const size_t ellipsis_len = strlen(ellipsis);
+#ifdef __cplusplus
+            buff = static_cast<char*>(hpdftbl_malloc(k + ellipsis_len + 1));
+#else
+            buff = hpdftbl_malloc(k + ellipsis_len + 1);
+#endif
+            if (buff == NULL) {
+                _HPDFTBL_SET_ERR(t, -5, r, -1);
+                return;
+            }
+            memcpy(buff, content, k);
+            memcpy(buff + k, ellipsis, ellipsis_len + 1);
+            tw += hpdftbl_text_width(t->pdf_doc, font, fsize, ellipsis);
+            txt = buff;
+        }
+    }
+
+    HPDF_REAL xpos = x + left_right_padding;
+    if (halign == RIGHT) {
+        xpos = x + cell->width - tw - left_right_padding;
+    } else if (halign == CENTER) {
+        xpos = x + (cell->width - tw) / 2.0f;
+    }
+
+    if (*txt) {
+        HPDF_Page_BeginText(t->pdf_page);
+        table_text_out(t, xpos, ypos, txt);
+        HPDF_Page_EndText(t->pdf_page);
+    }
+    hpdftbl_free(buff);
+}
+
 /**
  * @brief Internal function.
  *
@@ -1458,11 +2504,14 @@ hpdftbl_get_last_auto_height(HPDF_REAL *height) {
  * @param t Table handle
  * @param r Row
  * @param c Column
- * @see hpdftbl_stroke()
+ * @param content The content of the cell, may be NULL
+ * @param style The style resolved by a style callback or the conditional formatting rules. NULL
+ * if the cell uses its own content style or the table content style.
+ * @see hpdftbl_stroke(), table_draw()
  *
  */
 static void
-table_cell_stroke(hpdftbl_t t, const size_t r, const size_t c) {
+table_cell_stroke(hpdftbl_t t, const size_t r, const size_t c, char *content, const hpdf_text_style_t *style) {
     hpdftbl_cell_t *cell = &t->cells[r * t->cols + c];
 
     if (cell->parent_cell != NULL) {
@@ -1484,12 +2533,8 @@ table_cell_stroke(hpdftbl_t t, const size_t r, const size_t c) {
     // Check if this is the first row, and we should format it as a header row.
     // In case this is a header row we also ignore the label
     if (t->use_header_row && r == 0) {
-        HPDF_Page_SetRGBFill(t->pdf_page, t->header_style.background.r, t->header_style.background.g,
-                             t->header_style.background.b);
-        HPDF_Page_Rectangle(t->pdf_page,
-                            x + cell->delta_x, y + cell->delta_y,
-                            cell->width, cell->height);
-        HPDF_Page_Fill(t->pdf_page);
+        table_fill_rect(t, t->header_style.background, x + cell->delta_x, y + cell->delta_y, cell->width,
+                        cell->height);
     }
 
     if (!(t->use_header_row && r == 0)) {
@@ -1497,64 +2542,34 @@ table_cell_stroke(hpdftbl_t t, const size_t r, const size_t c) {
         // Stroke label if those are used
         if (t->use_cell_labels) {
             set_fontc(t, t->label_style.font, t->label_style.fsize, t->label_style.color);
-            char *label = cell->label;
-
-            if (cell->label_cb) {
-                char *_label = cell->label_cb(t->tag, r, c);
-                if (_label)
-                    label = strdup(_label);
-            } else if (t->label_cb) {
-                char *_label = t->label_cb(t->tag, r, c);
-                if (_label)
-                    label = strdup(_label);
-            }
+            char *label = cell_label(t, cell, r, c);
 
             HPDF_Page_BeginText(t->pdf_page);
-            hpdftbl_encoding_text_out(t->pdf_page,x + cell->delta_x + left_right_padding,
-                                      y + cell->delta_y + cell->height - t->label_style.fsize * 1.05f, label);
+            table_text_out(t, x + cell->delta_x + left_right_padding,
+                           y + cell->delta_y + cell->height - t->label_style.fsize * 1.05f, label);
 
             HPDF_Page_EndText(t->pdf_page);
         }
     }
 
-    // Stroke content
-    char *content = cell->content;
-
-    // If the cell has its own callback this will override the tables global cell callback
-    if (cell->content_cb) {
-        char *_content = cell->content_cb(t->tag, r, c);
-        if (_content)
-            content = _content;
-    } else if (t->content_cb) {
-        char *_content = t->content_cb(t->tag, r, c);
-        if (_content)
-            content = _content;
-    }
-
     hpdftbl_text_align_t halign = t->content_style.halign;
+    char *font;
+    HPDF_REAL fsize;
+    cell_font(t, cell, r, &font, &fsize);
     if (t->use_header_row && r == 0) {
         set_fontc(t, t->header_style.font, t->header_style.fsize, t->header_style.color);
     } else {
         set_fontc(t, t->content_style.font, t->content_style.fsize, t->content_style.color);
-        // Check if cell has its own style which should override global setting but a defined
-        // callback will override both
-#ifdef __cplusplus
-        hpdf_text_style_t cb_val = {	t->content_style.font, t->content_style.fsize,
-                                        t->content_style.color, t->content_style.background,
-                                        t->content_style.halign };
-#else
-        hpdf_text_style_t cb_val = (hpdf_text_style_t) {t->content_style.font, t->content_style.fsize,
-                                                        t->content_style.color, t->content_style.background,
-                                                        t->content_style.halign};
-#endif
-        if (cell->style_cb && cell->style_cb(t->tag, r, c, content, &cb_val)) {
-            set_fontc(t, cb_val.font, cb_val.fsize, cb_val.color);
-            halign = cb_val.halign;
-        } else if (t->content_style_cb && t->content_style_cb(t->tag, r, c, content, &cb_val)) {
-            set_fontc(t, cb_val.font, cb_val.fsize, cb_val.color);
-            halign = cb_val.halign;
-        } else if (cell->content_style.font) {
-            set_fontc(t, cell->content_style.font, cell->content_style.fsize, cell->content_style.color);
+        // A style resolved by a callback or the rules overrides the cell style which in turn
+        // overrides the table style
+        if (style) {
+            set_fontc(t, style->font, style->fsize, style->color);
+            halign = style->halign;
+            font = style->font;
+            fsize = style->fsize;
+        } else if (hpdftbl_cell_style(t, cell)) {
+            const hpdf_text_style_t *cell_style = hpdftbl_cell_style(t, cell);
+            set_fontc(t, cell_style->font, cell_style->fsize, cell_style->color);
         } else {
             set_fontc(t, t->content_style.font, t->content_style.fsize, t->content_style.color);
         }
@@ -1582,9 +2597,19 @@ table_cell_stroke(hpdftbl_t t, const size_t r, const size_t c) {
     }
 
     if (content && *content) {
-        HPDF_Page_BeginText(t->pdf_page);
-        hpdftbl_encoding_text_out(t->pdf_page, xpos, ypos, content);
-        HPDF_Page_EndText(t->pdf_page);
+        if (cell_use_wrap(t, cell, c)) {
+            table_cell_stroke_wrapped(t, cell, r, content, font, fsize,
+                                      t->use_header_row && r == 0 ? t->header_style.halign : halign,
+                                      x + cell->delta_x, ypos, left_right_padding);
+        } else if (t->col_overflow && t->col_overflow[c] != OVERFLOW_NONE) {
+            table_cell_stroke_fitted(t, cell, r, content, font, fsize,
+                                     t->use_header_row && r == 0 ? t->header_style.halign : halign,
+                                     x + cell->delta_x, ypos, left_right_padding, t->col_overflow[c]);
+        } else {
+            HPDF_Page_BeginText(t->pdf_page);
+            table_text_out(t, xpos, ypos, content);
+            HPDF_Page_EndText(t->pdf_page);
+        }
     }
 
 }
@@ -1637,7 +2662,7 @@ hpdftbl_setpos(hpdftbl_t t,
  * read back ccan be done with just two lines of code
  *
  * ```c
- *  hpdftbl_t tbl = calloc(1, sizeof(struct hpdftbl));
+ *  hpdftbl_t tbl = hpdftbl_calloc(1, sizeof(struct hpdftbl));
  *  if( 0 == hpdftbl_load(tbl, filename)  ) {
  *       hpdftbl_stroke_pos(pdf_doc, pdf_page, tbl);
  *  }
@@ -1659,42 +2684,31 @@ hpdftbl_stroke_pos(HPDF_Doc pdf,
 }
 
 /**
- * @brief Stroke the table
+ * @brief Internal function. Calculate the layout of the table.
  *
- * Stroke the table at the specified position and size. The position is by default specified
- * as the upper left corner of the table. Use the hpdftbl_set_origin_top_left(FALSE) to use
- * the bottom left of the table as reference point.
+ * Internal function. Calculate the table height (if not specified), the column widths,
+ * the row heights and the position of all cells. Nothing is written to any page.
  *
- * @param pdf The HPDF document handle
- * @param page The HPDF page handle
  * @param t Table handle
- * @param xpos x position for table
- * @param ypos y position for table
- * @param width width of table
- * @param height height of table. If the height is specified as 0 it will be automatically
- * calculated. The calculated height can be retrieved after the table has been stroked by a
- * call to hpdftbl_get_last_auto_height()
+ * @param pdf The HPDF document handle. Used to look up font metrics.
+ * @param width Width of table. If automatic column widths are used this is the maximum width.
+ * @param height Height of table. If specified as 0 it will be automatically calculated.
+ * @param max_width Maximum width of table if automatic column widths are used and no width is specified
  * @return -1 on error, 0 if successful
- * @see hpdftbl_get_last_auto_height()
- * @see hpdftbl_stroke_from_data()
+ * @see hpdftbl_stroke(), hpdftbl_layout()
  */
-int
-hpdftbl_stroke(HPDF_Doc pdf,
-               const HPDF_Page page, hpdftbl_t t,
-               const HPDF_REAL xpos, const HPDF_REAL ypos,
-               const HPDF_REAL width, HPDF_REAL height) {
+static int
+table_layout(hpdftbl_t t, HPDF_Doc pdf, HPDF_REAL width, HPDF_REAL height, HPDF_REAL max_width) {
+    hpdftbl_resolve_theme(t);
+    memset(&t->stats, 0, sizeof(t->stats));
 
-    if (NULL == pdf || NULL == page || NULL == t) {
-        _HPDFTBL_SET_ERR(t, -6, -1, -1);
+    // All content and label callbacks are called once up front
+    if (-1 == table_resolve_text(t)) {
         return -1;
     }
 
-    // Local positions to enable position adjustment
-    HPDF_REAL y = ypos;
-    HPDF_REAL x = xpos;
-
-    last_auto_height = 0;
-    if (height <= 0) {
+    const _Bool auto_height = height <= 0;
+    if (auto_height) {
         // Calculate height automagically based on number of rows and font sizes
         height = t->content_style.fsize;
         if (t->use_cell_labels) {
@@ -1705,152 +2719,195 @@ hpdftbl_stroke(HPDF_Doc pdf,
             height = max(t->minrowheight, height);
             height *= 1.6f * (float)t->rows;
         }
-        last_auto_height = height;
     }
 
+    t->pdf_doc = pdf;
+
+    if (t->use_auto_colwidth) {
+        if (-1 == calc_auto_colwidth(t, width > 0 ? width : max_width)) {
+            return -1;
+        }
+        width = t->width;
+    }
+
+    t->height = height;
+    t->width = width;
+
+    // Wrapped content might increase the automatically calculated height
+    _HPDFTBL_STAT_BEGIN(STAT_LAYOUT);
+    const int ret = calc_cell_pos(t, auto_height);
+    _HPDFTBL_STAT_END(STAT_LAYOUT, 0);
+    return ret;
+}
+
+/**
+ * @brief Internal function. Get the height of the table title.
+ *
+ * @param t Table handle
+ * @return The height of the title, 0 if the table has no title
+ */
+static HPDF_REAL
+table_title_height(hpdftbl_t t) {
+    return t->title_txt ? 1.5f * t->title_style.fsize : 0;
+}
+
+/**
+ * @brief Internal function. Stroke a table whose layout has already been calculated.
+ *
+ * @param t Table handle
+ * @param page The HPDF page handle
+ * @param xpos x position for table
+ * @param ypos y position for table
+ * @return -1 on error, 0 if successful
+ * @see table_layout()
+ */
+static int
+table_draw(hpdftbl_t t, const HPDF_Page page, const HPDF_REAL xpos, const HPDF_REAL ypos) {
+    _HPDFTBL_STAT_BEGIN(STAT_DRAW);
+
+    // Local positions to enable position adjustment
+    HPDF_REAL y = ypos;
+    HPDF_REAL x = xpos;
+
     t->posx = x;
     t->posy = y;
+    t->pdf_page = page;
 
     //const HPDF_REAL page_height = HPDF_Page_GetHeight(page);
     if (t->anchor_is_top_left) {
-        y = ypos - height;
+        y = ypos - t->height;
         if (t->title_txt) {
             y -= 1.5f * t->title_style.fsize;
         }
     }
 
-    t->pdf_doc = pdf;
-    t->pdf_page = page;
-    t->height = height;
-    t->width = width;
+    // Stroke table background
+    table_fill_rect(t, t->content_style.background, x, y, t->width, t->height);
+
+    // Errors collected while stroking makes the stroke fail but it is still completed
+    const size_t num_errors = t->num_errors;
 
-    if (-1 == calc_cell_pos(t)) {
+    // The ranking rules depend on all cells so their limits are calculated once up front
+    double *rule_limits;
+    if (-1 == hpdftbl_rules_prepare(t, &rule_limits)) {
+        _HPDFTBL_STAT_END(STAT_DRAW, 0);
         return -1;
     }
 
-    // Stroke table background
-    HPDF_Page_SetRGBFill(page, t->content_style.background.r, t->content_style.background.g,
-                         t->content_style.background.b);
-    HPDF_Page_Rectangle(page, x, y, width, height);
-    HPDF_Page_Fill(page);
-
     for (size_t r = 0; r < t->rows; r++) {
         for (size_t c = 0; c < t->cols; c++) {
             hpdftbl_cell_t *cell = &t->cells[_HPDFTBL_IDX(r, c)];
 
             // Only cells which are not covered by a parent spanning cell will be stroked
-            if (cell->parent_cell == NULL) {
-#ifdef __cplusplus
-                hpdf_text_style_t style = {	t->content_style.font, t->content_style.fsize,
-                                                t->content_style.color, t->content_style.background, t->content_style.halign};
-#else
-                hpdf_text_style_t style = (hpdf_text_style_t) {t->content_style.font, t->content_style.fsize,
-                                                               t->content_style.color, t->content_style.background,
-                                                               t->content_style.halign};
-#endif
-                if (cell->style_cb) {
-                    if (cell->style_cb(t->tag, r, c, NULL, &style)) {
-                        HPDF_Page_SetRGBFill(page, style.background.r, style.background.g, style.background.b);
-                        HPDF_Page_Rectangle(page, x + cell->delta_x, y + cell->delta_y, cell->width, cell->height);
-                        HPDF_Page_Fill(page);
+            if (cell->parent_cell != NULL) {
+                t->stats.spanned_cells++;
+            } else {
+                t->stats.cells++;
+                // The content callback was called when the table was laid out
+                char *content = hpdftbl_cell_content(t, cell, r, c);
+
+                // The style of the cell is resolved once, with the content known, and then used for
+                // both the background and the text. A cell style callback overrides the table style
+                // callback which in turn overrides the conditional formatting rules. The header row
+                // always uses the header style.
+                hpdf_text_style_t style = t->content_style;
+                _Bool use_style = FALSE;
+                unsigned rule_applied = 0;
+                if (!(t->use_header_row && 0 == r)) {
+                    hpdftbl_content_style_callback_t style_cb = cell->style_cb ? cell->style_cb : t->content_style_cb;
+                    const hpdf_text_style_t *cell_style = hpdftbl_cell_style(t, cell);
+                    if (style_cb) {
+                        _HPDFTBL_STAT_BEGIN(STAT_STYLE_CB);
+                        t->stats.style_cb_calls++;
+                        use_style = style_cb(t->tag, r, c, content, &style);
+                        _HPDFTBL_STAT_END(STAT_STYLE_CB, 0);
+                    }
+                    if (use_style) {
+                        table_fill_rect(t, style.background, x + cell->delta_x, y + cell->delta_y, cell->width,
+                                        cell->height);
+                    } else {
+                        if (t->num_rules > 0) {
+                            style = cell_style ? *cell_style : t->content_style;
+                            style.halign = t->content_style.halign;
+                            rule_applied = hpdftbl_rules_apply(t, rule_limits, r, c, content, &style);
+                            use_style = rule_applied != 0;
+                        }
+                        // If cell has its own style set this will override, and we have to stroke the background here
+                        if (cell_style) {
+                            table_fill_rect(t, cell_style->background, x + cell->delta_x, y + cell->delta_y,
+                                            cell->width, cell->height);
+                        }
                     }
-                } else if (t->content_style_cb && t->content_style_cb(t->tag, r, c, NULL, &style)) {
-                    HPDF_Page_SetRGBFill(page, style.background.r, style.background.g, style.background.b);
-                    HPDF_Page_Rectangle(page, x + cell->delta_x, y + cell->delta_y, cell->width, cell->height);
-                    HPDF_Page_Fill(page);
-                } else if (cell->content_style.font) {
-                    // If cell has its own style set this will override, and we have to stroke the background here
-                    HPDF_Page_SetRGBFill(page, cell->content_style.background.r, cell->content_style.background.g,
-                                         cell->content_style.background.b);
-                    HPDF_Page_Rectangle(page, x + cell->delta_x, y + cell->delta_y, cell->width, cell->height);
-                    HPDF_Page_Fill(page);
                 }
 
                 // If we are to use zebra coloring of rows
                 if( t->use_zebra ) {
-                    if ( r % 2 == 0 ) {
-                        if ( 0 == t->zebra_phase )
-                            HPDF_Page_SetRGBFill(page, t->zebra_color1.r, t->zebra_color1.g, t->zebra_color1.b);
-                        else
-                            HPDF_Page_SetRGBFill(page, t->zebra_color2.r, t->zebra_color2.g, t->zebra_color2.b);
-                    } else {
-                        if ( 0 == t->zebra_phase )
-                            HPDF_Page_SetRGBFill(page, t->zebra_color2.r, t->zebra_color2.g, t->zebra_color2.b);
-                        else
-                            HPDF_Page_SetRGBFill(page, t->zebra_color1.r, t->zebra_color1.g, t->zebra_color1.b);
-                    }
-                    HPDF_Page_Rectangle(page, x + cell->delta_x, y + cell->delta_y, cell->width, cell->height);
-                    HPDF_Page_Fill(page);
+                    const _Bool first_color = (r % 2 == 0) == (0 == t->zebra_phase);
+                    table_fill_rect(t, first_color ? t->zebra_color1 : t->zebra_color2,
+                                    x + cell->delta_x, y + cell->delta_y, cell->width, cell->height);
                 }
 
-                if (cell->canvas_cb) {
-                    cell->canvas_cb(pdf, page, t->tag, r, c, x + cell->delta_x, y + cell->delta_y, cell->width,
+                // The background of a matching rule is drawn on top of the zebra rows
+                if (rule_applied & RULE_SET_BACKGROUND) {
+                    table_fill_rect(t, style.background, x + cell->delta_x, y + cell->delta_y, cell->width,
                                     cell->height);
-                } else if (t->canvas_cb) {
-                    t->canvas_cb(pdf, page, t->tag, r, c, x + cell->delta_x, y + cell->delta_y, cell->width,
-                                 cell->height);
                 }
 
-                table_cell_stroke(t, r, c);
+                hpdftbl_canvas_callback_t canvas_cb = cell->canvas_cb ? cell->canvas_cb : t->canvas_cb;
+                if (canvas_cb) {
+                    _HPDFTBL_STAT_BEGIN(STAT_CANVAS_CB);
+                    t->stats.canvas_cb_calls++;
+                    canvas_cb(t->pdf_doc, page, t->tag, r, c, x + cell->delta_x, y + cell->delta_y, cell->width,
+                              cell->height);
+                    _HPDFTBL_STAT_END(STAT_CANVAS_CB, 0);
+                }
+
+                table_cell_stroke(t, r, c, content, use_style ? &style : NULL);
+
+                // When errors are collected an HPDF error in one cell is recorded for the cell and
+                // the rest of the table is still stroked
+                if (t->collect_errors) {
+                    const HPDF_STATUS status = HPDF_GetError(t->pdf_doc);
+                    if (status != HPDF_OK) {
+                        _HPDFTBL_SET_ERR(t, (int) status, (int) r, (int) c);
+                        HPDF_ResetError(t->pdf_doc);
+                    }
+                }
 
                 // Vertical grid. This is either a full cell height grid or a shorter depending
                 // on if cell labels are used and the user setting for `use_label_grid_style`.
                 // In case a header row should be used we don't use the shorter grids in the header.
                 if (t->use_label_grid_style && t->use_cell_labels && !(t->use_header_row && 0==r)) {
-                    HPDF_Page_SetRGBStroke(page, t->inner_vgrid.color.r, t->inner_vgrid.color.g,
-                                           t->inner_vgrid.color.b);
-
-                    HPDF_Page_SetLineWidth(page, t->inner_vgrid.width);
-                    hpdftbl_set_line_dash(t, t->inner_vgrid.line_dashstyle);
-
                     // If this cell spans multiple rows we draw the left line full and not just the short
                     // label lead since the visual appearance will just be bad otherwise
-                    if (cell->rowspan > 1) {
-                        HPDF_Page_MoveTo(page, x + cell->delta_x, y + cell->delta_y);
-                    } else {
-                        HPDF_Page_MoveTo(page, x + cell->delta_x,y + cell->delta_y + cell->height - t->label_style.fsize * 1.2f);
-                    }
-                    HPDF_Page_LineTo(page, x + cell->delta_x, y + cell->delta_y + cell->height);
-                    HPDF_Page_Stroke(page);
+                    const HPDF_REAL y1 = cell->rowspan > 1 ? y + cell->delta_y :
+                                         y + cell->delta_y + cell->height - t->label_style.fsize * 1.2f;
+                    table_grid_line(t, &t->inner_vgrid, x + cell->delta_x, y1,
+                                    x + cell->delta_x, y + cell->delta_y + cell->height);
                 } else {
-                    HPDF_Page_SetRGBStroke(page, t->inner_vgrid.color.r, t->inner_vgrid.color.g,
-                                           t->inner_vgrid.color.b);
-                    HPDF_Page_SetLineWidth(page, t->inner_vgrid.width);
-                    hpdftbl_set_line_dash(t, t->inner_vgrid.line_dashstyle);
-                    HPDF_Page_MoveTo(page, x + cell->delta_x, y + cell->delta_y);
-                    HPDF_Page_LineTo(page, x + cell->delta_x, y + cell->delta_y + cell->height);
-                    HPDF_Page_Stroke(page);
+                    table_grid_line(t, &t->inner_vgrid, x + cell->delta_x, y + cell->delta_y,
+                                    x + cell->delta_x, y + cell->delta_y + cell->height);
                 }
 
-                // Horizontal grid
-                if (r > 0 || 0 == t->inner_tgrid.width) {
-                    // Not special top inner gridline
-                    HPDF_Page_SetRGBStroke(page, t->inner_hgrid.color.r, t->inner_hgrid.color.g,t->inner_hgrid.color.b);
-                    HPDF_Page_SetLineWidth(page, t->inner_hgrid.width);
-                    hpdftbl_set_line_dash(t, t->inner_hgrid.line_dashstyle);
-                    HPDF_Page_MoveTo(page, x + cell->delta_x, y + cell->delta_y);
-                    HPDF_Page_LineTo(page, x + cell->delta_x + cell->width, y + cell->delta_y);
-                    HPDF_Page_Stroke(page);
-                } else {
-                    // Draw the top-inner horizontal grid line
-                    HPDF_Page_SetRGBStroke(page, t->inner_tgrid.color.r, t->inner_tgrid.color.g,
-                                           t->inner_tgrid.color.b);
-                    HPDF_Page_SetLineWidth(page, t->inner_tgrid.width);
-                    hpdftbl_set_line_dash(t, t->inner_tgrid.line_dashstyle);
-                    HPDF_Page_MoveTo(page, x + cell->delta_x, y + cell->delta_y);
-                    HPDF_Page_LineTo(page, x + cell->delta_x + cell->width, y + cell->delta_y);
-                    HPDF_Page_Stroke(page);
-                }
+                // Horizontal grid. The top-inner horizontal grid line has its own style.
+                table_grid_line(t, r > 0 || 0 == t->inner_tgrid.width ? &t->inner_hgrid : &t->inner_tgrid,
+                                x + cell->delta_x, y + cell->delta_y,
+                                x + cell->delta_x + cell->width, y + cell->delta_y);
             }
         }
     }
+    hpdftbl_free(rule_limits);
 
     // Stoke outer border
+    _HPDFTBL_STAT_BEGIN(STAT_GRID);
+    t->stats.color_changes++;
+    t->stats.path_ops++;
     HPDF_Page_SetRGBStroke(page, t->outer_grid.color.r, t->outer_grid.color.g, t->outer_grid.color.b);
     HPDF_Page_SetLineWidth(page, t->outer_grid.width);
     hpdftbl_set_line_dash(t, t->outer_grid.line_dashstyle);
-    HPDF_Page_Rectangle(page, x, y, width, height);
+    HPDF_Page_Rectangle(page, x, y, t->width, t->height);
     HPDF_Page_Stroke(page);
+    _HPDFTBL_STAT_END(STAT_GRID, 5);
 
     // If header row is enabled we add a thicker (same as outer border) line under the top row
     if (t->use_header_row) {
@@ -1861,11 +2918,172 @@ hpdftbl_stroke(HPDF_Doc pdf,
     }
 
     // Stroke title
-    const HPDF_REAL title_height = table_title_stroke(t);
-    if (last_auto_height > 0) {
-        last_auto_height += title_height;
+    table_title_stroke(t);
+
+    if (t->collect_errors) {
+        const HPDF_STATUS status = HPDF_GetError(t->pdf_doc);
+        if (status != HPDF_OK) {
+            _HPDFTBL_SET_ERR(t, (int) status, -1, -1);
+            HPDF_ResetError(t->pdf_doc);
+        }
+    }
+
+    _HPDFTBL_STAT_END(STAT_DRAW, 0);
+    return t->num_errors > num_errors ? -1 : 0;
+}
+
+/**
+ * @brief Stroke the table
+ *
+ * Stroke the table at the specified position and size. The position is by default specified
+ * as the upper left corner of the table. Use the hpdftbl_set_origin_top_left(FALSE) to use
+ * the bottom left of the table as reference point.
+ *
+ * @param pdf The HPDF document handle
+ * @param page The HPDF page handle
+ * @param t Table handle
+ * @param xpos x position for table
+ * @param ypos y position for table
+ * @param width width of table
+ * @param height height of table. If the height is specified as 0 it will be automatically
+ * calculated. The calculated height can be retrieved after the table has been stroked by a
+ * call to hpdftbl_get_last_auto_height()
+ * @return -1 on error, 0 if successful
+ * @see hpdftbl_get_last_auto_height()
+ * @see hpdftbl_stroke_from_data()
+ */
+int
+hpdftbl_stroke(HPDF_Doc pdf,
+               const HPDF_Page page, hpdftbl_t t,
+               const HPDF_REAL xpos, const HPDF_REAL ypos,
+               HPDF_REAL width, HPDF_REAL height) {
+
+    if (NULL == pdf || NULL == page || NULL == t) {
+        _HPDFTBL_SET_ERR(t, -6, -1, -1);
+        return -1;
+    }
+
+    last_auto_height = 0;
+    t->pdf_page = page;
+
+    // If no width is specified a table with automatic column widths may extend to the page
+    // width less the same margin on the right side as on the left side.
+    if (-1 == table_layout(t, pdf, width, height, HPDF_Page_GetWidth(page) - 2 * xpos)) {
+        return -1;
+    }
+    if (height <= 0) {
+        last_auto_height = t->height + table_title_height(t);
+    }
+
+    return table_draw(t, page, xpos, ypos);
+}
+
+/**
+ * @brief Calculate the layout of a table without stroking it.
+ *
+ * Run the same layout calculations as hpdftbl_stroke() (table height, column widths, row
+ * heights and cell positions) but without writing anything to a page. This makes it possible
+ * to know the size of a table before it is placed on a page, for example to decide if it fits
+ * on the current page.
+ *
+ * The returned row offsets are owned by the table and are valid until the table is
+ * stroked, laid out again or destroyed. The position and size of each cell is available with
+ * hpdftbl_get_cell_rect().
+ *
+ * @code
+ * hpdftbl_layout_t layout;
+ * if (0 == hpdftbl_layout(pdf_doc, tbl, width, 0, &layout)) {
+ *     if (ypos - layout.total_height < bottom_margin) {
+ *         // Start a new page
+ *     }
+ * }
+ * @endcode
+ *
+ * @param pdf The HPDF document handle. Used to look up font metrics.
+ * @param t Table handle
+ * @param width Width of table. If automatic column widths are used this is the maximum width and
+ * if it is 0 the width is not limited.
+ * @param height Height of table. If specified as 0 it will be automatically calculated.
+ * @param layout Returned layout
+ * @return -1 on error, 0 if successful
+ * @see hpdftbl_stroke(), hpdftbl_get_cell_rect()
+ */
+int
+hpdftbl_layout(HPDF_Doc pdf, hpdftbl_t t, HPDF_REAL width, HPDF_REAL height, hpdftbl_layout_t *layout) {
+    if (NULL == pdf || NULL == t || NULL == layout) {
+        _HPDFTBL_SET_ERR(t, -6, -1, -1);
+        return -1;
+    }
+
+    if (-1 == table_layout(t, pdf, width, height, 0)) {
+        return -1;
     }
 
+    layout->width = t->width;
+    layout->height = t->height;
+    layout->title_height = table_title_height(t);
+    layout->total_height = t->height + layout->title_height;
+    layout->rows = t->rows;
+    layout->row_offset = t->row_offset;
+    return 0;
+}
+
+/**
+ * @brief Stroke a table using the layout from the last call to hpdftbl_layout().
+ *
+ * The layout is not calculated again which makes this the cheapest way to stroke a
+ * table whose layout has already been calculated, e.g. to know its height. The table is
+ * stroked with the styles it was laid out with even if its shared theme has been replaced
+ * after the layout.
+ *
+ * @param pdf The HPDF document handle. Must be the same as used for the layout.
+ * @param page The HPDF page handle
+ * @param t Table handle
+ * @param xpos x position for table
+ * @param ypos y position for table
+ * @return -1 on error, 0 if successful
+ * @see hpdftbl_layout(), hpdftbl_stroke()
+ */
+int
+hpdftbl_stroke_layout(HPDF_Doc pdf, HPDF_Page page, hpdftbl_t t, HPDF_REAL xpos, HPDF_REAL ypos) {
+    if (NULL == pdf || NULL == page || NULL == t) {
+        _HPDFTBL_SET_ERR(t, -6, -1, -1);
+        return -1;
+    }
+    if (t->row_offset == NULL || t->pdf_doc != pdf) {
+        _HPDFTBL_SET_ERR(t, -16, -1, -1);
+        return -1;
+    }
+    // The styles were resolved by the layout and are kept for the whole table
+    return table_draw(t, page, xpos, ypos);
+}
+
+/**
+ * @brief Get the position and size of a cell as calculated by the last layout.
+ *
+ * The position is relative to the bottom left corner of the table (not including the
+ * title). For a cell that spans several rows or columns the rectangle covers all of them.
+ *
+ * @param t Table handle
+ * @param r Row
+ * @param c Column
+ * @param rect Returned cell rectangle
+ * @return -1 on error, 0 if successful
+ * @see hpdftbl_layout()
+ */
+int
+hpdftbl_get_cell_rect(hpdftbl_t t, size_t r, size_t c, hpdftbl_rect_t *rect) {
+    _HPDFTBL_CHK_TABLE(t);
+    if (!chktbl(t, r, c)) return -1;
+    if (t->row_offset == NULL || rect == NULL) {
+        _HPDFTBL_SET_ERR(t, -16, r, c);
+        return -1;
+    }
+    const hpdftbl_cell_t *cell = &t->cells[_HPDFTBL_IDX(r, c)];
+    rect->x = cell->delta_x;
+    rect->y = cell->delta_y;
+    rect->width = cell->width;
+    rect->height = cell->height;
     return 0;
 }
 
@@ -2000,6 +3218,74 @@ hpdftbl_stroke_pdfdoc(HPDF_Doc pdf_doc, char *file) {
  * @see hpdftbl_load(), hpdftbl_theme_load()
  * @image html screenshots/tut_ex41.png
  *
+ * @example tut_ex42.c
+ * Example of serializing a table to a compact binary image and reading it back.
+ * @see hpdftbl_dumpb(), hpdftbl_loadb()
+ *
+ * @example tut_ex43.c
+ * Example of using a memory mapped binary image as a template for several tables.
+ * @see hpdftbl_dump_image(), hpdftbl_open_image()
+ *
+ * @example tut_ex44.c
+ * Example of serializing a table to compact JSON and reading it back.
+ * @see hpdftbl_dumps_compact(), hpdftbl_loads()
+ *
+ * @example tut_ex45.c
+ * Example of column widths calculated from the content of the table.
+ * @see hpdftbl_set_auto_colwidth(), hpdftbl_set_colwidth_min()
+ *
+ * @example tut_ex46.c
+ * Example of word wrapping the content in a column.
+ * @see hpdftbl_set_col_wrap_mode(), hpdftbl_set_wrap_mode()
+ *
+ * @example tut_ex47.c
+ * Example of row heights calculated from the content of the table.
+ * @see hpdftbl_set_auto_rowheight()
+ *
+ * @example tut_ex48.c
+ * Example of cutting or shrinking content that is wider than its cell.
+ * @see hpdftbl_set_col_overflow()
+ *
+ * @example tut_ex49.c
+ * Example of calculating the size of tables before they are stroked to stack them on a page.
+ * @see hpdftbl_layout(), hpdftbl_stroke_layout()
+ *
+ * @example tut_ex50.c
+ * Example of placing many tables after each other over several pages with a flow.
+ * @see hpdftbl_flow_create(), hpdftbl_flow_add(), hpdftbl_flow_stroke()
+ *
+ * @example tut_ex51.c
+ * Example of a table with many widgets where each distinct widget appearance is only written once.
+ * @see hpdftbl_use_widget_cache()
+ *
+ * @example tut_ex52.c
+ * Example of a table which is rendered once and then placed on several pages.
+ * @see hpdftbl_stamp_create(), hpdftbl_stamp_place()
+ *
+ * @example tut_ex53.c
+ * Example of charts of long series of values in table cells.
+ * @see hpdftbl_widget_sparkline(), hpdftbl_widget_minibar(), hpdftbl_widget_minmax_band()
+ *
+ * @example tut_ex54.c
+ * Example of several tables that use the same shared theme.
+ * @see hpdftbl_shared_theme_create(), hpdftbl_use_shared_theme()
+ *
+ * @example tut_ex55.c
+ * Example of conditional formatting with rules in a theme.
+ * @see hpdftbl_rule_t, hpdftbl_set_rules()
+ *
+ * @example tut_ex56.c
+ * Example of reading the instrumentation counters after a table has been stroked.
+ * @see hpdftbl_get_stat(), hpdftbl_stats_dumps()
+ *
+ * @example tut_ex57.c
+ * Example of logging the render statistics of a table.
+ * @see hpdftbl_get_render_stats(), hpdftbl_render_stats_dumps()
+ *
+ * @example tut_ex58.c
+ * Example of custom memory allocation functions and memory accounting for a table.
+ * @see hpdftbl_set_alloc_funcs(), hpdftbl_get_memory_usage()
+ *
  * @example tests/tut_ex40.json
  * An output example from hpdftbl_dump() that shows a
  * serialized table. This can later be import to a table structure
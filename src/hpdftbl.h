@@ -65,23 +65,43 @@ extern "C" {
 #define min(a,b) (((a)<(b)) ? (a):(b))
 #endif
 
+/**
+ * @brief Storage class of the error state
+ *
+ * The error state is kept per thread so that tables can be created and stroked
+ * in several threads at the same time. An error is always recorded in the thread
+ * where it happened and is never overwritten by an error in another thread.
+ */
+#if defined(__cplusplus)
+#define HPDFTBL_THREAD_LOCAL thread_local
+#elif defined(_MSC_VER)
+#define HPDFTBL_THREAD_LOCAL __declspec(thread)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define HPDFTBL_THREAD_LOCAL _Thread_local
+#else
+#define HPDFTBL_THREAD_LOCAL __thread
+#endif
+
+/** Size of the buffer for extra error information */
+#define HPDFTBL_ERR_EXTRAINFO_SIZE 1024
+
 /** Internal variable to record last error */
-extern int hpdftbl_err_code ;
+extern HPDFTBL_THREAD_LOCAL int hpdftbl_err_code ;
 
 /** Internal variable to record last error */
-extern int hpdftbl_err_row ;
+extern HPDFTBL_THREAD_LOCAL int hpdftbl_err_row ;
 
 /** Internal variable to record last error */
-extern int hpdftbl_err_col ;
+extern HPDFTBL_THREAD_LOCAL int hpdftbl_err_col ;
 
 /** Internal variable to record last error */
-extern int hpdftbl_err_lineno;
+extern HPDFTBL_THREAD_LOCAL int hpdftbl_err_lineno;
 
 /** Internal variable to record last error */
-extern char *hpdftbl_err_file;
+extern HPDFTBL_THREAD_LOCAL char *hpdftbl_err_file;
 
 /** Internal variable to record last error */
-extern char hpdftbl_err_extrainfo[];
+extern HPDFTBL_THREAD_LOCAL char hpdftbl_err_extrainfo[];
 
 /** Data structure version for serialization of themes */
 #define THEME_JSON_VERSION 1
@@ -89,6 +109,9 @@ extern char hpdftbl_err_extrainfo[];
 /** Data structure version for serialization of tables */
 #define TABLE_JSON_VERSION 1
 
+/** Data structure version for binary serialization of tables */
+#define TABLE_BIN_VERSION 1
+
 
 /** Font family */
 #define HPDF_FF_TIMES "Times-Roman"
@@ -247,6 +270,36 @@ extern char hpdftbl_err_extrainfo[];
  */
 #define HPDFTBL_MIN_CALCULATED_PERCENT_CELL_WIDTH 2.0
 
+/**
+ * @brief Number of fonts whose glyph widths are cached for text measurement
+ * @see hpdftbl_text_width()
+ */
+#define HPDFTBL_GLYPH_CACHE_SIZE 16
+
+/**
+ * @brief Maximum number of distinct widget appearances kept in the widget cache
+ * @see hpdftbl_use_widget_cache()
+ */
+#define HPDFTBL_WIDGET_CACHE_MAX 1024
+
+/**
+ * @brief Smallest width in points of a bar in the mini bar chart widget
+ * @see hpdftbl_widget_minibar()
+ */
+#define HPDFTBL_MINIBAR_MIN_WIDTH 2.0f
+
+/**
+ * @brief Distance between the baselines of wrapped text lines as a factor of the font size
+ * @see hpdftbl_set_wrap_mode()
+ */
+#define HPDFTBL_WRAP_LINE_SPACING 1.2f
+
+/**
+ * @brief String written after text that has been cut to fit its cell
+ * @see hpdftbl_set_col_overflow()
+ */
+#define HPDFTBL_ELLIPSIS "..."
+
 /**
  * @brief Convert cm to dots using the default resolution (72 DPI)
  *
@@ -262,7 +315,7 @@ extern char hpdftbl_err_extrainfo[];
  * @param r Row where error occured
  * @param c Column where error occured
  */
-#define _HPDFTBL_SET_ERR(t, err, r, c) do {hpdftbl_err_code=err;hpdftbl_err_row=r;hpdftbl_err_col=c;hpdftbl_err_lineno=__LINE__;hpdftbl_err_file=__FILE__; if(hpdftbl_err_handler){hpdftbl_err_handler(t,r,c,err);}} while(0)
+#define _HPDFTBL_SET_ERR(t, err, r, c) do {hpdftbl_err_code=err;hpdftbl_err_row=r;hpdftbl_err_col=c;hpdftbl_err_lineno=__LINE__;hpdftbl_err_file=__FILE__; if(!hpdftbl_collect_error(t,err,r,c,__LINE__,__FILE__) && hpdftbl_err_handler){hpdftbl_err_handler(t,r,c,err);}} while(0)
 
 /**
  * @brief Set optional extra info at error state. (Currently only used by the late binding setting
@@ -270,7 +323,7 @@ extern char hpdftbl_err_extrainfo[];
  * @param info Extra info that can be set by a function at a state of error
  * @see hpdftbl_set_label_dyncb(),hpdftbl_set_content_dyncb()
  */
-#define _HPDFTBL_SET_ERR_EXTRA(info) do {strncpy(hpdftbl_err_extrainfo,info,1023);hpdftbl_err_extrainfo[1023]=0;} while(0)
+#define _HPDFTBL_SET_ERR_EXTRA(info) do {strncpy(hpdftbl_err_extrainfo,info,HPDFTBL_ERR_EXTRAINFO_SIZE-1);hpdftbl_err_extrainfo[HPDFTBL_ERR_EXTRAINFO_SIZE-1]=0;} while(0)
 
 /**
  * @brief NPE check before using a table handler
@@ -282,6 +335,29 @@ extern char hpdftbl_err_extrainfo[];
  */
 #define _HPDFTBL_IDX(r, c) (r*t->cols+c)
 
+#ifdef HPDFTBL_ENABLE_STATS
+/**
+ * @brief Start measuring an instrumented operation.
+ *
+ * Only one measurement of the same counter can be started in the same scope.
+ * Expands to nothing unless the library is built with `--enable-stats`.
+ * @param id Counter, one of hpdftbl_stat_id_t
+ * @see _HPDFTBL_STAT_END()
+ */
+#define _HPDFTBL_STAT_BEGIN(id) const double _hpdftbl_stat_start_##id = hpdftbl_stat_clock()
+
+/**
+ * @brief Stop measuring an instrumented operation and add it to its counter.
+ * @param id Counter, one of hpdftbl_stat_id_t
+ * @param nops Number of PDF operators written by the operation
+ * @see _HPDFTBL_STAT_BEGIN()
+ */
+#define _HPDFTBL_STAT_END(id, nops) hpdftbl_stat_add(id, nops, _hpdftbl_stat_start_##id)
+#else
+#define _HPDFTBL_STAT_BEGIN(id) do {} while(0)
+#define _HPDFTBL_STAT_END(id, nops) do {} while(0)
+#endif
+
 /**
  * @brief Enumeration for horizontal text alignment
  *
@@ -295,6 +371,42 @@ typedef enum hpdftbl_text_align {
     RIGHT = 2       /**< Right test alignment */
 } hpdftbl_text_align_t;
 
+/**
+ * @brief Enumeration for how text that is wider than the cell is handled
+ *
+ * @see hpdftbl_set_wrap_mode()
+ * @see hpdftbl_set_col_wrap_mode()
+ * @see hpdftbl_set_cell_wrap_mode()
+ */
+typedef enum hpdftbl_wrap_mode {
+    WRAP_INHERIT = 0,   /**< Use the column setting for a cell and the table setting for a column */
+    WRAP_NONE = 1,      /**< Text is written on one line (unless it contains newlines) */
+    WRAP_WORD = 2       /**< Text is broken into several lines at word boundaries to fit the cell width */
+} hpdftbl_wrap_mode_t;
+
+/**
+ * @brief Enumeration for how single line text that is wider than its cell is handled
+ *
+ * @see hpdftbl_set_col_overflow()
+ */
+typedef enum hpdftbl_overflow {
+    OVERFLOW_NONE = 0,      /**< Text is written in full and may overflow into the neighbouring cell */
+    OVERFLOW_CLIP = 1,      /**< Text is cut after the last character that fits */
+    OVERFLOW_ELLIPSIS = 2,  /**< Text is cut so that it fits together with a trailing "..." */
+    OVERFLOW_SHRINK = 3     /**< The font size is reduced so that the text fits */
+} hpdftbl_overflow_t;
+
+/**
+ * @brief A line of text as determined by the line breaker
+ *
+ * @see hpdftbl_wrap_text()
+ */
+typedef struct hpdftbl_text_line {
+    size_t start;       /**< Offset of first character of the line in the text */
+    size_t len;         /**< Number of characters in the line */
+    HPDF_REAL width;    /**< Width of the line in points */
+} hpdftbl_text_line_t;
+
 /**
  * @brief Specification of a text style
  *
@@ -308,6 +420,64 @@ typedef struct text_style {
     hpdftbl_text_align_t halign;    /**< Text horizontal alignment */
 } hpdf_text_style_t;
 
+/**
+ * @brief Predicates for conditional formatting rules
+ *
+ * The numeric predicates only match cells whose content can be parsed as a number.
+ * @see hpdftbl_rule_t
+ */
+typedef enum hpdftbl_rule_op {
+    RULE_LT = 0,            /**< Number less than `value` */
+    RULE_LE = 1,            /**< Number less than or equal to `value` */
+    RULE_GT = 2,            /**< Number greater than `value` */
+    RULE_GE = 3,            /**< Number greater than or equal to `value` */
+    RULE_EQ = 4,            /**< Number equal to `value` */
+    RULE_NE = 5,            /**< Number not equal to `value` */
+    RULE_BETWEEN = 6,       /**< Number in the closed range [`value`, `value2`] */
+    RULE_STR_EQ = 7,        /**< Content equal to `str` */
+    RULE_STR_CONTAINS = 8,  /**< Content contains `str` */
+    RULE_STR_PREFIX = 9,    /**< Content starts with `str` */
+    RULE_TOP_N = 10,        /**< Number among the `value` largest numbers in scope */
+    RULE_BOTTOM_N = 11      /**< Number among the `value` smallest numbers in scope */
+} hpdftbl_rule_op_t;
+
+/**
+ * @brief The parts of the style that are set by a matching rule
+ * @see hpdftbl_rule_t
+ */
+typedef enum hpdftbl_rule_apply {
+    RULE_SET_FONT = 0x01,       /**< Font and font size */
+    RULE_SET_COLOR = 0x02,      /**< Text color */
+    RULE_SET_BACKGROUND = 0x04, /**< Cell background */
+    RULE_SET_HALIGN = 0x08      /**< Horizontal alignment */
+} hpdftbl_rule_apply_t;
+
+/**
+ * @brief A conditional formatting rule
+ *
+ * A rule sets (parts of) the content style of every cell in its scope that
+ * matches the predicate. All matching rules are applied in order so a later rule
+ * overrides an earlier one.
+ *
+ * *Example:* Negative numbers in the third column in red
+ * @code
+ * static hpdftbl_rule_t rules[] = {
+ *     {2, RULE_LT, 0, 0, NULL, RULE_SET_COLOR, {NULL, 0, {0.8f, 0, 0}, {1, 1, 1}, LEFT}}
+ * };
+ * hpdftbl_set_rules(tbl, rules, 1);
+ * @endcode
+ * @see hpdftbl_set_rules()
+ */
+typedef struct hpdftbl_rule {
+    int col;                    /**< Column the rule applies to, -1 for all columns */
+    hpdftbl_rule_op_t op;       /**< Predicate */
+    double value;               /**< Numeric operand. The number of cells for RULE_TOP_N and RULE_BOTTOM_N */
+    double value2;              /**< Upper limit for RULE_BETWEEN */
+    char *str;                  /**< String operand for the string predicates */
+    unsigned apply;             /**< The parts of `style` to set. Bitmask of hpdftbl_rule_apply_t */
+    hpdf_text_style_t style;    /**< Style to use for a matching cell */
+} hpdftbl_rule_t;
+
 
 /**
  * @brief Table handle is a pointer to the hpdftbl structure
@@ -323,7 +493,8 @@ typedef struct hpdftbl *hpdftbl_t;
  * @brief Type specification for the table content callback
  *
  * The content callback is used to specify the textual content in a cell and is an alternative
- * method to specifying the content to be displayed.
+ * method to specifying the content to be displayed. The callback is called once per cell when
+ * the table is laid out and the returned string is copied, so it may be a static buffer.
  *
  * @see hpdftbl_set_content_cb()
  */
@@ -345,7 +516,9 @@ typedef void (*hpdftbl_canvas_callback_t)(HPDF_Doc, HPDF_Page, void *, size_t, s
  * @brief Type specification for the content style.
  *
  * The content callback is used to specify the textual style in a cell and is an alternative
- * method to specifying the style of content to be displayed.
+ * method to specifying the style of content to be displayed. The callback is called once per
+ * cell with the resolved content of the cell and the style it returns is used for both the
+ * background and the text.
  *
  * @see hpdftbl_set_content_style_cb()
  *
@@ -444,8 +617,11 @@ struct hpdftbl_cell {
     hpdftbl_canvas_callback_t canvas_cb;
     /** Cell canvas dynamic callback name. The name is created vi `strdup()` and must be freed on destruction */
     char *canvas_dyncb;
-    /** The style of the text content. If a style callback is specified the callback will override this setting */
-    hpdf_text_style_t content_style;
+    /** The style of the text content as an id in the table style pool, 0 if the table content style is used.
+     * If a style callback is specified the callback will override this setting. @see hpdftbl_cell_style() */
+    unsigned style_id;
+    /** Wrap mode for the cell. WRAP_INHERIT uses the column or table setting. @see hpdftbl_set_cell_wrap_mode() */
+    hpdftbl_wrap_mode_t wrap_mode;
     /** Parent cell. If this cell is part of another cells row or column spanning this is a reference to this parent cell.
      * Normal cells without spanning has NULL as parent cell.
      */
@@ -459,6 +635,97 @@ struct hpdftbl_cell {
  */
 typedef struct hpdftbl_cell hpdftbl_cell_t;
 
+/**
+ * @brief An error collected in a table
+ *
+ * @see hpdftbl_set_collect_errors(), hpdftbl_get_errors()
+ */
+typedef struct hpdftbl_error {
+    int code;           /**< Error code. Negative for table errors and positive for HPDF errors */
+    int row;            /**< Row of the cell where the error occurred, -1 if not in a cell */
+    int col;            /**< Column of the cell where the error occurred, -1 if not in a cell */
+    int lineno;         /**< Line number in the library where the error was discovered */
+    const char *file;   /**< File name in the library where the error was discovered */
+} hpdftbl_error_t;
+
+/**
+ * @brief Instrumented operations in the stroking of a table
+ *
+ * @see hpdftbl_get_stat(), hpdftbl_stats_dumps()
+ */
+typedef enum hpdftbl_stat_id {
+    STAT_DRAW = 0,          /**< Drawing of a table after its layout has been calculated */
+    STAT_LAYOUT = 1,        /**< Calculation of the cell positions */
+    STAT_CONTENT_CB = 2,    /**< Content callbacks */
+    STAT_LABEL_CB = 3,      /**< Label callbacks */
+    STAT_STYLE_CB = 4,      /**< Content style callbacks */
+    STAT_CANVAS_CB = 5,     /**< Canvas callbacks */
+    STAT_TEXT_ENCODING = 6, /**< Encoding and writing of text */
+    STAT_FONT_SWITCH = 7,   /**< Setting of font, font size and text color */
+    STAT_GRID = 8,          /**< Drawing of grid lines and the outer border */
+    STAT_BACKGROUND = 9,    /**< Filling of the table, cell and title backgrounds */
+    STAT_NUM_COUNTERS = 10  /**< Number of counters */
+} hpdftbl_stat_id_t;
+
+/**
+ * @brief Counter for an instrumented operation
+ *
+ * @see hpdftbl_get_stat()
+ */
+typedef struct hpdftbl_stat {
+    unsigned long calls;    /**< Number of times the operation has been done */
+    unsigned long ops;      /**< Number of PDF operators written by the operation */
+    double seconds;         /**< Cumulative time spent in the operation */
+} hpdftbl_stat_t;
+
+/**
+ * @brief Statistics for the last rendering of a table
+ *
+ * @see hpdftbl_get_render_stats()
+ */
+typedef struct hpdftbl_render_stats {
+    size_t cells;               /**< Number of cells stroked */
+    size_t spanned_cells;       /**< Number of cells skipped since they are covered by a spanning cell */
+    size_t content_cb_calls;    /**< Number of content callback invocations */
+    size_t label_cb_calls;      /**< Number of label callback invocations */
+    size_t style_cb_calls;      /**< Number of content style callback invocations */
+    size_t canvas_cb_calls;     /**< Number of canvas callback invocations */
+    size_t text_bytes;          /**< Number of bytes of text encoded */
+    size_t encoding_errors;     /**< Number of texts that could not be encoded and were written as "???" */
+    size_t font_changes;        /**< Number of font and font size changes */
+    size_t color_changes;       /**< Number of fill and stroke color changes */
+    size_t path_ops;            /**< Number of stroked paths (grid lines and borders) */
+    size_t fill_ops;            /**< Number of filled paths (backgrounds) */
+} hpdftbl_render_stats_t;
+
+/**
+ * @brief Theme elements that a table overrides when it uses a shared theme
+ *
+ * A flag is set when the corresponding style is set on the table with one of the
+ * style setters. An overridden element is not updated from the shared theme.
+ * @see hpdftbl_use_shared_theme()
+ */
+typedef enum hpdftbl_theme_override {
+    THEME_OVR_CONTENT_STYLE = 0x0001,   /**< Content style */
+    THEME_OVR_LABEL_STYLE = 0x0002,     /**< Label style */
+    THEME_OVR_HEADER_STYLE = 0x0004,    /**< Header font, size and colors */
+    THEME_OVR_HEADER_HALIGN = 0x0008,   /**< Header alignment */
+    THEME_OVR_TITLE_STYLE = 0x0010,     /**< Title font, size and colors */
+    THEME_OVR_TITLE_HALIGN = 0x0020,    /**< Title alignment */
+    THEME_OVR_OUTER_GRID = 0x0040,      /**< Outer border */
+    THEME_OVR_INNER_VGRID = 0x0080,     /**< Inner vertical grid */
+    THEME_OVR_INNER_HGRID = 0x0100,     /**< Inner horizontal grid */
+    THEME_OVR_INNER_TGRID = 0x0200,     /**< Inner top grid */
+    THEME_OVR_USE_HEADER = 0x0400,      /**< Use of header row */
+    THEME_OVR_USE_LABELS = 0x0800,      /**< Use of cell labels */
+    THEME_OVR_USE_LABELGRID = 0x1000,   /**< Use of short label grid */
+    THEME_OVR_ZEBRA = 0x2000,           /**< Use and phase of zebra rows */
+    THEME_OVR_ZEBRA_COLOR = 0x4000,     /**< Zebra colors */
+    THEME_OVR_VMARGIN = 0x8000,         /**< Bottom vertical margin factor */
+    THEME_OVR_RULES = 0x10000,          /**< Conditional formatting rules */
+    THEME_OVR_CONTENT_BACKGROUND = 0x20000 /**< Content background color */
+} hpdftbl_theme_override_t;
+
 /**
  * @brief Core table handle
  *
@@ -553,10 +820,185 @@ struct hpdftbl {
     HPDF_RGBColor zebra_color2;
     /** User specified column width array as fraction of the table width. Defaults to equ-width */
     float *col_width_percent;
+    /** Minimum column widths in points used when column widths are calculated from the content. NULL if not set. @see hpdftbl_set_colwidth_min() */
+    HPDF_REAL *col_min_width;
+    /** Calculate column widths from the content when stroked. @see hpdftbl_set_auto_colwidth() */
+    _Bool use_auto_colwidth;
+    /** Wrap mode for all cells in the table. @see hpdftbl_set_wrap_mode() */
+    hpdftbl_wrap_mode_t wrap_mode;
+    /** Wrap mode per column. NULL if not set. @see hpdftbl_set_col_wrap_mode() */
+    hpdftbl_wrap_mode_t *col_wrap_mode;
+    /** Overflow policy per column. NULL if not set. @see hpdftbl_set_col_overflow() */
+    hpdftbl_overflow_t *col_overflow;
+    /** Calculate the height of each row from its content. @see hpdftbl_set_auto_rowheight() */
+    _Bool use_auto_rowheight;
+    /** Offset of the top of each row from the top of the table as calculated when stroked.
+     * The array has `rows+1` entries where the last entry is the table height. */
+    HPDF_REAL *row_offset;
+    /** Offsets in `text_pool` of the texts returned by the content and label callbacks when the table was
+     * laid out. The content of cell `i` is at index `2*i` and the label at `2*i+1`. NULL if no callback is used. */
+    size_t *text_off;
+    /** Copies of the texts returned by the content and label callbacks */
+    char *text_pool;
+    /** Used size of the text pool */
+    size_t text_pool_len;
+    /** Allocated size of the text pool */
+    size_t text_pool_size;
     /** Reference to all an array of cells in the table*/
     hpdftbl_cell_t *cells;
+    /** Binary table image that strings in the table may reference in place. @see hpdftbl_create_from_image() */
+    const char *image;
+    /** Size of the binary table image */
+    size_t image_size;
+    /** TRUE if the image was mapped by hpdftbl_open_image() and should be unmapped on destruction */
+    _Bool image_mapped;
+    /** Pool of the distinct cell content styles used in the table. Cells refer to a style by its id, i.e. index + 1.
+     * @see hpdftbl_intern_style() */
+    hpdf_text_style_t *styles;
+    /** Number of styles in the style pool */
+    size_t num_styles;
+    /** Allocated size of the style pool */
+    size_t styles_size;
+    /** Shared theme used by the table, NULL if not used. @see hpdftbl_use_shared_theme() */
+    struct hpdftbl_shared_theme *shared_theme;
+    /** Version of the shared theme the styles were last resolved from. The table holds a reference
+     * to it since the styles use its font names and rules. NULL if never resolved */
+    struct hpdftbl_theme_version *theme_version;
+    /** Theme elements set on the table that override the shared theme. Bitmask of hpdftbl_theme_override_t */
+    unsigned theme_override;
+    /** Conditional formatting rules. The array is not owned by the table. @see hpdftbl_set_rules() */
+    const hpdftbl_rule_t *rules;
+    /** Number of conditional formatting rules */
+    size_t num_rules;
+    /** Collect errors in the table instead of calling the error handler. @see hpdftbl_set_collect_errors() */
+    _Bool collect_errors;
+    /** Errors collected in the table */
+    hpdftbl_error_t *errors;
+    /** Number of collected errors */
+    size_t num_errors;
+    /** Allocated size of the errors array */
+    size_t errors_size;
+    /** Statistics for the last rendering of the table. @see hpdftbl_get_render_stats() */
+    hpdftbl_render_stats_t stats;
+};
+
+/**
+ * @brief A rectangle on the page
+ *
+ * @see hpdftbl_get_cell_rect()
+ */
+typedef struct hpdftbl_rect {
+    HPDF_REAL x;        /**< Left x-position */
+    HPDF_REAL y;        /**< Bottom y-position */
+    HPDF_REAL width;    /**< Width */
+    HPDF_REAL height;   /**< Height */
+} hpdftbl_rect_t;
+
+/**
+ * @brief The calculated layout of a table
+ *
+ * @see hpdftbl_layout()
+ */
+typedef struct hpdftbl_layout {
+    /** Width of table */
+    HPDF_REAL width;
+    /** Height of table not including the title */
+    HPDF_REAL height;
+    /** Height of the title, 0 if the table has no title */
+    HPDF_REAL title_height;
+    /** Total height of the table including the title */
+    HPDF_REAL total_height;
+    /** Number of rows */
+    size_t rows;
+    /** Offset of the top of each row from the top of the table (below the title). There are `rows+1` offsets
+     * where the last is the table height. The array is owned by the table. */
+    const HPDF_REAL *row_offset;
+} hpdftbl_layout_t;
+
+/**
+ * @brief State kept while drawing operations are recorded into a Form XObject
+ *
+ * @see hpdftbl_xobject_begin(), hpdftbl_xobject_end()
+ */
+typedef struct hpdftbl_xobject_rec {
+    /** PDF document reference */
+    HPDF_Doc pdf_doc;
+    /** The page being recorded from */
+    HPDF_Page pdf_page;
+    /** The form being recorded */
+    HPDF_XObject xobject;
+    /** The content stream of the page while the recording is active */
+    void *page_stream;
+    /** The font resources of the page while the recording is active */
+    void *page_fonts;
+    /** The XObject resources of the page while the recording is active */
+    void *page_xobjects;
+} hpdftbl_xobject_rec_t;
+
+/**
+ * @brief A table recorded once as a Form XObject to be placed on several pages
+ *
+ * @see hpdftbl_stamp_create(), hpdftbl_stamp_place()
+ */
+typedef struct hpdftbl_stamp {
+    /** The recorded table */
+    HPDF_XObject xobject;
+    /** Width of the table */
+    HPDF_REAL width;
+    /** Total height of the table including the title */
+    HPDF_REAL height;
+    /** Anchor of the table when it was recorded */
+    _Bool anchor_is_top_left;
+} hpdftbl_stamp_t;
+
+/**
+ * @brief Callback type used by a flow to create a new page
+ *
+ * @see hpdftbl_flow_set_page_cb()
+ */
+typedef HPDF_Page (*hpdftbl_flow_page_callback_t)(HPDF_Doc);
+
+/**
+ * @brief Flow of tables placed after each other over one or more pages
+ *
+ * @see hpdftbl_flow_create()
+ */
+struct hpdftbl_flow {
+    /** PDF document reference */
+    HPDF_Doc pdf_doc;
+    /** Current page */
+    HPDF_Page pdf_page;
+    /** Left x-position of the tables */
+    HPDF_REAL xpos;
+    /** Top y-position of the next table on the current page */
+    HPDF_REAL ypos;
+    /** Width of the tables */
+    HPDF_REAL width;
+    /** Vertical space between tables */
+    HPDF_REAL spacing;
+    /** Distance from the top of a new page to the first table */
+    HPDF_REAL top_margin;
+    /** Minimum distance from the last table to the bottom of the page */
+    HPDF_REAL bottom_margin;
+    /** TRUE if no table has been placed on the current page */
+    _Bool page_empty;
+    /** Number of pages added by the flow */
+    size_t num_pages;
+    /** Callback to create a new page. If NULL an A4 portrait page is added. */
+    hpdftbl_flow_page_callback_t new_page_cb;
+    /** Queue of tables to place */
+    hpdftbl_t *queue;
+    /** Number of tables in the queue */
+    size_t queue_len;
+    /** Allocated size of the queue */
+    size_t queue_size;
 };
 
+/**
+ * @brief Flow handle
+ */
+typedef struct hpdftbl_flow *hpdftbl_flow_t;
+
 /**
  * @brief Used in data driven table creation
  *
@@ -665,8 +1107,63 @@ typedef struct hpdftbl_theme {
     HPDF_RGBColor zebra_color2;
     /** Specify the vertical margin factor */
     HPDF_REAL bottom_vmargin_factor;
+    /** Conditional formatting rules, NULL if not used. The array is not owned by the theme. */
+    const hpdftbl_rule_t *rules;
+    /** Number of conditional formatting rules */
+    size_t num_rules;
 } hpdftbl_theme_t;
 
+/**
+ * @brief The built-in themes
+ *
+ * The built-in themes are static and immutable and can be used without any memory allocation.
+ * @see hpdftbl_get_builtin_theme(), hpdftbl_create_with_theme()
+ */
+typedef enum hpdftbl_builtin_theme {
+    THEME_DEFAULT = 0,  /**< The default theme used by hpdftbl_create() */
+    THEME_ZEBRA = 1,    /**< Header row and zebra colored rows */
+    THEME_LABELS = 2    /**< Cell labels with short label grid */
+} hpdftbl_builtin_theme_t;
+
+/**
+ * @brief One version of a shared theme
+ *
+ * A version is never changed once it has been created. Replacing the theme in a shared theme
+ * creates a new version and the old version is freed when the last table that was resolved
+ * from it has been resolved again or destroyed.
+ * @see hpdftbl_shared_theme_set()
+ */
+struct hpdftbl_theme_version {
+    /** The theme. The font names and the rules are owned by the version */
+    hpdftbl_theme_t theme;
+    /** Number of references. One for the shared theme while it is the current version and one
+     * for each table resolved from it. Only updated atomically */
+    long refcnt;
+};
+
+/**
+ * @brief A reference counted theme that is shared between tables
+ *
+ * The styles of a table that uses a shared theme are taken from the current version of the
+ * shared theme each time the table is laid out, stroked or serialized. This means that changing
+ * the shared theme changes all tables that use it.
+ * @see hpdftbl_shared_theme_create(), hpdftbl_use_shared_theme()
+ */
+struct hpdftbl_shared_theme {
+    /** The current version of the theme. Only read or replaced with the lock held */
+    struct hpdftbl_theme_version *version;
+    /** Number of references. One for the creator and one for each table that uses the theme.
+     * Only updated atomically */
+    long refcnt;
+    /** Spin lock for the current version */
+    long lock;
+};
+
+/**
+ * @brief Handle to a shared theme
+ */
+typedef struct hpdftbl_shared_theme *hpdftbl_shared_theme_t;
+
 /**
  * @brief TYpe for error handler function
  *
@@ -678,6 +1175,24 @@ typedef void (*hpdftbl_error_handler_t)(hpdftbl_t, int, int, int);
 
 extern hpdftbl_error_handler_t hpdftbl_err_handler ;
 
+/**
+ * @brief Type for a custom memory allocation function. Same semantics as `malloc()`
+ * @see hpdftbl_set_alloc_funcs()
+ */
+typedef void *(*hpdftbl_malloc_func_t)(size_t);
+
+/**
+ * @brief Type for a custom memory reallocation function. Same semantics as `realloc()`
+ * @see hpdftbl_set_alloc_funcs()
+ */
+typedef void *(*hpdftbl_realloc_func_t)(void *, size_t);
+
+/**
+ * @brief Type for a custom memory release function. Same semantics as `free()`
+ * @see hpdftbl_set_alloc_funcs()
+ */
+typedef void (*hpdftbl_free_func_t)(void *);
+
 /*
  * Table creation and destruction function
  */
@@ -687,6 +1202,9 @@ hpdftbl_create(size_t rows, size_t cols);
 hpdftbl_t
 hpdftbl_create_title(size_t rows, size_t cols, char *title);
 
+hpdftbl_t
+hpdftbl_create_with_theme(size_t rows, size_t cols, char *title, const hpdftbl_theme_t *theme);
+
 int
 hpdftbl_stroke(HPDF_Doc pdf,
                HPDF_Page page, hpdftbl_t t,
@@ -700,6 +1218,66 @@ hpdftbl_stroke_pos(HPDF_Doc pdf,
 int
 hpdftbl_stroke_from_data(HPDF_Doc pdf_doc, HPDF_Page pdf_page, hpdftbl_spec_t *tbl_spec, hpdftbl_theme_t *theme);
 
+int
+hpdftbl_layout(HPDF_Doc pdf, hpdftbl_t t, HPDF_REAL width, HPDF_REAL height, hpdftbl_layout_t *layout);
+
+int
+hpdftbl_get_cell_rect(hpdftbl_t t, size_t r, size_t c, hpdftbl_rect_t *rect);
+
+int
+hpdftbl_stroke_layout(HPDF_Doc pdf, HPDF_Page page, hpdftbl_t t, HPDF_REAL xpos, HPDF_REAL ypos);
+
+/*
+ * Flow layout of several tables
+ */
+
+hpdftbl_flow_t
+hpdftbl_flow_create(HPDF_Doc pdf_doc, HPDF_Page pdf_page, HPDF_REAL xpos, HPDF_REAL ypos, HPDF_REAL width);
+
+int
+hpdftbl_flow_destroy(hpdftbl_flow_t flow);
+
+int
+hpdftbl_flow_set_spacing(hpdftbl_flow_t flow, HPDF_REAL spacing);
+
+int
+hpdftbl_flow_set_margins(hpdftbl_flow_t flow, HPDF_REAL top, HPDF_REAL bottom);
+
+int
+hpdftbl_flow_set_page_cb(hpdftbl_flow_t flow, hpdftbl_flow_page_callback_t cb);
+
+int
+hpdftbl_flow_add(hpdftbl_flow_t flow, hpdftbl_t t);
+
+int
+hpdftbl_flow_stroke(hpdftbl_flow_t flow);
+
+int
+hpdftbl_flow_new_page(hpdftbl_flow_t flow);
+
+int
+hpdftbl_flow_get_pos(hpdftbl_flow_t flow, HPDF_Page *page, HPDF_REAL *ypos);
+
+/*
+ * Recording of drawing operations into reusable Form XObjects
+ */
+
+HPDF_XObject
+hpdftbl_xobject_begin(HPDF_Doc pdf_doc, HPDF_Page page, HPDF_Rect bbox, hpdftbl_xobject_rec_t *rec);
+
+HPDF_XObject
+hpdftbl_xobject_end(hpdftbl_xobject_rec_t *rec);
+
+int
+hpdftbl_xobject_place(HPDF_Page page, HPDF_XObject xobject, HPDF_REAL xpos, HPDF_REAL ypos);
+
+int
+hpdftbl_stamp_create(HPDF_Doc pdf_doc, HPDF_Page page, hpdftbl_t t, HPDF_REAL width, HPDF_REAL height,
+                     hpdftbl_stamp_t *stamp);
+
+int
+hpdftbl_stamp_place(HPDF_Page page, const hpdftbl_stamp_t *stamp, HPDF_REAL xpos, HPDF_REAL ypos);
+
 int
 hpdftbl_setpos(hpdftbl_t t,
                const HPDF_REAL xpos, const HPDF_REAL ypos,
@@ -738,21 +1316,107 @@ hpdftbl_get_last_err_file(int *lineno, char **file, char **extrainfo);
 void
 hpdftbl_default_table_error_handler(hpdftbl_t t, int r, int c, int err);
 
+int
+hpdftbl_set_collect_errors(hpdftbl_t t, _Bool collect);
+
+size_t
+hpdftbl_get_errors(hpdftbl_t t, const hpdftbl_error_t **errors);
+
+int
+hpdftbl_clear_errors(hpdftbl_t t);
+
+/*
+ * Instrumentation
+ */
+_Bool
+hpdftbl_stats_enabled(void);
+
+int
+hpdftbl_get_stat(hpdftbl_stat_id_t id, hpdftbl_stat_t *stat);
+
+const char *
+hpdftbl_get_stat_name(hpdftbl_stat_id_t id);
+
+void
+hpdftbl_reset_stats(void);
+
+int
+hpdftbl_stats_dump(char *filename);
+
+int
+hpdftbl_stats_dumps(char *buff, size_t buffsize);
+
+int
+hpdftbl_get_render_stats(hpdftbl_t t, hpdftbl_render_stats_t *stats);
+
+int
+hpdftbl_render_stats_dumps(hpdftbl_t t, char *buff, size_t buffsize);
+
+/*
+ * Memory handling
+ */
+int
+hpdftbl_set_alloc_funcs(hpdftbl_malloc_func_t malloc_fn, hpdftbl_realloc_func_t realloc_fn,
+                        hpdftbl_free_func_t free_fn);
+
+void
+hpdftbl_get_alloc_funcs(hpdftbl_malloc_func_t *malloc_fn, hpdftbl_realloc_func_t *realloc_fn,
+                        hpdftbl_free_func_t *free_fn);
+
+void *
+hpdftbl_malloc(size_t size);
+
+void *
+hpdftbl_calloc(size_t num, size_t size);
+
+void *
+hpdftbl_realloc(void *ptr, size_t size);
+
+char *
+hpdftbl_strdup(const char *s);
+
+void
+hpdftbl_free(void *ptr);
+
+int
+hpdftbl_get_memory_usage(hpdftbl_t t, size_t *bytes);
+
+size_t
+hpdftbl_get_cache_memory_usage(void);
+
 /*
  * Theme handling functions
  */
 int
-hpdftbl_apply_theme(hpdftbl_t t, hpdftbl_theme_t *theme);
+hpdftbl_apply_theme(hpdftbl_t t, const hpdftbl_theme_t *theme);
 
 hpdftbl_theme_t *
 hpdftbl_get_default_theme(void);
 
+const hpdftbl_theme_t *
+hpdftbl_get_builtin_theme(hpdftbl_builtin_theme_t which);
+
+hpdftbl_shared_theme_t
+hpdftbl_shared_theme_create(const hpdftbl_theme_t *theme);
+
+int
+hpdftbl_shared_theme_release(hpdftbl_shared_theme_t shared);
+
+int
+hpdftbl_shared_theme_set(hpdftbl_shared_theme_t shared, const hpdftbl_theme_t *theme);
+
+int
+hpdftbl_use_shared_theme(hpdftbl_t t, hpdftbl_shared_theme_t shared);
+
 int
 hpdftbl_get_theme(hpdftbl_t tbl, hpdftbl_theme_t *theme);
 
 int
 hpdftbl_destroy_theme(hpdftbl_theme_t *theme);
 
+void
+hpdftbl_theme_free_rules(hpdftbl_theme_t *theme);
+
 /*
  * Table layout adjusting functions
  */
@@ -766,6 +1430,27 @@ hpdftbl_set_min_rowheight(hpdftbl_t t, float h);
 int
 hpdftbl_set_colwidth_percent(hpdftbl_t t, size_t c, float w);
 
+int
+hpdftbl_set_auto_rowheight(hpdftbl_t t, _Bool use);
+
+int
+hpdftbl_set_auto_colwidth(hpdftbl_t t, _Bool use);
+
+int
+hpdftbl_set_colwidth_min(hpdftbl_t t, size_t c, HPDF_REAL w);
+
+int
+hpdftbl_set_wrap_mode(hpdftbl_t t, hpdftbl_wrap_mode_t mode);
+
+int
+hpdftbl_set_col_wrap_mode(hpdftbl_t t, size_t c, hpdftbl_wrap_mode_t mode);
+
+int
+hpdftbl_set_cell_wrap_mode(hpdftbl_t t, size_t r, size_t c, hpdftbl_wrap_mode_t mode);
+
+int
+hpdftbl_set_col_overflow(hpdftbl_t t, size_t c, hpdftbl_overflow_t overflow);
+
 int
 hpdftbl_clear_spanning(hpdftbl_t t);
 
@@ -781,6 +1466,9 @@ hpdftbl_set_zebra(hpdftbl_t t, _Bool use, int phase);
 int
 hpdftbl_set_zebra_color(hpdftbl_t t, HPDF_RGBColor z1,  HPDF_RGBColor z2);
 
+int
+hpdftbl_set_rules(hpdftbl_t t, const hpdftbl_rule_t *rules, size_t num_rules);
+
 int
 hpdftbl_use_labels(hpdftbl_t t, _Bool use);
 
@@ -967,6 +1655,29 @@ hpdftbl_widget_strength_meter(HPDF_Doc doc, HPDF_Page page,
                               HPDF_REAL xpos, HPDF_REAL ypos, HPDF_REAL width, HPDF_REAL height,
                               size_t num_segments, HPDF_RGBColor on_color, size_t num_on_segments);
 
+void
+hpdftbl_widget_sparkline(HPDF_Doc doc, HPDF_Page page,
+                         HPDF_REAL xpos, HPDF_REAL ypos, HPDF_REAL width, HPDF_REAL height,
+                         HPDF_RGBColor color, const double *values, size_t num_values);
+
+void
+hpdftbl_widget_minibar(HPDF_Doc doc, HPDF_Page page,
+                       HPDF_REAL xpos, HPDF_REAL ypos, HPDF_REAL width, HPDF_REAL height,
+                       HPDF_RGBColor pos_color, HPDF_RGBColor neg_color,
+                       const double *values, size_t num_values);
+
+void
+hpdftbl_widget_minmax_band(HPDF_Doc doc, HPDF_Page page,
+                           HPDF_REAL xpos, HPDF_REAL ypos, HPDF_REAL width, HPDF_REAL height,
+                           HPDF_RGBColor band_color, HPDF_RGBColor line_color,
+                           const double *values, size_t num_values);
+
+void
+hpdftbl_use_widget_cache(_Bool use);
+
+void
+hpdftbl_clear_widget_cache(void);
+
 int
 hpdftbl_stroke_pdfdoc(HPDF_Doc pdf_doc, char *file);
 
@@ -978,12 +1689,24 @@ hpdftbl_dump(hpdftbl_t tbl, char *filename);
 int
 hpdftbl_dumps(hpdftbl_t tbl, char *buff, size_t buffsize);
 
+int
+hpdftbl_dump_compact(hpdftbl_t tbl, char *filename);
+
+int
+hpdftbl_dumps_compact(hpdftbl_t tbl, char *buff, size_t buffsize);
+
 int
 hpdftbl_load(hpdftbl_t tbl, char *filename);
 
 int
 hpdftbl_loads(hpdftbl_t tbl, char *buff);
 
+int
+hpdftbl_stream_load(hpdftbl_t tbl, char *filename);
+
+int
+hpdftbl_stream_loads(hpdftbl_t tbl, char *buff);
+
 int
 hpdftbl_theme_dump(hpdftbl_theme_t *theme, char *filename);
 
@@ -996,8 +1719,26 @@ hpdftbl_theme_loads(hpdftbl_theme_t *tbl, char *buff);
 int
 hpdftbl_theme_load(hpdftbl_theme_t *tbl, char *filename);
 
+int
+hpdftbl_shared_theme_load(hpdftbl_shared_theme_t shared, char *filename);
+
 #endif
 
+int
+hpdftbl_dumpb(hpdftbl_t tbl, char **buff, size_t *size);
+
+int
+hpdftbl_loadb(hpdftbl_t tbl, const char *buff, size_t size);
+
+hpdftbl_t
+hpdftbl_create_from_image(const char *buff, size_t size);
+
+hpdftbl_t
+hpdftbl_open_image(const char *filename);
+
+int
+hpdftbl_dump_image(hpdftbl_t tbl, const char *filename);
+
 size_t
 xstrlcat(char *dst, const char *src, size_t siz);
 
@@ -1007,12 +1748,91 @@ xstrlcpy(char * __restrict dst, const char * __restrict src, size_t dsize);
 int
 hpdftbl_read_file(char *buff, size_t buffsize, char *filename);
 
+int
+hpdftbl_map_file(const char *filename, char **buff, size_t *size);
+
+void
+hpdftbl_unmap_file(char *buff, size_t size);
+
+const HPDF_UINT16 *
+hpdftbl_get_glyph_widths(HPDF_Doc pdf_doc, const char *fontname);
+
+HPDF_REAL
+hpdftbl_text_width(HPDF_Doc pdf_doc, const char *fontname, HPDF_REAL fsize, const char *text);
+
+size_t
+hpdftbl_wrap_text(HPDF_Doc pdf_doc, const char *fontname, HPDF_REAL fsize, const char *text, HPDF_REAL width,
+                  hpdftbl_text_line_t *lines, size_t max_lines);
+
+size_t
+hpdftbl_text_fit(HPDF_Doc pdf_doc, const char *fontname, HPDF_REAL fsize, const char *text, HPDF_REAL width,
+                 const char *ellipsis, HPDF_REAL *fit_width);
+
+void
+hpdftbl_clear_glyph_cache(void);
+
 /*
  * Internal functions
  */
 _Bool
 chktbl(hpdftbl_t, size_t, size_t);
 
+_Bool
+hpdftbl_collect_error(hpdftbl_t t, int err, int r, int c, int lineno, const char *file);
+
+int
+hpdftbl_widget_cache_begin(HPDF_Doc doc, HPDF_Page page, const char *key, HPDF_Rect bbox,
+                           HPDF_REAL xpos, HPDF_REAL ypos, hpdftbl_xobject_rec_t *rec);
+
+void
+hpdftbl_widget_cache_end(const char *key, HPDF_REAL xpos, HPDF_REAL ypos, hpdftbl_xobject_rec_t *rec);
+
+void
+hpdftbl_resolve_theme(hpdftbl_t t);
+
+void
+hpdftbl_release_theme(hpdftbl_t t);
+
+int
+hpdftbl_add_style(hpdftbl_t t, const hpdf_text_style_t *style, unsigned *id);
+
+int
+hpdftbl_intern_style(hpdftbl_t t, const hpdf_text_style_t *style, unsigned *id);
+
+const hpdf_text_style_t *
+hpdftbl_cell_style(hpdftbl_t t, const hpdftbl_cell_t *cell);
+
+char *
+hpdftbl_cell_content(hpdftbl_t t, hpdftbl_cell_t *cell, size_t r, size_t c);
+
+int
+hpdftbl_rules_copy(const hpdftbl_rule_t *src, size_t num_rules, hpdftbl_rule_t **dst);
+
+void
+hpdftbl_rules_free(hpdftbl_rule_t *rules, size_t num_rules);
+
+int
+hpdftbl_rules_prepare(hpdftbl_t t, double **limits);
+
+unsigned
+hpdftbl_rules_apply(hpdftbl_t t, const double *limits, size_t r, size_t c, const char *content,
+                    hpdf_text_style_t *style);
+
+double
+hpdftbl_stat_clock(void);
+
+void
+hpdftbl_stat_add(hpdftbl_stat_id_t id, unsigned long nops, double start);
+
+const char *
+hpdftbl_get_target_encoding(void);
+
+size_t
+hpdftbl_glyph_cache_memory_usage(void);
+
+size_t
+hpdftbl_widget_cache_memory_usage(void);
+
 #ifdef    __cplusplus
 }
 #endif
@@ -0,0 +1,948 @@
+/**
+ * @file
+ * @brief   Compact binary serialization of tables
+ * @author   Johan Persson (johan162@gmail.com)
+ *
+ * Copyright (C) 2022 Johan Persson
+ *
+ * @see LICENSE
+ *
+ * Released under the MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <hpdf.h>
+#include "hpdftbl.h"
+
+/*-----------------------------------------------------------------------
+ * Binary table image layout.
+ *
+ * All fields are 32-bit and stored in host byte order. Every section
+ * starts on a 4-byte boundary and is addressed by its byte offset from
+ * the start of the image, which makes the image relocatable.
+ *
+ *  +-----------------------+
+ *  | bin_header_t          |
+ *  +-----------------------+
+ *  | float colw[cols]      |  column widths in percent
+ *  +-----------------------+
+ *  | bin_style_t[]         |  unique text styles
+ *  +-----------------------+
+ *  | bin_cell_t[]          |  only cells with non-default data
+ *  +-----------------------+
+ *  | bin_span_t[]          |  only cells that span rows or columns
+ *  +-----------------------+
+ *  | char strings[]        |  unique NULL terminated strings
+ *  +-----------------------+
+ */
+
+/** Magic bytes that starts every binary table image */
+static const char BIN_MAGIC[4] = {'H', 'T', 'B', 'L'};
+
+/** Byte order mark used to detect images written on a host with different endianness */
+#define BIN_BYTE_ORDER 0x0102
+
+/** Used as string reference or style index to indicate a NULL value */
+#define BIN_NONE 0xFFFFFFFFU
+
+/** Table flag bits */
+#define BIN_FLAG_ANCHOR_TOP_LEFT   0x01U
+#define BIN_FLAG_USE_HEADER_ROW    0x02U
+#define BIN_FLAG_USE_CELL_LABELS   0x04U
+#define BIN_FLAG_USE_LABEL_GRID    0x08U
+#define BIN_FLAG_USE_ZEBRA         0x10U
+
+/** @brief Serialized grid style */
+typedef struct bin_grid {
+    float width;            /**< Line width */
+    float color[3];         /**< Line color */
+    uint32_t dashstyle;     /**< Line dash style */
+} bin_grid_t;
+
+/** @brief Serialized text style */
+typedef struct bin_style {
+    uint32_t font;          /**< String reference to font name */
+    float fsize;            /**< Font size */
+    float color[3];         /**< Font color */
+    float background[3];    /**< Background color */
+    uint32_t halign;        /**< Horizontal alignment */
+} bin_style_t;
+
+/** @brief Serialized per-cell data. Only cells with non-default data are stored. */
+typedef struct bin_cell {
+    uint32_t row;                   /**< Cell row */
+    uint32_t col;                   /**< Cell column */
+    uint32_t label;                 /**< String reference to label */
+    uint32_t content;               /**< String reference to content */
+    uint32_t content_dyncb;         /**< String reference to content dynamic callback */
+    uint32_t label_dyncb;           /**< String reference to label dynamic callback */
+    uint32_t content_style_dyncb;   /**< String reference to content style dynamic callback */
+    uint32_t canvas_dyncb;          /**< String reference to canvas dynamic callback */
+    uint32_t style;                 /**< Index of cell content style or BIN_NONE */
+} bin_cell_t;
+
+/** @brief Serialized cell spanning */
+typedef struct bin_span {
+    uint32_t row;           /**< Row of spanning cell */
+    uint32_t col;           /**< Column of spanning cell */
+    uint32_t rowspan;       /**< Number of rows spanned */
+    uint32_t colspan;       /**< Number of columns spanned */
+} bin_span_t;
+
+/** @brief Header of a binary table image */
+typedef struct bin_header {
+    char magic[4];                  /**< Always BIN_MAGIC */
+    uint16_t version;               /**< Always TABLE_BIN_VERSION */
+    uint16_t byte_order;            /**< Always BIN_BYTE_ORDER */
+    uint32_t size;                  /**< Total size of image in bytes */
+    uint32_t rows;                  /**< Number of rows */
+    uint32_t cols;                  /**< Number of columns */
+    uint32_t flags;                 /**< Combination of BIN_FLAG_* */
+    int32_t zebra_phase;            /**< Zebra phase */
+    float posx;                     /**< Table x-position */
+    float posy;                     /**< Table y-position */
+    float width;                    /**< Table width */
+    float height;                   /**< Table height */
+    float minrowheight;             /**< Minimum row height */
+    float bottom_vmargin_factor;    /**< Bottom margin factor */
+    float zebra_color1[3];          /**< First zebra color */
+    float zebra_color2[3];          /**< Second zebra color */
+    bin_grid_t outer_grid;          /**< Outer grid style */
+    bin_grid_t inner_vgrid;         /**< Inner vertical grid style */
+    bin_grid_t inner_hgrid;         /**< Inner horizontal grid style */
+    bin_grid_t inner_tgrid;         /**< Inner top grid style */
+    uint32_t content_style;         /**< Index of table content style */
+    uint32_t title_style;           /**< Index of table title style */
+    uint32_t header_style;          /**< Index of table header style */
+    uint32_t label_style;           /**< Index of table label style */
+    uint32_t title_txt;             /**< String reference to title */
+    uint32_t label_dyncb;           /**< String reference to table label dynamic callback */
+    uint32_t content_dyncb;         /**< String reference to table content dynamic callback */
+    uint32_t content_style_dyncb;   /**< String reference to table content style dynamic callback */
+    uint32_t canvas_dyncb;          /**< String reference to table canvas dynamic callback */
+    uint32_t post_dyncb;            /**< String reference to table post dynamic callback */
+    uint32_t colw_off;              /**< Offset to column widths */
+    uint32_t style_off;             /**< Offset to styles */
+    uint32_t num_styles;            /**< Number of styles */
+    uint32_t cell_off;              /**< Offset to cell records */
+    uint32_t num_cells;             /**< Number of cell records */
+    uint32_t span_off;              /**< Offset to span records */
+    uint32_t num_spans;             /**< Number of span records */
+    uint32_t str_off;               /**< Offset to string pool */
+    uint32_t str_size;              /**< Size of string pool in bytes */
+} bin_header_t;
+
+/** Round up to next 4-byte boundary */
+#define BIN_ALIGN(x) (((x) + 3U) & ~(size_t)3U)
+
+/*-----------------------------------------------------------------------
+ * Dump section.
+ */
+
+/** @brief String pool with interning used while serializing */
+typedef struct bin_strpool {
+    char *buff;         /**< Pool data */
+    size_t size;        /**< Used size */
+    size_t cap;         /**< Allocated size */
+    uint32_t *slots;    /**< Open addressing hash table. Stores offset+1, 0 is an empty slot */
+    size_t num_slots;   /**< Number of slots (always power of two) */
+    size_t count;       /**< Number of unique strings */
+} bin_strpool_t;
+
+/** @brief Growable array of unique styles used while serializing */
+typedef struct bin_styles {
+    bin_style_t *styles;    /**< Unique styles */
+    size_t count;           /**< Number of styles */
+    size_t cap;             /**< Allocated number of styles */
+} bin_styles_t;
+
+/**
+ * @brief FNV-1a hash of a string
+ * @param s String to hash
+ * @return Hash value
+ */
+static uint32_t
+bin_hash(const char *s) {
+    uint32_t h = 2166136261U;
+    while (*s) {
+        h ^= (unsigned char) *s++;
+        h *= 16777619U;
+    }
+    return h;
+}
+
+/**
+ * @brief Double the size of the string hash table and rehash all strings
+ * @param p String pool
+ * @return 0 on success, -1 on failure
+ */
+static int
+bin_strpool_rehash(bin_strpool_t *p) {
+    const size_t num_slots = p->num_slots ? p->num_slots * 2 : 64;
+    uint32_t *slots = hpdftbl_calloc(num_slots, sizeof(uint32_t));
+    if (slots == NULL)
+        return -1;
+    for (size_t i = 0; i < p->num_slots; i++) {
+        if (p->slots[i]) {
+            size_t j = bin_hash(p->buff + p->slots[i] - 1) & (num_slots - 1);
+            while (slots[j])
+                j = (j + 1) & (num_slots - 1);
+            slots[j] = p->slots[i];
+        }
+    }
+    hpdftbl_free(p->slots);
+    p->slots = slots;
+    p->num_slots = num_slots;
+    return 0;
+}
+
+/**
+ * @brief Add a string to the pool unless an identical string already exists
+ * @param p String pool
+ * @param s String to add. May be NULL.
+ * @param[out] ref Reference (offset) to the string in the pool or BIN_NONE for a NULL string
+ * @return 0 on success, -1 on failure
+ */
+static int
+bin_strpool_add(bin_strpool_t *p, const char *s, uint32_t *ref) {
+    if (s == NULL) {
+        *ref = BIN_NONE;
+        return 0;
+    }
+    if (2 * (p->count + 1) > p->num_slots && bin_strpool_rehash(p))
+        return -1;
+
+    size_t j = bin_hash(s) & (p->num_slots - 1);
+    while (p->slots[j]) {
+        if (0 == strcmp(p->buff + p->slots[j] - 1, s)) {
+            *ref = p->slots[j] - 1;
+            return 0;
+        }
+        j = (j + 1) & (p->num_slots - 1);
+    }
+
+    const size_t len = strlen(s) + 1;
+    if (p->size + len >= BIN_NONE)
+        return -1;
+    if (p->size + len > p->cap) {
+        size_t cap = p->cap ? p->cap : 1024;
+        while (cap < p->size + len)
+            cap *= 2;
+        char *buff = hpdftbl_realloc(p->buff, cap);
+        if (buff == NULL)
+            return -1;
+        p->buff = buff;
+        p->cap = cap;
+    }
+    memcpy(p->buff + p->size, s, len);
+    *ref = (uint32_t) p->size;
+    p->slots[j] = (uint32_t) p->size + 1;
+    p->size += len;
+    p->count++;
+    return 0;
+}
+
+/**
+ * @brief Add a text style to the style table unless an identical style already exists
+ * @param styles Style table
+ * @param pool String pool for font names
+ * @param style Style to add
+ * @param[out] idx Index of the style in the style table
+ * @return 0 on success, -1 on failure
+ */
+static int
+bin_styles_add(bin_styles_t *styles, bin_strpool_t *pool, const hpdf_text_style_t *style, uint32_t *idx) {
+    bin_style_t s;
+    memset(&s, 0, sizeof s);
+    if (bin_strpool_add(pool, style->font, &s.font))
+        return -1;
+    s.fsize = style->fsize;
+    s.color[0] = style->color.r;
+    s.color[1] = style->color.g;
+    s.color[2] = style->color.b;
+    s.background[0] = style->background.r;
+    s.background[1] = style->background.g;
+    s.background[2] = style->background.b;
+    s.halign = (uint32_t) style->halign;
+
+    // Search backwards since neighbouring cells most often share style
+    for (size_t i = styles->count; i > 0; i--) {
+        if (0 == memcmp(&styles->styles[i - 1], &s, sizeof s)) {
+            *idx = (uint32_t) (i - 1);
+            return 0;
+        }
+    }
+
+    if (styles->count == styles->cap) {
+        size_t cap = styles->cap ? styles->cap * 2 : 8;
+        bin_style_t *tmp = hpdftbl_realloc(styles->styles, cap * sizeof(bin_style_t));
+        if (tmp == NULL)
+            return -1;
+        styles->styles = tmp;
+        styles->cap = cap;
+    }
+    styles->styles[styles->count] = s;
+    *idx = (uint32_t) styles->count++;
+    return 0;
+}
+
+/**
+ * @brief Copy a grid style to its serialized form
+ * @param dst Serialized grid
+ * @param src Grid style
+ */
+static void
+bin_grid_set(bin_grid_t *dst, const hpdftbl_grid_style_t *src) {
+    dst->width = src->width;
+    dst->color[0] = src->color.r;
+    dst->color[1] = src->color.g;
+    dst->color[2] = src->color.b;
+    dst->dashstyle = (uint32_t) src->line_dashstyle;
+}
+
+/**
+ * @brief Serialize a table to a compact binary image.
+ *
+ * The binary image is a much more compact and faster to read back alternative to the JSON
+ * serialization with hpdftbl_dumps(). All strings (content, labels, font and callback names)
+ * are stored once in a string pool, identical text styles are stored once, and only cells
+ * that have data that differs from the default (i.e. have a label, content, own style or
+ * dynamic callbacks) are stored together with a separate list of the cells that span
+ * rows or columns.
+ *
+ * The image is stored in host byte order and can only be read back on a host with the
+ * same byte order. The table `tag` is a user pointer and is not serialized. Neither are
+ * the cell positions since they are always calculated when the table is stroked.
+ *
+ * The returned buffer is allocated by this function and must be freed by the caller
+ * with hpdftbl_free().
+ *
+ * *Example:*
+ * ```c
+ * char *buff;
+ * size_t size;
+ * if( 0 == hpdftbl_dumpb(tbl, &buff, &size) ) {
+ *     // Store buff[0] - buff[size-1]
+ *     hpdftbl_free(buff);
+ * }
+ * ```
+ *
+ * @param tbl Table handle of table to dump
+ * @param[out] buff Set to point to the allocated binary image
+ * @param[out] size Set to the size of the binary image
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_loadb(), hpdftbl_dumps()
+ */
+int
+hpdftbl_dumpb(hpdftbl_t tbl, char **buff, size_t *size) {
+    hpdftbl_t t = tbl;
+    _HPDFTBL_CHK_TABLE(t);
+    hpdftbl_resolve_theme(t);
+
+    bin_strpool_t pool;
+    bin_styles_t styles;
+    bin_header_t hdr;
+    memset(&pool, 0, sizeof pool);
+    memset(&styles, 0, sizeof styles);
+    memset(&hdr, 0, sizeof hdr);
+
+    const size_t num_cells = t->rows * t->cols;
+    bin_cell_t *cells = hpdftbl_calloc(num_cells ? num_cells : 1, sizeof(bin_cell_t));
+    bin_span_t *spans = hpdftbl_calloc(num_cells ? num_cells : 1, sizeof(bin_span_t));
+    if (cells == NULL || spans == NULL)
+        goto bin_raise_oom_error;
+
+    memcpy(hdr.magic, BIN_MAGIC, sizeof hdr.magic);
+    hdr.version = TABLE_BIN_VERSION;
+    hdr.byte_order = BIN_BYTE_ORDER;
+    hdr.rows = (uint32_t) t->rows;
+    hdr.cols = (uint32_t) t->cols;
+    hdr.flags = (t->anchor_is_top_left ? BIN_FLAG_ANCHOR_TOP_LEFT : 0) |
+                (t->use_header_row ? BIN_FLAG_USE_HEADER_ROW : 0) |
+                (t->use_cell_labels ? BIN_FLAG_USE_CELL_LABELS : 0) |
+                (t->use_label_grid_style ? BIN_FLAG_USE_LABEL_GRID : 0) |
+                (t->use_zebra ? BIN_FLAG_USE_ZEBRA : 0);
+    hdr.zebra_phase = t->zebra_phase;
+    hdr.posx = t->posx;
+    hdr.posy = t->posy;
+    hdr.width = t->width;
+    hdr.height = t->height;
+    hdr.minrowheight = t->minrowheight;
+    hdr.bottom_vmargin_factor = t->bottom_vmargin_factor;
+    hdr.zebra_color1[0] = t->zebra_color1.r;
+    hdr.zebra_color1[1] = t->zebra_color1.g;
+    hdr.zebra_color1[2] = t->zebra_color1.b;
+    hdr.zebra_color2[0] = t->zebra_color2.r;
+    hdr.zebra_color2[1] = t->zebra_color2.g;
+    hdr.zebra_color2[2] = t->zebra_color2.b;
+    bin_grid_set(&hdr.outer_grid, &t->outer_grid);
+    bin_grid_set(&hdr.inner_vgrid, &t->inner_vgrid);
+    bin_grid_set(&hdr.inner_hgrid, &t->inner_hgrid);
+    bin_grid_set(&hdr.inner_tgrid, &t->inner_tgrid);
+
+    if (bin_styles_add(&styles, &pool, &t->content_style, &hdr.content_style) ||
+        bin_styles_add(&styles, &pool, &t->title_style, &hdr.title_style) ||
+        bin_styles_add(&styles, &pool, &t->header_style, &hdr.header_style) ||
+        bin_styles_add(&styles, &pool, &t->label_style, &hdr.label_style) ||
+        bin_strpool_add(&pool, t->title_txt, &hdr.title_txt) ||
+        bin_strpool_add(&pool, t->label_dyncb, &hdr.label_dyncb) ||
+        bin_strpool_add(&pool, t->content_dyncb, &hdr.content_dyncb) ||
+        bin_strpool_add(&pool, t->content_style_dyncb, &hdr.content_style_dyncb) ||
+        bin_strpool_add(&pool, t->canvas_dyncb, &hdr.canvas_dyncb) ||
+        bin_strpool_add(&pool, t->post_dyncb, &hdr.post_dyncb))
+        goto bin_raise_oom_error;
+
+    for (size_t r = 0; r < t->rows; r++) {
+        for (size_t c = 0; c < t->cols; c++) {
+            hpdftbl_cell_t *cell = &t->cells[_HPDFTBL_IDX(r, c)];
+
+            if (cell->parent_cell == NULL && (cell->rowspan > 1 || cell->colspan > 1)) {
+                bin_span_t *span = &spans[hdr.num_spans++];
+                span->row = (uint32_t) r;
+                span->col = (uint32_t) c;
+                span->rowspan = (uint32_t) (cell->rowspan ? cell->rowspan : 1);
+                span->colspan = (uint32_t) (cell->colspan ? cell->colspan : 1);
+            }
+
+            const hpdf_text_style_t *cell_style = hpdftbl_cell_style(t, cell);
+            if (cell->label == NULL && cell->content == NULL && cell_style == NULL &&
+                cell->content_dyncb == NULL && cell->label_dyncb == NULL &&
+                cell->content_style_dyncb == NULL && cell->canvas_dyncb == NULL)
+                continue;
+
+            bin_cell_t *bc = &cells[hdr.num_cells++];
+            bc->row = (uint32_t) r;
+            bc->col = (uint32_t) c;
+            bc->style = BIN_NONE;
+            if (bin_strpool_add(&pool, cell->label, &bc->label) ||
+                bin_strpool_add(&pool, cell->content, &bc->content) ||
+                bin_strpool_add(&pool, cell->content_dyncb, &bc->content_dyncb) ||
+                bin_strpool_add(&pool, cell->label_dyncb, &bc->label_dyncb) ||
+                bin_strpool_add(&pool, cell->content_style_dyncb, &bc->content_style_dyncb) ||
+                bin_strpool_add(&pool, cell->canvas_dyncb, &bc->canvas_dyncb) ||
+                (cell_style && bin_styles_add(&styles, &pool, cell_style, &bc->style)))
+                goto bin_raise_oom_error;
+        }
+    }
+
+    hdr.num_styles = (uint32_t) styles.count;
+    hdr.str_size = (uint32_t) pool.size;
+
+    size_t off = BIN_ALIGN(sizeof hdr);
+    hdr.colw_off = (uint32_t) off;
+    off = BIN_ALIGN(off + t->cols * sizeof(float));
+    hdr.style_off = (uint32_t) off;
+    off = BIN_ALIGN(off + styles.count * sizeof(bin_style_t));
+    hdr.cell_off = (uint32_t) off;
+    off = BIN_ALIGN(off + hdr.num_cells * sizeof(bin_cell_t));
+    hdr.span_off = (uint32_t) off;
+    off = BIN_ALIGN(off + hdr.num_spans * sizeof(bin_span_t));
+    hdr.str_off = (uint32_t) off;
+    off = BIN_ALIGN(off + pool.size);
+    if (off >= BIN_NONE)
+        goto bin_raise_oom_error;
+    hdr.size = (uint32_t) off;
+
+    char *img = hpdftbl_calloc(off, sizeof(char));
+    if (img == NULL)
+        goto bin_raise_oom_error;
+
+    memcpy(img, &hdr, sizeof hdr);
+    for (size_t c = 0; c < t->cols; c++) {
+        const float w = t->col_width_percent ? t->col_width_percent[c] : 0.0f;
+        memcpy(img + hdr.colw_off + c * sizeof(float), &w, sizeof(float));
+    }
+    if (styles.count)
+        memcpy(img + hdr.style_off, styles.styles, styles.count * sizeof(bin_style_t));
+    if (hdr.num_cells)
+        memcpy(img + hdr.cell_off, cells, hdr.num_cells * sizeof(bin_cell_t));
+    if (hdr.num_spans)
+        memcpy(img + hdr.span_off, spans, hdr.num_spans * sizeof(bin_span_t));
+    if (pool.size)
+        memcpy(img + hdr.str_off, pool.buff, pool.size);
+
+    hpdftbl_free(cells);
+    hpdftbl_free(spans);
+    hpdftbl_free(styles.styles);
+    hpdftbl_free(pool.buff);
+    hpdftbl_free(pool.slots);
+
+    *buff = img;
+    *size = off;
+    return 0;
+
+    bin_raise_oom_error:
+    hpdftbl_free(cells);
+    hpdftbl_free(spans);
+    hpdftbl_free(styles.styles);
+    hpdftbl_free(pool.buff);
+    hpdftbl_free(pool.slots);
+    _HPDFTBL_SET_ERR(t, -5, -1, -1);
+    return -1;
+}
+
+/*-----------------------------------------------------------------------
+ * Load section.
+ */
+
+/**
+ * @brief Check that a section of an image is within the image and aligned
+ * @param hdr Image header
+ * @param off Offset to section
+ * @param count Number of records in section
+ * @param recsize Size of each record
+ * @return TRUE if section is valid, FALSE otherwise
+ */
+static _Bool
+bin_chk_section(const bin_header_t *hdr, uint32_t off, size_t count, size_t recsize) {
+    if (off % 4 || off < sizeof(bin_header_t) || off > hdr->size)
+        return FALSE;
+    return count <= (hdr->size - off) / recsize;
+}
+
+/**
+ * @brief Check that a string reference points within the string pool
+ * @param hdr Image header
+ * @param ref String reference
+ * @return TRUE if reference is valid, FALSE otherwise
+ */
+static _Bool
+bin_chk_str(const bin_header_t *hdr, uint32_t ref) {
+    return ref == BIN_NONE || ref < hdr->str_size;
+}
+
+/**
+ * @brief Validate that a buffer holds a complete and consistent binary table image.
+ *
+ * All offsets, counts, string references and style indexes are verified so that
+ * a corrupt image can never make the loader read outside the buffer.
+ *
+ * @param buff Buffer with binary image
+ * @param size Size of buffer
+ * @return TRUE if the image is valid, FALSE otherwise
+ */
+static _Bool
+bin_chk_image(const char *buff, size_t size) {
+    bin_header_t hdr;
+    if (buff == NULL || size < sizeof hdr)
+        return FALSE;
+    memcpy(&hdr, buff, sizeof hdr);
+
+    if (memcmp(hdr.magic, BIN_MAGIC, sizeof hdr.magic) || hdr.version != TABLE_BIN_VERSION ||
+        hdr.byte_order != BIN_BYTE_ORDER || hdr.size > size || hdr.rows == 0 || hdr.cols == 0)
+        return FALSE;
+
+    if (!bin_chk_section(&hdr, hdr.colw_off, hdr.cols, sizeof(float)) ||
+        !bin_chk_section(&hdr, hdr.style_off, hdr.num_styles, sizeof(bin_style_t)) ||
+        !bin_chk_section(&hdr, hdr.cell_off, hdr.num_cells, sizeof(bin_cell_t)) ||
+        !bin_chk_section(&hdr, hdr.span_off, hdr.num_spans, sizeof(bin_span_t)) ||
+        !bin_chk_section(&hdr, hdr.str_off, hdr.str_size, sizeof(char)))
+        return FALSE;
+
+    // The string pool must end with a NULL so that no string can run past the pool
+    if (hdr.str_size && buff[hdr.str_off + hdr.str_size - 1] != '\0')
+        return FALSE;
+
+    if (hdr.content_style >= hdr.num_styles || hdr.title_style >= hdr.num_styles ||
+        hdr.header_style >= hdr.num_styles || hdr.label_style >= hdr.num_styles)
+        return FALSE;
+
+    if (!bin_chk_str(&hdr, hdr.title_txt) || !bin_chk_str(&hdr, hdr.label_dyncb) ||
+        !bin_chk_str(&hdr, hdr.content_dyncb) || !bin_chk_str(&hdr, hdr.content_style_dyncb) ||
+        !bin_chk_str(&hdr, hdr.canvas_dyncb) || !bin_chk_str(&hdr, hdr.post_dyncb))
+        return FALSE;
+
+    const bin_style_t *styles = (const bin_style_t *) (buff + hdr.style_off);
+    for (size_t i = 0; i < hdr.num_styles; i++) {
+        if (!bin_chk_str(&hdr, styles[i].font))
+            return FALSE;
+    }
+
+    const bin_cell_t *cells = (const bin_cell_t *) (buff + hdr.cell_off);
+    for (size_t i = 0; i < hdr.num_cells; i++) {
+        const bin_cell_t *bc = &cells[i];
+        if (bc->row >= hdr.rows || bc->col >= hdr.cols ||
+            (bc->style != BIN_NONE && bc->style >= hdr.num_styles) ||
+            !bin_chk_str(&hdr, bc->label) || !bin_chk_str(&hdr, bc->content) ||
+            !bin_chk_str(&hdr, bc->content_dyncb) || !bin_chk_str(&hdr, bc->label_dyncb) ||
+            !bin_chk_str(&hdr, bc->content_style_dyncb) || !bin_chk_str(&hdr, bc->canvas_dyncb))
+            return FALSE;
+    }
+
+    const bin_span_t *spans = (const bin_span_t *) (buff + hdr.span_off);
+    for (size_t i = 0; i < hdr.num_spans; i++) {
+        const bin_span_t *s = &spans[i];
+        if (s->row >= hdr.rows || s->col >= hdr.cols || s->rowspan == 0 || s->colspan == 0 ||
+            s->rowspan > hdr.rows - s->row || s->colspan > hdr.cols - s->col)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Get a string from the string pool
+ * @param pool Start of string pool
+ * @param ref String reference
+ * @param in_place TRUE to reference the string in the pool, FALSE to duplicate it
+ * @param[out] dst Set to the string or NULL
+ * @return 0 on success, -1 on failure
+ */
+static int
+bin_strget(const char *pool, uint32_t ref, _Bool in_place, char **dst) {
+    if (ref == BIN_NONE) {
+        *dst = NULL;
+        return 0;
+    }
+    *dst = in_place ? (char *) (pool + ref) : hpdftbl_strdup(pool + ref);
+    return *dst ? 0 : -1;
+}
+
+/**
+ * @brief Copy a grid style from its serialized form
+ * @param dst Grid style
+ * @param src Serialized grid
+ */
+static void
+bin_grid_get(hpdftbl_grid_style_t *dst, const bin_grid_t *src) {
+    dst->width = src->width;
+    dst->color.r = src->color[0];
+    dst->color.g = src->color[1];
+    dst->color.b = src->color[2];
+    dst->line_dashstyle = (hpdftbl_line_dashstyle_t) src->dashstyle;
+}
+
+/**
+ * @brief Copy a text style from its serialized form
+ * @param dst Text style
+ * @param src Serialized style
+ * @param font Font name to use in the style
+ */
+static void
+bin_style_get(hpdf_text_style_t *dst, const bin_style_t *src, char *font) {
+    dst->font = font;
+    dst->fsize = src->fsize;
+    dst->color.r = src->color[0];
+    dst->color.g = src->color[1];
+    dst->color.b = src->color[2];
+    dst->background.r = src->background[0];
+    dst->background.g = src->background[1];
+    dst->background.b = src->background[2];
+    dst->halign = (hpdftbl_text_align_t) src->halign;
+}
+
+/**
+ * @brief Populate a table from a validated binary image
+ *
+ * @param t Table to read into
+ * @param buff Buffer with binary image which has been validated with bin_chk_image()
+ * @param in_place TRUE to let all strings reference the image directly, FALSE to copy them
+ * @return 0 on success, -1 on failure
+ */
+static int
+bin_load(hpdftbl_t t, const char *buff, _Bool in_place) {
+
+    bin_header_t hdr;
+    memcpy(&hdr, buff, sizeof hdr);
+    const char *pool = buff + hdr.str_off;
+    const bin_style_t *bstyles = (const bin_style_t *) (buff + hdr.style_off);
+    const bin_cell_t *bcells = (const bin_cell_t *) (buff + hdr.cell_off);
+    const bin_span_t *bspans = (const bin_span_t *) (buff + hdr.span_off);
+
+    if ((size_t) hdr.rows > SIZE_MAX / sizeof(hpdftbl_cell_t) / hdr.cols)
+        goto bin_raise_oom_error;
+
+    // Font names are shared between all cells using the same style
+    char **fonts = hpdftbl_calloc(hdr.num_styles, sizeof(char *));
+    t->cells = hpdftbl_calloc((size_t) hdr.rows * hdr.cols, sizeof(hpdftbl_cell_t));
+    t->col_width_percent = hpdftbl_calloc(hdr.cols, sizeof(float));
+    if ((hdr.num_styles && fonts == NULL) || t->cells == NULL || t->col_width_percent == NULL) {
+        hpdftbl_free(fonts);
+        goto bin_raise_oom_error;
+    }
+    t->rows = hdr.rows;
+    t->cols = hdr.cols;
+
+    for (size_t i = 0; i < hdr.num_styles; i++) {
+        if (bin_strget(pool, bstyles[i].font, in_place, &fonts[i])) {
+            hpdftbl_free(fonts);
+            goto bin_raise_oom_error;
+        }
+    }
+
+    hpdftbl_cell_t *cell = t->cells;
+    for (size_t r = 0; r < t->rows; r++) {
+        for (size_t c = 0; c < t->cols; c++) {
+            cell->row = r;
+            cell->col = c;
+            cell++;
+        }
+    }
+
+    memcpy(t->col_width_percent, buff + hdr.colw_off, hdr.cols * sizeof(float));
+
+    t->anchor_is_top_left = (hdr.flags & BIN_FLAG_ANCHOR_TOP_LEFT) != 0;
+    t->use_header_row = (hdr.flags & BIN_FLAG_USE_HEADER_ROW) != 0;
+    t->use_cell_labels = (hdr.flags & BIN_FLAG_USE_CELL_LABELS) != 0;
+    t->use_label_grid_style = (hdr.flags & BIN_FLAG_USE_LABEL_GRID) != 0;
+    t->use_zebra = (hdr.flags & BIN_FLAG_USE_ZEBRA) != 0;
+    t->zebra_phase = hdr.zebra_phase;
+    t->posx = hdr.posx;
+    t->posy = hdr.posy;
+    t->width = hdr.width;
+    t->height = hdr.height;
+    t->minrowheight = hdr.minrowheight;
+    t->bottom_vmargin_factor = hdr.bottom_vmargin_factor;
+    t->zebra_color1 = (HPDF_RGBColor) {hdr.zebra_color1[0], hdr.zebra_color1[1], hdr.zebra_color1[2]};
+    t->zebra_color2 = (HPDF_RGBColor) {hdr.zebra_color2[0], hdr.zebra_color2[1], hdr.zebra_color2[2]};
+    bin_grid_get(&t->outer_grid, &hdr.outer_grid);
+    bin_grid_get(&t->inner_vgrid, &hdr.inner_vgrid);
+    bin_grid_get(&t->inner_hgrid, &hdr.inner_hgrid);
+    bin_grid_get(&t->inner_tgrid, &hdr.inner_tgrid);
+    bin_style_get(&t->content_style, &bstyles[hdr.content_style], fonts[hdr.content_style]);
+    bin_style_get(&t->title_style, &bstyles[hdr.title_style], fonts[hdr.title_style]);
+    bin_style_get(&t->header_style, &bstyles[hdr.header_style], fonts[hdr.header_style]);
+    bin_style_get(&t->label_style, &bstyles[hdr.label_style], fonts[hdr.label_style]);
+
+    // Cells with the same style usually follow each other so remember the last style id
+    uint32_t last_style = BIN_NONE;
+    unsigned last_style_id = 0;
+    for (size_t i = 0; i < hdr.num_cells; i++) {
+        const bin_cell_t *bc = &bcells[i];
+        cell = &t->cells[_HPDFTBL_IDX((size_t) bc->row, (size_t) bc->col)];
+        if (bin_strget(pool, bc->label, in_place, &cell->label) ||
+            bin_strget(pool, bc->content, in_place, &cell->content)) {
+            hpdftbl_free(fonts);
+            goto bin_raise_oom_error;
+        }
+        if (bc->style != BIN_NONE) {
+            if (bc->style != last_style) {
+                hpdf_text_style_t cell_style;
+                bin_style_get(&cell_style, &bstyles[bc->style], fonts[bc->style]);
+                if (hpdftbl_intern_style(t, &cell_style, &last_style_id)) {
+                    hpdftbl_free(fonts);
+                    goto bin_raise_oom_error;
+                }
+                last_style = bc->style;
+            }
+            cell->style_id = last_style_id;
+        }
+    }
+    hpdftbl_free(fonts);
+
+    if (-1 == bin_strget(pool, hdr.title_txt, in_place, &t->title_txt))
+        goto bin_raise_oom_error;
+
+    for (size_t i = 0; i < hdr.num_spans; i++) {
+        if (hpdftbl_set_cellspan(t, bspans[i].row, bspans[i].col, bspans[i].rowspan, bspans[i].colspan))
+            return -1;
+    }
+
+    // Dynamic callbacks are resolved, and report their own errors, when they are set
+    int ret = 0;
+    if (hdr.label_dyncb != BIN_NONE)
+        ret |= hpdftbl_set_label_dyncb(t, pool + hdr.label_dyncb);
+    if (hdr.content_dyncb != BIN_NONE)
+        ret |= hpdftbl_set_content_dyncb(t, pool + hdr.content_dyncb);
+    if (hdr.content_style_dyncb != BIN_NONE)
+        ret |= hpdftbl_set_content_style_dyncb(t, pool + hdr.content_style_dyncb);
+    if (hdr.canvas_dyncb != BIN_NONE)
+        ret |= hpdftbl_set_canvas_dyncb(t, pool + hdr.canvas_dyncb);
+    if (hdr.post_dyncb != BIN_NONE)
+        ret |= hpdftbl_set_post_dyncb(t, pool + hdr.post_dyncb);
+
+    for (size_t i = 0; i < hdr.num_cells; i++) {
+        const bin_cell_t *bc = &bcells[i];
+        if (bc->content_dyncb != BIN_NONE)
+            ret |= hpdftbl_set_cell_content_dyncb(t, bc->row, bc->col, pool + bc->content_dyncb);
+        if (bc->label_dyncb != BIN_NONE)
+            ret |= hpdftbl_set_cell_label_dyncb(t, bc->row, bc->col, pool + bc->label_dyncb);
+        if (bc->content_style_dyncb != BIN_NONE)
+            ret |= hpdftbl_set_cell_content_style_dyncb(t, bc->row, bc->col, pool + bc->content_style_dyncb);
+        if (bc->canvas_dyncb != BIN_NONE)
+            ret |= hpdftbl_set_cell_canvas_dyncb(t, bc->row, bc->col, pool + bc->canvas_dyncb);
+    }
+
+    return ret ? -1 : 0;
+
+    bin_raise_oom_error:
+    _HPDFTBL_SET_ERR(t, -5, -1, -1);
+    return -1;
+}
+
+/**
+ * @brief Read back a table from a binary image created with hpdftbl_dumpb()
+ *
+ * The image is fully validated before the table is modified, a corrupt or truncated
+ * image will never cause a read outside the buffer. The table must be an empty (zeroed)
+ * table structure as the following example shows.
+ *
+ * *Example:*
+ * ```c
+ *  hpdftbl_t tbl = hpdftbl_calloc(1, sizeof (struct hpdftbl));
+ *  if( 0 == hpdftbl_loadb(tbl, buff, size) ) {
+ *       hpdftbl_stroke_pos(pdf_doc, pdf_page, tbl);
+ *  }
+ * ```
+ *
+ * All strings are copied so the buffer can be released as soon as this function
+ * returns. Text styles that are shared by several cells will also share the
+ * same copy of the font name. To use the strings in the image without copying
+ * them use hpdftbl_create_from_image() instead.
+ *
+ * @param tbl Table to read into
+ * @param buff Buffer with binary image. Must be aligned on a 4-byte boundary.
+ * @param size Size of buffer
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_dumpb(), hpdftbl_create_from_image()
+ */
+int
+hpdftbl_loadb(hpdftbl_t tbl, const char *buff, size_t size) {
+    hpdftbl_t t = tbl;
+    _HPDFTBL_CHK_TABLE(t);
+
+    if (!bin_chk_image(buff, size)) {
+        _HPDFTBL_SET_ERR(t, -15, -1, -1);
+        return -1;
+    }
+    return bin_load(t, buff, FALSE);
+}
+
+/**
+ * @brief Create a table that references a binary image in place.
+ *
+ * This is the zero-copy alternative to hpdftbl_loadb(). The cell labels and content,
+ * the title and all font names are not copied but point directly into the image, so
+ * the image must stay valid and unchanged for as long as the table exists.
+ * Only the cell array itself is allocated.
+ *
+ * Content that is set on the table after it has been created, for example with
+ * hpdftbl_set_cell(), is allocated as usual and overlays the content in the image
+ * without modifying it. This makes it possible to use one read-only image as a
+ * template for many tables.
+ *
+ * When the table is destroyed with hpdftbl_destroy() strings in the image are
+ * not freed and the image itself is left untouched.
+ *
+ * @param buff Buffer with binary image created with hpdftbl_dumpb(). Must be aligned
+ * on a 4-byte boundary.
+ * @param size Size of buffer
+ * @return A handle to the new table or NULL on failure
+ * @see hpdftbl_open_image(), hpdftbl_loadb(), hpdftbl_dumpb()
+ */
+hpdftbl_t
+hpdftbl_create_from_image(const char *buff, size_t size) {
+    if (!bin_chk_image(buff, size)) {
+        _HPDFTBL_SET_ERR(NULL, -15, -1, -1);
+        return NULL;
+    }
+
+    hpdftbl_t t = hpdftbl_calloc(1, sizeof(struct hpdftbl));
+    if (t == NULL) {
+        _HPDFTBL_SET_ERR(t, -5, -1, -1);
+        return NULL;
+    }
+    t->image = buff;
+    t->image_size = size;
+
+    if (bin_load(t, buff, TRUE)) {
+        hpdftbl_destroy(t);
+        return NULL;
+    }
+    return t;
+}
+
+/**
+ * @brief Create a table from a binary image file that is memory mapped in place.
+ *
+ * The file is mapped read-only with hpdftbl_map_file() and the table is created with
+ * hpdftbl_create_from_image(). Since the mapping is read-only and shared, many processes
+ * that use the same template file also share the same physical memory pages for it and the
+ * cost to set up a table is only the allocation of the cell array.
+ *
+ * The mapping is released when the table is destroyed with hpdftbl_destroy().
+ *
+ * *Example:*
+ * ```c
+ *  // Once
+ *  hpdftbl_dump_image(tbl, "template.tbl");
+ *
+ *  // For each render
+ *  hpdftbl_t tbl = hpdftbl_open_image("template.tbl");
+ *  if( tbl ) {
+ *       hpdftbl_set_cell(tbl, 1, 1, NULL, "Per render content");
+ *       hpdftbl_stroke_pos(pdf_doc, pdf_page, tbl);
+ *       hpdftbl_destroy(tbl);
+ *  }
+ * ```
+ *
+ * @param filename Binary image file created with hpdftbl_dump_image()
+ * @return A handle to the new table or NULL on failure
+ * @see hpdftbl_dump_image(), hpdftbl_create_from_image()
+ */
+hpdftbl_t
+hpdftbl_open_image(const char *filename) {
+    char *buff;
+    size_t size;
+
+    if (0 != hpdftbl_map_file(filename, &buff, &size))
+        return NULL;
+
+    hpdftbl_t t = hpdftbl_create_from_image(buff, size);
+    if (t == NULL) {
+        hpdftbl_unmap_file(buff, size);
+        return NULL;
+    }
+    t->image_mapped = TRUE;
+    return t;
+}
+
+/**
+ * @brief Serialize a table as a binary image to a named file.
+ *
+ * The file can be read back with hpdftbl_open_image().
+ *
+ * @param tbl Table handle
+ * @param filename Filename to write to. Any path specified must exists
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_open_image(), hpdftbl_dumpb()
+ */
+int
+hpdftbl_dump_image(hpdftbl_t tbl, const char *filename) {
+    char *buff;
+    size_t size;
+
+    if (0 != hpdftbl_dumpb(tbl, &buff, &size))
+        return -1;
+
+    FILE *fh = fopen(filename, "wb");
+    if (fh == NULL) {
+        hpdftbl_free(buff);
+        return -1;
+    }
+    const size_t written = fwrite(buff, sizeof(char), size, fh);
+    hpdftbl_free(buff);
+    return fclose(fh) == 0 && written == size ? 0 : -1;
+}
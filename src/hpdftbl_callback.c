@@ -299,7 +299,7 @@ hpdftbl_set_content_dyncb(hpdftbl_t t, const char *cb_name) {
         _HPDFTBL_SET_ERR(t, -14, -1, -1);
         return -1;
     }
-    t->content_dyncb = strdup(cb_name);
+    t->content_dyncb = hpdftbl_strdup(cb_name);
     hpdftbl_set_content_cb(t, dyn_content_cb);
     return 0;
 }
@@ -340,7 +340,7 @@ hpdftbl_set_canvas_dyncb(hpdftbl_t t, const char *cb_name) {
         _HPDFTBL_SET_ERR(t, -14, -1, -1);
         return -1;
     }
-    t->canvas_dyncb = strdup(cb_name);
+    t->canvas_dyncb = hpdftbl_strdup(cb_name);
     hpdftbl_set_canvas_cb(t, dyn_canvas_cb);
     return 0;
 }
@@ -384,7 +384,7 @@ hpdftbl_set_label_dyncb(hpdftbl_t t, const char *cb_name) {
         _HPDFTBL_SET_ERR(t, -14, -1, -1);
         return -1;
     }
-    t->label_dyncb = strdup(cb_name);
+    t->label_dyncb = hpdftbl_strdup(cb_name);
     hpdftbl_set_label_cb(t, dyn_labels_cb);
     return 0;
 }
@@ -429,7 +429,7 @@ hpdftbl_set_cell_label_dyncb(hpdftbl_t t, size_t r, size_t c, const char *cb_nam
         _HPDFTBL_SET_ERR(t, -14, -1, -1);
         return -1;
     }
-    t->cells[_HPDFTBL_IDX(r,c)].label_dyncb = strdup(cb_name);
+    t->cells[_HPDFTBL_IDX(r,c)].label_dyncb = hpdftbl_strdup(cb_name);
     hpdftbl_set_cell_label_cb(t, r, c,dyn_labels_cb);
     return 0;
 }
@@ -473,7 +473,7 @@ hpdftbl_set_content_style_dyncb(hpdftbl_t t, const char *cb_name) {
         _HPDFTBL_SET_ERR(t, -14, -1, -1);
         return -1;
     }
-    t->content_style_dyncb = strdup(cb_name);
+    t->content_style_dyncb = hpdftbl_strdup(cb_name);
     hpdftbl_set_content_style_cb(t, dyn_style_cb);
     return 0;
 }
@@ -521,7 +521,7 @@ hpdftbl_set_cell_content_style_dyncb(hpdftbl_t t, size_t r, size_t c, const char
         _HPDFTBL_SET_ERR(t, -14, -1, -1);
         return -1;
     }
-    t->cells[_HPDFTBL_IDX(r,c)].content_style_dyncb = strdup(cb_name);
+    t->cells[_HPDFTBL_IDX(r,c)].content_style_dyncb = hpdftbl_strdup(cb_name);
     hpdftbl_set_cell_content_style_cb(t, r, c,dyn_style_cb);
     return 0;
 }
@@ -565,7 +565,7 @@ hpdftbl_set_cell_content_dyncb(hpdftbl_t t, size_t r, size_t c, const char *cb_n
         _HPDFTBL_SET_ERR(t, -14, -1, -1);
         return -1;
     }
-    t->cells[_HPDFTBL_IDX(r,c)].content_dyncb = strdup(cb_name);
+    t->cells[_HPDFTBL_IDX(r,c)].content_dyncb = hpdftbl_strdup(cb_name);
     hpdftbl_set_cell_content_cb(t, r, c, dyn_content_cb);
     return 0;
 }
@@ -605,7 +605,7 @@ hpdftbl_set_cell_canvas_dyncb(hpdftbl_t t, size_t r, size_t c, const char *cb_na
         _HPDFTBL_SET_ERR(t, -14, -1, -1);
         return -1;
     }
-    t->cells[_HPDFTBL_IDX(r,c)].canvas_dyncb = strdup(cb_name);
+    t->cells[_HPDFTBL_IDX(r,c)].canvas_dyncb = hpdftbl_strdup(cb_name);
     hpdftbl_set_cell_canvas_cb(t, r, c, dyn_canvas_cb);
     return 0;
 }
@@ -642,7 +642,7 @@ hpdftbl_set_post_dyncb(hpdftbl_t t, const char *cb_name) {
         _HPDFTBL_SET_ERR(t, -14, -1, -1);
         return -1;
     }
-    t->post_dyncb = strdup(cb_name);
+    t->post_dyncb = hpdftbl_strdup(cb_name);
     hpdftbl_set_post_cb(t, dyn_post_cb);
     return 0;
 }
@@ -680,6 +680,12 @@ hpdftbl_set_cell_content_style_cb(hpdftbl_t t, size_t r, size_t c, hpdftbl_conte
  *
  * Set callback to format the style for cells in the table. If a cell has its own content style
  * callback that callback will override the generic table callback.
+ *
+ * The callback is called once for each cell, apart from the header row, when the table is
+ * stroked. The content of the cell has then already been resolved, including any content
+ * callback, and is passed to the callback. The style returned is used both for the cell
+ * background and for the text. If the callback returns FALSE the cell is styled as if
+ * there were no callback.
  * @param t Table handle
  * @param cb Callback function
  * @return 0 on success, -1 on failure
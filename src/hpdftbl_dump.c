@@ -30,6 +30,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
 #include <string.h>
 
 #if !(defined _WIN32 || defined __WIN32__)
@@ -110,12 +111,12 @@ hpdftbl_theme_dump(hpdftbl_theme_t *theme, char *filename) {
     if (!fh)
         return -1;
 
-    // 2k buffer is adequate for a theme
-    const size_t buffsize = 2 * 1024;
-    char *s = calloc(buffsize, sizeof(char));
+    // 2k buffer is adequate for a theme and each rule needs less than 512 bytes
+    const size_t buffsize = 2 * 1024 + theme->num_rules * 512;
+    char *s = hpdftbl_calloc(buffsize, sizeof(char));
     int ret = hpdftbl_theme_dumps(theme, s, buffsize);
     fprintf(fh, "%s\n", s);
-    free(s);
+    hpdftbl_free(s);
     fclose(fh);
     return !ret ? 0 : -1;
 }
@@ -127,7 +128,8 @@ hpdftbl_theme_dump(hpdftbl_theme_t *theme, char *filename) {
  * newlines to make it more human readable.
  *
  * @param theme Theme to serialize
- * @param buff Buffer to write serialized theme to. It should be a minimum of 2k chars.
+ * @param buff Buffer to write serialized theme to. It should be a minimum of 2k chars
+ * plus 512 chars for each conditional formatting rule.
  * @param buffsize Buffer size (including ending string NULL)
  * @return 0 on success, < 0 on failure
  */
@@ -165,7 +167,29 @@ hpdftbl_theme_dumps(hpdftbl_theme_t *theme, char *buff, const size_t buffsize) {
     OUTJSON_STRINT("zebra_phase", theme->zebra_phase, ',');
     OUTJSON_RGB("zebra_color1", theme->zebra_color1);
     OUTJSON_RGB("zebra_color2", theme->zebra_color2);
-    OUTJSON_STRREAL("bottom_vmargin_factor", theme->bottom_vmargin_factor, ' ');
+    OUTJSON_STRREAL("bottom_vmargin_factor", theme->bottom_vmargin_factor, theme->num_rules > 0 ? ',' : ' ');
+
+    // The conditional formatting rules are only written if there are any
+    if (theme->num_rules > 0) {
+        OUTJSON_STRLIST("rules");
+        tab += 2;
+        for (size_t i = 0; i < theme->num_rules; i++) {
+            const hpdftbl_rule_t *rule = &theme->rules[i];
+            OUTJSON_STARTBLK();
+            tab += 2;
+            OUTJSON_STRINT("col", rule->col, ',');
+            OUTJSON_STRINT("op", rule->op, ',');
+            OUTJSON_STRREAL("value", rule->value, ',');
+            OUTJSON_STRREAL("value2", rule->value2, ',');
+            OUTJSON_STRSTR("str", rule->str);
+            OUTJSON_STRINT("apply", rule->apply, ',');
+            OUTJSON_TXTSTYLE("style", rule->style, ' ');
+            tab -= 2;
+            OUTJSON_ENDBLK(i == theme->num_rules - 1 ? ' ' : ',');
+        }
+        tab -= 2;
+        OUTJSON_ENDLIST(' ');
+    }
 
     tab -= 2;
     OUTJSON_ENDBLK(' ');
@@ -193,10 +217,10 @@ hpdftbl_dump(hpdftbl_t tbl, char *filename) {
         return -1;
 
     const size_t buffsize = 100 * 1024;
-    char *s = calloc(buffsize, sizeof(char));
+    char *s = hpdftbl_calloc(buffsize, sizeof(char));
     int ret = hpdftbl_dumps(tbl, s, buffsize);
     fprintf(fh, "%s\n", s);
-    free(s);
+    hpdftbl_free(s);
     fclose(fh);
     return !ret ? 0 : -1;
 }
@@ -224,6 +248,7 @@ hpdftbl_dumps(hpdftbl_t tbl, char *buff, size_t buffsize) {
     FILE *fh = NULL;
     const size_t _jsonbuff_size_ = buffsize;
 
+    hpdftbl_resolve_theme(tbl);
     OUTJSON_NEWBLK();
     OUTJSON_STRINT("version", TABLE_JSON_VERSION, ',');
     OUTJSON_STRBLK("table");
@@ -303,7 +328,14 @@ hpdftbl_dumps(hpdftbl_t tbl, char *buff, size_t buffsize) {
                 tab -= 2;
                 OUTJSON_ENDBLK(',');
             }
-            OUTJSON_TXTSTYLE("content_style", cell->content_style, ' ');
+            // A cell without its own style is written as an empty style
+            const hpdf_text_style_t *own_style = hpdftbl_cell_style(tbl, cell);
+            hpdf_text_style_t cell_style;
+            if (own_style)
+                cell_style = *own_style;
+            else
+                memset(&cell_style, 0, sizeof cell_style);
+            OUTJSON_TXTSTYLE("content_style", cell_style, ' ');
             tab -= 2;
             if (r == tbl->rows - 1 && c == tbl->cols - 1)
                 OUTJSON_ENDBLK(' ');
@@ -320,6 +352,358 @@ hpdftbl_dumps(hpdftbl_t tbl, char *buff, size_t buffsize) {
 }
 
 
+/*-----------------------------------------------------------------------
+ * Compact dump section.
+ *
+ * The compact format is the same JSON structure as written by hpdftbl_dumps()
+ * but without any whitespace and with all fields that have their default value
+ * left out. The loader falls back to the default value for fields that are not
+ * present.
+ */
+
+/**
+ * @brief Output state for the compact JSON writer
+ */
+typedef struct json_out {
+    FILE *fh;           /**< File to write to, if NULL the output goes to the buffer */
+    char *buff;         /**< Buffer to write to */
+    size_t size;        /**< Size of buffer */
+    size_t len;         /**< Current length of output in buffer */
+    _Bool first;        /**< TRUE if the next element is the first in the current block */
+    _Bool overflow;     /**< TRUE if the output didn't fit in the buffer */
+} json_out_t;
+
+/**
+ * @brief Print formatted output to file or buffer
+ * @param o Output state
+ * @param fmt Format string
+ * @param ... Arguments
+ */
+static void
+jout(json_out_t *o, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    if (o->fh) {
+        vfprintf(o->fh, fmt, ap);
+    } else if (!o->overflow) {
+        const int n = vsnprintf(o->buff + o->len, o->size - o->len, fmt, ap);
+        if (n < 0 || (size_t) n >= o->size - o->len)
+            o->overflow = TRUE;
+        else
+            o->len += (size_t) n;
+    }
+    va_end(ap);
+}
+
+/**
+ * @brief Output a key, preceded by a comma unless it is the first element in the block
+ * @param o Output state
+ * @param k Key
+ */
+static void
+jkey(json_out_t *o, const char *k) {
+    jout(o, "%s\"%s\":", o->first ? "" : ",", k);
+    o->first = FALSE;
+}
+
+/**
+ * @brief Start a new object or list
+ * @param o Output state
+ * @param k Key of the block or NULL if the block is an element in a list
+ * @param c Opening character, '{' or '['
+ */
+static void
+jopen(json_out_t *o, const char *k, char c) {
+    if (k)
+        jkey(o, k);
+    else if (!o->first)
+        jout(o, ",");
+    jout(o, "%c", c);
+    o->first = TRUE;
+}
+
+/**
+ * @brief End an object or list
+ * @param o Output state
+ * @param c Closing character, '}' or ']'
+ */
+static void
+jclose(json_out_t *o, char c) {
+    jout(o, "%c", c);
+    o->first = FALSE;
+}
+
+static void
+jstr(json_out_t *o, const char *k, const char *v) {
+    jkey(o, k);
+    jout(o, "\"%s\"", v ? v : "");
+}
+
+static void
+jint(json_out_t *o, const char *k, int v) {
+    jkey(o, k);
+    jout(o, "%d", v);
+}
+
+static void
+jreal(json_out_t *o, const char *k, double v) {
+    jkey(o, k);
+    jout(o, "%.9g", v);
+}
+
+static void
+jbool(json_out_t *o, const char *k, _Bool v) {
+    jkey(o, k);
+    jout(o, "%s", v ? "true" : "false");
+}
+
+static void
+jrgb(json_out_t *o, const char *k, HPDF_RGBColor v) {
+    jkey(o, k);
+    jout(o, "[%.6g,%.6g,%.6g]", v.r, v.g, v.b);
+}
+
+static void
+jtxtstyle(json_out_t *o, const char *k, const hpdf_text_style_t *v) {
+    jopen(o, k, '{');
+    if (v->font)
+        jstr(o, "font", v->font);
+    jreal(o, "fsize", v->fsize);
+    jrgb(o, "color", v->color);
+    jrgb(o, "background", v->background);
+    jint(o, "halign", v->halign);
+    jclose(o, '}');
+}
+
+static void
+jgrid(json_out_t *o, const char *k, hpdftbl_grid_style_t *v) {
+    jopen(o, k, '{');
+    jreal(o, "width", v->width);
+    jrgb(o, "color", v->color);
+    jint(o, "dashstyle", v->line_dashstyle);
+    jclose(o, '}');
+}
+
+static _Bool
+rgb_eq(HPDF_RGBColor a, HPDF_RGBColor b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+static _Bool
+txtstyle_eq(const hpdf_text_style_t *a, const hpdf_text_style_t *b) {
+    const _Bool font_eq = (a->font == NULL || b->font == NULL) ? a->font == b->font : 0 == strcmp(a->font, b->font);
+    return font_eq && a->fsize == b->fsize && rgb_eq(a->color, b->color) &&
+           rgb_eq(a->background, b->background) && a->halign == b->halign;
+}
+
+static _Bool
+grid_eq(const hpdftbl_grid_style_t *a, const hpdftbl_grid_style_t *b) {
+    return a->width == b->width && rgb_eq(a->color, b->color) && a->line_dashstyle == b->line_dashstyle;
+}
+
+/**
+ * @brief Write the compact serialization of a table
+ *
+ * The default values are the values of a table created by hpdftbl_create(). A cell
+ * is only written if it has any non default field. The geometry of the cells is
+ * never written since it is always calculated when the table is stroked.
+ *
+ * @param tbl Table to serialize
+ * @param o Output state
+ * @return 0 on success, -1 on failure
+ */
+static int
+table_dump_compact(hpdftbl_t tbl, json_out_t *o) {
+    const hpdftbl_theme_t *theme = hpdftbl_get_builtin_theme(THEME_DEFAULT);
+
+    hpdftbl_resolve_theme(tbl);
+    o->first = TRUE;
+    jopen(o, NULL, '{');
+    jint(o, "version", TABLE_JSON_VERSION);
+    jopen(o, "table", '{');
+    if (tbl->tag)
+        jstr(o, "tag", (char *) tbl->tag);
+    jint(o, "rows", (int) tbl->rows);
+    jint(o, "cols", (int) tbl->cols);
+    if (tbl->posx != 0)
+        jreal(o, "posx", tbl->posx);
+    if (tbl->posy != 0)
+        jreal(o, "posy", tbl->posy);
+    if (tbl->height != 0)
+        jreal(o, "height", tbl->height);
+    if (tbl->minrowheight != 0)
+        jreal(o, "minrowheight", tbl->minrowheight);
+    if (tbl->width != 0)
+        jreal(o, "width", tbl->width);
+    if (tbl->bottom_vmargin_factor != theme->bottom_vmargin_factor)
+        jreal(o, "bottom_vmargin_factor", tbl->bottom_vmargin_factor);
+    if (tbl->title_txt)
+        jstr(o, "title_txt", tbl->title_txt);
+    if (!tbl->anchor_is_top_left)
+        jbool(o, "anchor_is_top_left", FALSE);
+    if (tbl->use_header_row)
+        jbool(o, "use_header_row", TRUE);
+    if (tbl->use_cell_labels)
+        jbool(o, "use_cell_labels", TRUE);
+    if (tbl->use_label_grid_style)
+        jbool(o, "use_label_grid_style", TRUE);
+    if (tbl->use_zebra)
+        jbool(o, "use_zebra", TRUE);
+    if (tbl->zebra_phase)
+        jint(o, "zebra_phase", tbl->zebra_phase);
+    if (!rgb_eq(tbl->zebra_color1, theme->zebra_color1))
+        jrgb(o, "zebra_color1", tbl->zebra_color1);
+    if (!rgb_eq(tbl->zebra_color2, theme->zebra_color2))
+        jrgb(o, "zebra_color2", tbl->zebra_color2);
+
+    if (!grid_eq(&tbl->outer_grid, &theme->outer_border))
+        jgrid(o, "outer_grid", &tbl->outer_grid);
+    if (!grid_eq(&tbl->inner_vgrid, &theme->inner_vborder))
+        jgrid(o, "inner_vgrid", &tbl->inner_vgrid);
+    if (!grid_eq(&tbl->inner_hgrid, &theme->inner_hborder))
+        jgrid(o, "inner_hgrid", &tbl->inner_hgrid);
+    if (!grid_eq(&tbl->inner_tgrid, &theme->inner_tborder))
+        jgrid(o, "inner_tgrid", &tbl->inner_tgrid);
+
+    if (!txtstyle_eq(&tbl->content_style, &theme->content_style))
+        jtxtstyle(o, "content_style", &tbl->content_style);
+    if (!txtstyle_eq(&tbl->title_style, &theme->title_style))
+        jtxtstyle(o, "title_style", &tbl->title_style);
+    if (!txtstyle_eq(&tbl->header_style, &theme->header_style))
+        jtxtstyle(o, "header_style", &tbl->header_style);
+    if (!txtstyle_eq(&tbl->label_style, &theme->label_style))
+        jtxtstyle(o, "label_style", &tbl->label_style);
+
+    _Bool use_colwidth = FALSE;
+    for (size_t i = 0; i < tbl->cols; i++) {
+        use_colwidth |= tbl->col_width_percent[i] != 0;
+    }
+    if (use_colwidth) {
+        jopen(o, "col_width_percent", '[');
+        for (size_t i = 0; i < tbl->cols; i++) {
+            jout(o, "%s%.9g", i ? "," : "", tbl->col_width_percent[i]);
+        }
+        jclose(o, ']');
+    }
+
+    if (tbl->label_dyncb)
+        jstr(o, "label_dyncb", tbl->label_dyncb);
+    if (tbl->content_dyncb)
+        jstr(o, "content_dyncb", tbl->content_dyncb);
+    if (tbl->content_style_dyncb)
+        jstr(o, "content_style_dyncb", tbl->content_style_dyncb);
+    if (tbl->canvas_dyncb)
+        jstr(o, "canvas_dyncb", tbl->canvas_dyncb);
+    if (tbl->post_dyncb)
+        jstr(o, "post_dyncb", tbl->post_dyncb);
+
+    // Each distinct cell style is written once and the cells refer to it by index
+    if (tbl->num_styles) {
+        jopen(o, "styles", '[');
+        for (size_t i = 0; i < tbl->num_styles; i++)
+            jtxtstyle(o, NULL, &tbl->styles[i]);
+        jclose(o, ']');
+    }
+
+    // The cells must be the last member to allow streaming load
+    jopen(o, "cells", '[');
+    hpdftbl_cell_t *cell = tbl->cells;
+    for (size_t i = 0; i < tbl->rows * tbl->cols; i++, cell++) {
+        const hpdf_text_style_t *cell_style = hpdftbl_cell_style(tbl, cell);
+        const _Bool own_style = cell_style != NULL && !txtstyle_eq(cell_style, &tbl->content_style);
+        if (cell->label == NULL && cell->content == NULL && cell->rowspan <= 1 && cell->colspan <= 1 &&
+            cell->parent_cell == NULL && !own_style && cell->content_dyncb == NULL && cell->label_dyncb == NULL &&
+            cell->content_style_dyncb == NULL && cell->canvas_dyncb == NULL)
+            continue;
+
+        jopen(o, NULL, '{');
+        jint(o, "row", (int) cell->row);
+        jint(o, "col", (int) cell->col);
+        if (cell->label)
+            jstr(o, "label", cell->label);
+        if (cell->content)
+            jstr(o, "content", cell->content);
+        if (cell->colspan > 1)
+            jint(o, "colspan", (int) cell->colspan);
+        if (cell->rowspan > 1)
+            jint(o, "rowspan", (int) cell->rowspan);
+        if (cell->content_dyncb)
+            jstr(o, "content_dyncb", cell->content_dyncb);
+        if (cell->label_dyncb)
+            jstr(o, "label_dyncb", cell->label_dyncb);
+        if (cell->content_style_dyncb)
+            jstr(o, "content_style_dyncb", cell->content_style_dyncb);
+        if (cell->canvas_dyncb)
+            jstr(o, "canvas_dyncb", cell->canvas_dyncb);
+        if (cell->parent_cell != NULL) {
+            jopen(o, "parent", '{');
+            jint(o, "row", (int) cell->parent_cell->row);
+            jint(o, "col", (int) cell->parent_cell->col);
+            jclose(o, '}');
+        }
+        if (own_style)
+            jint(o, "style", (int) cell->style_id - 1);
+        jclose(o, '}');
+    }
+    jclose(o, ']');
+    jclose(o, '}');
+    jclose(o, '}');
+
+    return o->overflow ? -1 : 0;
+}
+
+/**
+ * @brief Serialize a table structure to a string buffer in compact format
+ *
+ * The compact format is a minified version of the format written by hpdftbl_dumps().
+ * It has no whitespaces and all fields that have the same value as in a newly created
+ * table are left out. Only cells that have a label, content, span, own style or dynamic
+ * callback are written and the cell geometry is never written since it is always
+ * recalculated when the table is stroked. A table written in compact format is read
+ * back with hpdftbl_loads() or hpdftbl_stream_loads().
+ *
+ * @param tbl Table handle of table to dump
+ * @param buff Buffer to dump structure to
+ * @param buffsize  Size of buffer
+ * @return -1 on failure (including a too small buffer), 0 on success
+ * @see hpdftbl_dump_compact(), hpdftbl_dumps()
+ */
+int
+hpdftbl_dumps_compact(hpdftbl_t tbl, char *buff, size_t buffsize) {
+    _HPDFTBL_CHK_TABLE(tbl);
+    if (buff == NULL || buffsize == 0)
+        return -1;
+    json_out_t o = {NULL, buff, buffsize, 0, TRUE, FALSE};
+    buff[0] = '\0';
+    return table_dump_compact(tbl, &o);
+}
+
+/**
+ * @brief Serialize a table structure as a JSON file in compact format.
+ *
+ * The table is written directly to the file so there is no limit on the size of the table.
+ *
+ * @param tbl Table handle
+ * @param filename Filename to write to. Any path specified must exists
+ * @return -1 on failure, 0 on success
+ * @see hpdftbl_dumps_compact(), hpdftbl_dump()
+ */
+int
+hpdftbl_dump_compact(hpdftbl_t tbl, char *filename) {
+    _HPDFTBL_CHK_TABLE(tbl);
+    FILE *fh = fopen(filename, "w");
+    if (!fh)
+        return -1;
+
+    json_out_t o = {fh, NULL, 0, 0, TRUE, FALSE};
+    int ret = table_dump_compact(tbl, &o);
+    fprintf(fh, "\n");
+    if (fclose(fh))
+        ret = -1;
+    return ret;
+}
+
+
 #ifndef _MSC_VER
 #pragma GCC diagnostic pop
 #endif
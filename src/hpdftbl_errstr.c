@@ -35,6 +35,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <hpdf.h>
 #include "hpdftbl.h"
 
@@ -64,7 +65,11 @@ static char *error_descriptions[] = {
         "Internal error. Unknown error code",           /* 11  */
         "Total column width exceeds 100%",              /* 12  */
         "Calculated width of columns too small",        /* 13  */
-        "Dynamic callback not located"                  /* 14  */
+        "Dynamic callback not located",                 /* 14  */
+        "Invalid or corrupt binary table image",        /* 15  */
+        "Table layout has not been calculated",         /* 16  */
+        "Cannot create PDF form object",                /* 17  */
+        "Invalid argument"                              /* 18  */
 };
 
 
@@ -77,23 +82,28 @@ static const size_t NUM_ERR_MSG = sizeof(error_descriptions) / sizeof(char *);
 #define ERR_UNKNOWN 11
 
 
+/*
+ * The error state is thread local so an error is only seen by the
+ * thread where it occurred, see HPDFTBL_THREAD_LOCAL.
+ */
+
 /** @brief Stores the last generated error code. */
-int hpdftbl_err_code = 0;
+HPDFTBL_THREAD_LOCAL int hpdftbl_err_code = 0;
 
 /** @brief The row where the last error was generated.  */
-int hpdftbl_err_row = -1;
+HPDFTBL_THREAD_LOCAL int hpdftbl_err_row = -1;
 
 /** @brief The column where the last error was generated.  */
-int hpdftbl_err_col = -1;
+HPDFTBL_THREAD_LOCAL int hpdftbl_err_col = -1;
 
 /** @brief Hold the line number of the last error occurred */
-int hpdftbl_err_lineno = 0;
+HPDFTBL_THREAD_LOCAL int hpdftbl_err_lineno = 0;
 
 /** @brief Hold the file name where the last error occurred */
-char *hpdftbl_err_file = NULL;
+HPDFTBL_THREAD_LOCAL char *hpdftbl_err_file = NULL;
 
 /** @brief Extra info that may be specified at the point of error */
-char hpdftbl_err_extrainfo[1024] = {0};
+HPDFTBL_THREAD_LOCAL char hpdftbl_err_extrainfo[HPDFTBL_ERR_EXTRAINFO_SIZE] = {0};
 
 
 
@@ -255,7 +265,7 @@ hpdftbl_hpdf_get_errstr(const HPDF_STATUS err_code) {
 const char *
 hpdftbl_get_errstr(int err) {
     if (err < 0) {
-        if (((size_t) (-hpdftbl_err_code) < NUM_ERR_MSG))
+        if (((size_t) (-err) < NUM_ERR_MSG))
             return error_descriptions[-err];
         else
             return NULL;
@@ -305,6 +315,8 @@ hpdftbl_default_table_error_handler(hpdftbl_t t, int r, int c, int err) {
  * readable string describing the error will be copied to
  * the string.
  * The error code will be reset after call.
+ * The error state is per thread so this is the last error
+ * in the calling thread.
  *
  * @param errstr A string buffer where the error string
  * is written to
@@ -337,6 +349,9 @@ hpdftbl_get_last_errcode(const char **errstr, int *row, int *col) {
 /**
  * @brief Get the filename and line number where the last error occurred.
  *
+ * As for hpdftbl_get_last_errcode() this is the last error in the calling thread
+ * and the extra info string is only valid in the calling thread.
+ *
  * @param lineno Set to the line number where the error occurred
  * @param file Set to the file where the error occurred
  * @param extrainfo Extra info string that may be set at the point of error
@@ -353,6 +368,9 @@ hpdftbl_get_last_err_file(int *lineno, char **file, char **extrainfo) {
  *
  * Note: The library provides a basic default error handler that can be used,
  *
+ * The error handler is called in the thread where the error occurred. The handler itself
+ * is shared by all threads and should be set before tables are used in several threads.
+ *
  * @param err_handler
  * @return The old error handler or NULL if non exists
  * @see hpdftbl_default_table_error_handler()
@@ -363,3 +381,117 @@ hpdftbl_set_errhandler(hpdftbl_error_handler_t err_handler) {
     hpdftbl_err_handler = err_handler;
     return old_err_handler;
 }
+
+/**
+ * @brief Set if errors in a table should be collected instead of handled by the error handler
+ *
+ * When errors are collected an error in the table, for example a cell out of range or
+ * a failed memory allocation while stroking a cell, is added to the list of errors in
+ * the table instead of calling the error handler. The function that discovered the error
+ * still returns an error code. This means that a long-running program never has its
+ * process ended, or the stack unwound with `longjmp()`, because of an error in one table.
+ *
+ * While errors are collected the table is stroked as far as possible. HPDF errors that
+ * occur while a cell is stroked are collected with the row and column of the cell and
+ * the HPDF error state is reset so that the rest of the table is still stroked. For this
+ * to work the document must not have an HPDF error handler that terminates the process
+ * or does a `longjmp()`. The stroke functions return -1 if any error was collected
+ * during the stroke.
+ *
+ * @param t Table handle
+ * @param collect TRUE to collect errors, FALSE to use the error handler
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_get_errors(), hpdftbl_clear_errors()
+ */
+int
+hpdftbl_set_collect_errors(hpdftbl_t t, _Bool collect) {
+    _HPDFTBL_CHK_TABLE(t);
+    t->collect_errors = collect;
+    return 0;
+}
+
+/**
+ * @brief Get the errors collected in a table
+ *
+ * @code
+ * const hpdftbl_error_t *errors;
+ * size_t n = hpdftbl_get_errors(tbl, &errors);
+ * for (size_t i = 0; i < n; i++) {
+ *     fprintf(stderr, "[%d] %s at cell (%d, %d)\n", errors[i].code,
+ *             hpdftbl_get_errstr(errors[i].code), errors[i].row, errors[i].col);
+ * }
+ * @endcode
+ *
+ * @param t Table handle
+ * @param[out] errors Set to the array of collected errors. The array is owned by the table and
+ * is valid until the next error is collected or the errors are cleared.
+ * @return The number of collected errors
+ * @see hpdftbl_set_collect_errors(), hpdftbl_clear_errors()
+ */
+size_t
+hpdftbl_get_errors(hpdftbl_t t, const hpdftbl_error_t **errors) {
+    if (NULL == t || NULL == errors)
+        return 0;
+    *errors = t->errors;
+    return t->num_errors;
+}
+
+/**
+ * @brief Remove all collected errors from a table
+ *
+ * @param t Table handle
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_get_errors()
+ */
+int
+hpdftbl_clear_errors(hpdftbl_t t) {
+    _HPDFTBL_CHK_TABLE(t);
+    hpdftbl_free(t->errors);
+    t->errors = NULL;
+    t->num_errors = 0;
+    t->errors_size = 0;
+    return 0;
+}
+
+/**
+ * @brief Internal function. Add an error to the list of errors in a table.
+ *
+ * This is called for every error by _HPDFTBL_SET_ERR(). If there is no memory left
+ * the error is dropped but it is still not passed on to the error handler.
+ *
+ * @param t Table handle, may be NULL
+ * @param err Error code
+ * @param r Row
+ * @param c Column
+ * @param lineno Line number where the error was discovered
+ * @param file File where the error was discovered
+ * @return TRUE if the table collects errors, FALSE if the error should be handled
+ * by the error handler
+ * @see hpdftbl_set_collect_errors()
+ */
+_Bool
+hpdftbl_collect_error(hpdftbl_t t, int err, int r, int c, int lineno, const char *file) {
+    if (NULL == t || !t->collect_errors)
+        return FALSE;
+
+    if (t->num_errors == t->errors_size) {
+        const size_t new_size = t->errors_size ? 2 * t->errors_size : 8;
+#ifdef __cplusplus
+        hpdftbl_error_t *errors = static_cast<hpdftbl_error_t *>(hpdftbl_realloc(t->errors, new_size * sizeof(hpdftbl_error_t)));
+#else
+        hpdftbl_error_t *errors = hpdftbl_realloc(t->errors, new_size * sizeof(hpdftbl_error_t));
+#endif
+        if (NULL == errors)
+            return TRUE;
+        t->errors = errors;
+        t->errors_size = new_size;
+    }
+
+    hpdftbl_error_t *e = &t->errors[t->num_errors++];
+    e->code = err;
+    e->row = r;
+    e->col = c;
+    e->lineno = lineno;
+    e->file = file;
+    return TRUE;
+}
@@ -0,0 +1,336 @@
+/**
+ * @file
+ * @brief   Flow layout of several tables over one or more pages
+ * @author   Johan Persson (johan162@gmail.com)
+ *
+ * Copyright (C) 2022 Johan Persson
+ *
+ * @see LICENSE
+ *
+ * Released under the MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <hpdf.h>
+#include "hpdftbl.h"
+
+/**
+ * @brief Internal function. Add a new page to the flow.
+ *
+ * @param flow Flow handle
+ * @return 0 on success, -1 on failure
+ */
+static int
+flow_add_page(hpdftbl_flow_t flow) {
+    HPDF_Page page;
+    if (flow->new_page_cb) {
+        page = flow->new_page_cb(flow->pdf_doc);
+    } else {
+        page = HPDF_AddPage(flow->pdf_doc);
+        if (page)
+            HPDF_Page_SetSize(page, HPDF_PAGE_SIZE_A4, HPDF_PAGE_PORTRAIT);
+    }
+    if (page == NULL) {
+        _HPDFTBL_SET_ERR(NULL, -6, -1, -1);
+        return -1;
+    }
+    flow->pdf_page = page;
+    flow->ypos = HPDF_Page_GetHeight(page) - flow->top_margin;
+    flow->page_empty = TRUE;
+    flow->num_pages++;
+    return 0;
+}
+
+/**
+ * @brief Create a flow that places tables after each other down the page.
+ *
+ * A flow is used to place many tables vertically after each other. The tables
+ * are added to the flow with hpdftbl_flow_add() and are then placed with
+ * hpdftbl_flow_stroke(). When a table does not fit in the space left on the current page
+ * a new page is added to the document and the table is placed at the top of it.
+ *
+ * By default new pages are A4 portrait with a top and bottom margin of 1cm and
+ * the space between tables is 0.5cm.
+ *
+ * @code
+ * hpdftbl_flow_t flow = hpdftbl_flow_create(pdf_doc, pdf_page, hpdftbl_cm2dpi(1),
+ *                                           hpdftbl_cm2dpi(A4PAGE_HEIGHT_CM - 1), hpdftbl_cm2dpi(15));
+ * for (size_t i = 0; i < num_tables; i++) {
+ *     hpdftbl_flow_add(flow, tables[i]);
+ * }
+ * hpdftbl_flow_stroke(flow);
+ * hpdftbl_flow_destroy(flow);
+ * @endcode
+ *
+ * @param pdf_doc The HPDF document handle
+ * @param pdf_page The page to place the first table on. If NULL a new page is added.
+ * @param xpos Left x-position of the tables
+ * @param ypos Top y-position of the first table on the first page
+ * @param width Width of the tables. For a table with automatic column widths this is the
+ * maximum width.
+ * @return A new flow handle, NULL on failure
+ * @see hpdftbl_flow_add(), hpdftbl_flow_stroke(), hpdftbl_flow_destroy()
+ */
+hpdftbl_flow_t
+hpdftbl_flow_create(HPDF_Doc pdf_doc, HPDF_Page pdf_page, HPDF_REAL xpos, HPDF_REAL ypos, HPDF_REAL width) {
+    if (pdf_doc == NULL) {
+        _HPDFTBL_SET_ERR(NULL, -6, -1, -1);
+        return NULL;
+    }
+#ifdef __cplusplus
+    hpdftbl_flow_t flow = static_cast<hpdftbl_flow_t>(hpdftbl_calloc(1, sizeof(struct hpdftbl_flow)));
+#else
+    hpdftbl_flow_t flow = hpdftbl_calloc(1, sizeof(struct hpdftbl_flow));
+#endif
+    if (flow == NULL) {
+        _HPDFTBL_SET_ERR(NULL, -5, -1, -1);
+        return NULL;
+    }
+    flow->pdf_doc = pdf_doc;
+    flow->xpos = xpos;
+    flow->width = width;
+    flow->spacing = hpdftbl_cm2dpi(0.5);
+    flow->top_margin = hpdftbl_cm2dpi(1);
+    flow->bottom_margin = hpdftbl_cm2dpi(1);
+
+    if (pdf_page == NULL) {
+        if (-1 == flow_add_page(flow)) {
+            hpdftbl_free(flow);
+            return NULL;
+        }
+    } else {
+        flow->pdf_page = pdf_page;
+        flow->ypos = ypos;
+        flow->page_empty = TRUE;
+    }
+    return flow;
+}
+
+/**
+ * @brief Destroy a flow.
+ *
+ * The tables added to the flow are not destroyed.
+ *
+ * @param flow Flow handle
+ * @return 0 on success, -1 on failure
+ */
+int
+hpdftbl_flow_destroy(hpdftbl_flow_t flow) {
+    if (flow == NULL) {
+        _HPDFTBL_SET_ERR(NULL, -6, -1, -1);
+        return -1;
+    }
+    hpdftbl_free(flow->queue);
+    hpdftbl_free(flow);
+    return 0;
+}
+
+/**
+ * @brief Set the vertical space between the tables in a flow.
+ *
+ * @param flow Flow handle
+ * @param spacing Space in points
+ * @return 0 on success, -1 on failure
+ */
+int
+hpdftbl_flow_set_spacing(hpdftbl_flow_t flow, HPDF_REAL spacing) {
+    if (flow == NULL) {
+        _HPDFTBL_SET_ERR(NULL, -6, -1, -1);
+        return -1;
+    }
+    flow->spacing = spacing;
+    return 0;
+}
+
+/**
+ * @brief Set the top and bottom page margins of a flow.
+ *
+ * The top margin is the distance from the top of a new page to the first table on that
+ * page. No table will be placed closer to the bottom of the page than the bottom margin
+ * unless the table is higher than an empty page.
+ *
+ * @param flow Flow handle
+ * @param top Top margin in points
+ * @param bottom Bottom margin in points
+ * @return 0 on success, -1 on failure
+ */
+int
+hpdftbl_flow_set_margins(hpdftbl_flow_t flow, HPDF_REAL top, HPDF_REAL bottom) {
+    if (flow == NULL) {
+        _HPDFTBL_SET_ERR(NULL, -6, -1, -1);
+        return -1;
+    }
+    flow->top_margin = top;
+    flow->bottom_margin = bottom;
+    return 0;
+}
+
+/**
+ * @brief Set the callback used to create new pages in a flow.
+ *
+ * The callback should add a new page to the document, set its size and add any other
+ * content wanted on the page, e.g. a page header.
+ *
+ * @param flow Flow handle
+ * @param cb Callback. If NULL a new A4 portrait page is added.
+ * @return 0 on success, -1 on failure
+ */
+int
+hpdftbl_flow_set_page_cb(hpdftbl_flow_t flow, hpdftbl_flow_page_callback_t cb) {
+    if (flow == NULL) {
+        _HPDFTBL_SET_ERR(NULL, -6, -1, -1);
+        return -1;
+    }
+    flow->new_page_cb = cb;
+    return 0;
+}
+
+/**
+ * @brief Add a table to the end of the queue of tables to place in a flow.
+ *
+ * The table is not laid out or stroked until hpdftbl_flow_stroke() is called. The
+ * flow does not take ownership of the table.
+ *
+ * @param flow Flow handle
+ * @param t Table handle
+ * @return 0 on success, -1 on failure
+ */
+int
+hpdftbl_flow_add(hpdftbl_flow_t flow, hpdftbl_t t) {
+    if (flow == NULL) {
+        _HPDFTBL_SET_ERR(NULL, -6, -1, -1);
+        return -1;
+    }
+    _HPDFTBL_CHK_TABLE(t);
+    if (flow->queue_len == flow->queue_size) {
+        const size_t size = flow->queue_size ? 2 * flow->queue_size : 16;
+#ifdef __cplusplus
+        hpdftbl_t *queue = static_cast<hpdftbl_t*>(hpdftbl_realloc(flow->queue, size * sizeof(hpdftbl_t)));
+#else
+        hpdftbl_t *queue = hpdftbl_realloc(flow->queue, size * sizeof(hpdftbl_t));
+#endif
+        if (queue == NULL) {
+            _HPDFTBL_SET_ERR(t, -5, -1, -1);
+            return -1;
+        }
+        flow->queue = queue;
+        flow->queue_size = size;
+    }
+    flow->queue[flow->queue_len++] = t;
+    return 0;
+}
+
+/**
+ * @brief Place all queued tables in a flow.
+ *
+ * The layout of each table is calculated once with hpdftbl_layout() and the table is
+ * then stroked with that layout by hpdftbl_stroke_layout(). A table that does not fit in the
+ * space left on the current page is placed at the top of a new page. A table that is
+ * higher than an empty page is placed on a page of its own and will extend below the
+ * bottom margin.
+ *
+ * The queue is empty afterwards and more tables can be added and placed after the
+ * ones already placed. If a table fails, the tables placed before it are removed from
+ * the queue and the failed table is first in the queue.
+ *
+ * @param flow Flow handle
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_flow_get_pos()
+ */
+int
+hpdftbl_flow_stroke(hpdftbl_flow_t flow) {
+    if (flow == NULL) {
+        _HPDFTBL_SET_ERR(NULL, -6, -1, -1);
+        return -1;
+    }
+
+    for (size_t i = 0; i < flow->queue_len; i++) {
+        hpdftbl_t t = flow->queue[i];
+        hpdftbl_layout_t layout;
+        int ret = hpdftbl_layout(flow->pdf_doc, t, flow->width, 0, &layout);
+
+        if (0 == ret && !flow->page_empty && flow->ypos - layout.total_height < flow->bottom_margin) {
+            ret = flow_add_page(flow);
+        }
+
+        if (0 == ret) {
+            // A table anchored at the bottom left corner is positioned by the bottom of the table
+            const HPDF_REAL y = t->anchor_is_top_left ? flow->ypos : flow->ypos - layout.total_height;
+            ret = hpdftbl_stroke_layout(flow->pdf_doc, flow->pdf_page, t, flow->xpos, y);
+        }
+
+        if (-1 == ret) {
+            memmove(flow->queue, flow->queue + i, (flow->queue_len - i) * sizeof(hpdftbl_t));
+            flow->queue_len -= i;
+            return -1;
+        }
+
+        flow->ypos -= layout.total_height + flow->spacing;
+        flow->page_empty = FALSE;
+    }
+
+    flow->queue_len = 0;
+    return 0;
+}
+
+/**
+ * @brief Start a new page in a flow.
+ *
+ * The next table placed will be at the top of a new page.
+ *
+ * @param flow Flow handle
+ * @return 0 on success, -1 on failure
+ */
+int
+hpdftbl_flow_new_page(hpdftbl_flow_t flow) {
+    if (flow == NULL) {
+        _HPDFTBL_SET_ERR(NULL, -6, -1, -1);
+        return -1;
+    }
+    return flow_add_page(flow);
+}
+
+/**
+ * @brief Get the current position of a flow.
+ *
+ * This is the page and the y-position where the next table will be placed (if it fits).
+ * This can be used to add other content after the tables.
+ *
+ * @param flow Flow handle
+ * @param page Returned current page. May be NULL.
+ * @param ypos Returned y-position. May be NULL.
+ * @return 0 on success, -1 on failure
+ */
+int
+hpdftbl_flow_get_pos(hpdftbl_flow_t flow, HPDF_Page *page, HPDF_REAL *ypos) {
+    if (flow == NULL) {
+        _HPDFTBL_SET_ERR(NULL, -6, -1, -1);
+        return -1;
+    }
+    if (page)
+        *page = flow->pdf_page;
+    if (ypos)
+        *ypos = flow->ypos;
+    return 0;
+}
@@ -36,123 +36,124 @@
 #include <string.h>
 #include <hpdf.h>
 
+#include "hpdftbl.h"
+
 /**
- * Stroke a point grid on specified page to make it easier to position text and tables.
- * @param pdf Document handle
- * @param page Page handle
+ * @brief Internal function. Add all grid lines of one class to the current path.
  *
+ * Horizontal lines are drawn every 5 points and vertical every 5 points. A line is
+ * added if its position modulo `major` is equal to 0 (`is_major` TRUE) or not 0
+ * (`is_major` FALSE).
+ *
+ * @param page Page handle
+ * @param width Width of page
+ * @param height Height of page
+ * @param major Distance between major lines
+ * @param is_major Add the major or the minor lines
  */
-void
-hpdftbl_stroke_grid(HPDF_Doc pdf, HPDF_Page page) {
+static void
+grid_lines(HPDF_Page page, HPDF_REAL width, HPDF_REAL height, HPDF_UINT major, _Bool is_major) {
+    for (HPDF_UINT y = 0; y < height; y += 5) {
+        if ((y % major == 0) == is_major) {
+            HPDF_Page_MoveTo(page, 0, y);
+            HPDF_Page_LineTo(page, width, y);
+        }
+    }
+    for (HPDF_UINT x = 0; x < width; x += 5) {
+        if ((x % major == 0) == is_major) {
+            HPDF_Page_MoveTo(page, x, 0);
+            HPDF_Page_LineTo(page, x, height);
+        }
+    }
+}
 
-    HPDF_REAL height = HPDF_Page_GetHeight(page);
-    HPDF_REAL width = HPDF_Page_GetWidth(page);
-    HPDF_Font font = HPDF_GetFont(pdf, "Helvetica", NULL);
+/**
+ * @brief Internal function. Draw the grid with the lower left corner of the page at (0,0)
+ *
+ * All lines with the same width and color are drawn as one path and all labels
+ * in one text object.
+ *
+ * @param pdf Document handle
+ * @param page Page handle
+ * @param width Width of page
+ * @param height Height of page
+ */
+static void
+grid_draw(HPDF_Doc pdf, HPDF_Page page, HPDF_REAL width, HPDF_REAL height) {
     HPDF_UINT x, y;
 
-    HPDF_Page_SetFontAndSize(page, font, 5);
-    HPDF_Page_SetGrayFill(page, 0.5);
+    /* Minor and major lines */
     HPDF_Page_SetGrayStroke(page, 0.8);
+    HPDF_Page_SetLineWidth(page, 0.25);
+    grid_lines(page, width, height, 10, FALSE);
+    HPDF_Page_Stroke(page);
 
-    /* Draw horizontal lines */
-    y = 0;
-    while (y < height) {
-        if (y % 10 == 0)
-            HPDF_Page_SetLineWidth(page, 0.5);
-        else {
-            if (HPDF_Page_GetLineWidth(page) != 0.25)
-                HPDF_Page_SetLineWidth(page, 0.25);
-        }
+    HPDF_Page_SetLineWidth(page, 0.5);
+    grid_lines(page, width, height, 10, TRUE);
+    HPDF_Page_Stroke(page);
 
+    /* Tick marks at the labels */
+    HPDF_Page_SetGrayStroke(page, 0.5);
+    for (y = 10; y < height; y += 10) {
         HPDF_Page_MoveTo(page, 0, y);
-        HPDF_Page_LineTo(page, width, y);
-        HPDF_Page_Stroke(page);
-
-        if (y % 10 == 0 && y > 0) {
-            HPDF_Page_SetGrayStroke(page, 0.5);
-
-            HPDF_Page_MoveTo(page, 0, y);
-            HPDF_Page_LineTo(page, 5, y);
-            HPDF_Page_Stroke(page);
-
-            HPDF_Page_SetGrayStroke(page, 0.8);
-        }
-
-        y += 5;
+        HPDF_Page_LineTo(page, 5, y);
     }
-
-
-    /* Draw vertical lines */
-    x = 0;
-    while (x < width) {
-        if (x % 10 == 0)
-            HPDF_Page_SetLineWidth(page, 0.5);
-        else {
-            if (HPDF_Page_GetLineWidth(page) != 0.25)
-                HPDF_Page_SetLineWidth(page, 0.25);
-        }
-
+    for (x = 50; x < width; x += 50) {
         HPDF_Page_MoveTo(page, x, 0);
-        HPDF_Page_LineTo(page, x, height);
-        HPDF_Page_Stroke(page);
-
-        if (x % 50 == 0 && x > 0) {
-            HPDF_Page_SetGrayStroke(page, 0.5);
-
-            HPDF_Page_MoveTo(page, x, 0);
-            HPDF_Page_LineTo(page, x, 5);
-            HPDF_Page_Stroke(page);
-
-            HPDF_Page_MoveTo(page, x, height);
-            HPDF_Page_LineTo(page, x, height - 5);
-            HPDF_Page_Stroke(page);
-
-            HPDF_Page_SetGrayStroke(page, 0.8);
-        }
-
-        x += 5;
+        HPDF_Page_LineTo(page, x, 5);
+        HPDF_Page_MoveTo(page, x, height);
+        HPDF_Page_LineTo(page, x, height - 5);
     }
+    HPDF_Page_Stroke(page);
 
-    /* Draw horizontal text */
-    y = 0;
-    while (y < height) {
-        if (y % 10 == 0 && y > 0) {
-            char buf[12];
-
-            HPDF_Page_BeginText(page);
-            HPDF_Page_MoveTextPos(page, 5, y - 2);
-            snprintf(buf, sizeof(buf), "%u", y);
-            HPDF_Page_ShowText(page, buf);
-            HPDF_Page_EndText(page);
-        }
-
-        y += 5;
+    /* Labels */
+    HPDF_Page_SetFontAndSize(page, HPDF_GetFont(pdf, "Helvetica", NULL), 5);
+    HPDF_Page_SetGrayFill(page, 0.5);
+    HPDF_Page_BeginText(page);
+    for (y = 10; y < height; y += 10) {
+        char buf[12];
+        snprintf(buf, sizeof(buf), "%u", y);
+        HPDF_Page_TextOut(page, 5, y - 2, buf);
     }
-
-
-    /* Draw vertical text */
-    x = 0;
-    while (x < width) {
-        if (x % 50 == 0 && x > 0) {
-            char buf[12];
-
-            HPDF_Page_BeginText(page);
-            HPDF_Page_MoveTextPos(page, x, 5);
-            snprintf(buf, sizeof(buf), "%u", x);
-            HPDF_Page_ShowText(page, buf);
-            HPDF_Page_EndText(page);
-
-            HPDF_Page_BeginText(page);
-            HPDF_Page_MoveTextPos(page, x, height - 10);
-            HPDF_Page_ShowText(page, buf);
-            HPDF_Page_EndText(page);
-        }
-
-        x += 5;
+    for (x = 50; x < width; x += 50) {
+        char buf[12];
+        snprintf(buf, sizeof(buf), "%u", x);
+        HPDF_Page_TextOut(page, x, 5, buf);
+        HPDF_Page_TextOut(page, x, height - 10, buf);
     }
+    HPDF_Page_EndText(page);
 
     HPDF_Page_SetGrayFill(page, 0);
     HPDF_Page_SetGrayStroke(page, 0);
 }
 
-
+/**
+ * Stroke a point grid on specified page to make it easier to position text and tables.
+ *
+ * When the widget cache is enabled with hpdftbl_use_widget_cache() the grid is only
+ * drawn once for each page size and then placed on all pages by reference.
+ *
+ * @param pdf Document handle
+ * @param page Page handle
+ *
+ */
+void
+hpdftbl_stroke_grid(HPDF_Doc pdf, HPDF_Page page) {
+    const HPDF_REAL height = HPDF_Page_GetHeight(page);
+    const HPDF_REAL width = HPDF_Page_GetWidth(page);
+    hpdftbl_xobject_rec_t rec;
+    HPDF_Rect bbox;
+    char key[64];
+
+    bbox.left = 0;
+    bbox.bottom = 0;
+    bbox.right = width;
+    bbox.top = height;
+    snprintf(key, sizeof(key), "grid|%.3f|%.3f", (double) width, (double) height);
+
+    // The grid is placed at (0,0) on the page so the recording can be done at the same position
+    if (1 == hpdftbl_widget_cache_begin(pdf, page, key, bbox, 0, 0, &rec))
+        return;
+    grid_draw(pdf, page, width, height);
+    hpdftbl_widget_cache_end(key, 0, 0, &rec);
+}
@@ -31,6 +31,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 
 #if !(defined _WIN32 || defined __WIN32__)
 
@@ -55,75 +56,95 @@
 #endif
 
 
+static int
+theme_loadb(hpdftbl_theme_t *theme, const char *buff, size_t len);
+
+static int
+table_loadb(hpdftbl_t tbl, const char *buff, size_t len);
+
+static int
+table_load_fields(hpdftbl_t t, json_t *table);
+
+static int
+table_load_cell(hpdftbl_t t, json_t *obj);
+
+static void
+table_load_done(hpdftbl_t t);
+
+/**
+ * @brief Row of a cell that has not been read yet. Used to find a cell that is read twice.
+ */
+#define CELL_NOT_LOADED SIZE_MAX
+
 /*-----------------------------------------------------------------------
  * Load section.
  * Functions to de-serialize structures read from buffer or file.
  *
  */
 
+/*
+ * All fields are optional. A field that is not present in the serialized
+ * structure keeps its current value which the loaders initialize to the
+ * defaults of a newly created table or the default theme. This makes it possible
+ * to read back the compact format written by hpdftbl_dumps_compact().
+ * Fields that have no sensible default are checked with GETJSON_REQUIRED().
+ */
+
+#define GETJSON_REQUIRED(table, k) do { \
+    if(!json_object_get(table,k)) {     \
+        json_not_found_str=k;           \
+        goto json_raise_notfound_error; \
+    }                                   \
+} while(0)
+
 #define GETJSON_STRING(table, k, var) do  { \
     json_t *_elem=json_object_get(table,k); \
-    if(!_elem) {                            \
-        json_not_found_str=k;               \
-        goto json_raise_notfound_error;     \
+    if(_elem) {                             \
+        const char *_str=json_string_value(_elem); \
+        if( _str == NULL || strlen(_str) == 0 ) \
+            var=NULL;                       \
+        else                                \
+            var=hpdftbl_strdup(_str);               \
     }                                       \
-    if( strlen(json_string_value(_elem)) == 0 ) \
-        var=NULL;                           \
-    else                                    \
-        var=strdup(json_string_value(_elem)); \
 } while(0)
 
 #define GETJSON_UINT(table, k, var) do { \
     json_t *_elem=json_object_get(table,k); \
-    if(!_elem) {                         \
-        json_not_found_str=k;            \
-        goto json_raise_notfound_error;  \
-    }                                    \
-    var=(size_t)json_integer_value(_elem);  \
+    if(_elem)                            \
+        var=(size_t)json_integer_value(_elem); \
 } while(0)
 
 #define GETJSON_REAL(table, k, var) do { \
     json_t *_elem=json_object_get(table,k); \
-    if(!_elem) {                         \
-        json_not_found_str=k;            \
-        goto json_raise_notfound_error;  \
-    }                                    \
-    var=json_real_value(_elem);          \
+    if(_elem)                            \
+        var=json_number_value(_elem);    \
 } while(0)
 
 #define GETJSON_BOOLEAN(table, k, var) do { \
     json_t *_elem=json_object_get(table,k); \
-    if(!_elem) {                            \
-        json_not_found_str=k;               \
-        goto json_raise_notfound_error;     \
-    }                                       \
-    var=json_boolean_value(_elem);          \
+    if(_elem)                               \
+        var=json_boolean_value(_elem);      \
 } while(0)
 
 #define GETJSON_RGB(table, k, var) do { \
     json_t *_elem; \
     json_t *_val; \
     size_t _idx; \
-    double tmpcol[3]; \
+    double tmpcol[3] = {var.r, var.g, var.b}; \
     _elem = json_object_get(table, k);\
-    if(!_elem) {                        \
-        json_not_found_str=k;           \
-        goto json_raise_notfound_error; \
-    } \
-    json_array_foreach(_elem, _idx, _val) { \
-        tmpcol[_idx] = json_real_value(_val); \
+    if(_elem) { \
+        json_array_foreach(_elem, _idx, _val) { \
+            if( _idx < 3 ) \
+                tmpcol[_idx] = json_number_value(_val); \
+        } \
+        var.r = tmpcol[0]; \
+        var.g = tmpcol[1]; \
+        var.b = tmpcol[2]; \
     } \
-    var.r = tmpcol[0]; \
-    var.g = tmpcol[1]; \
-    var.b = tmpcol[2]; \
 } while(0)
 
 #define GETJSON_GRIDSTYLE(table, k, var) do { \
     json_t *_grid=json_object_get(table,k); \
-    if(!_grid) {                              \
-        json_not_found_str=k;                 \
-        goto json_raise_notfound_error;       \
-    } \
     if(json_is_object(_grid)) { \
         GETJSON_REAL(_grid,"width",var.width); \
         GETJSON_UINT(_grid,"dashstyle",var.line_dashstyle); \
@@ -131,65 +152,56 @@
     } \
 } while(0)
 
+#define GETJSON_TXTSTYLE_FIELDS(obj, var) do { \
+    GETJSON_STRING(obj,"font",var.font); \
+    GETJSON_REAL(obj,"fsize",var.fsize); \
+    GETJSON_RGB(obj,"color",var.color); \
+    GETJSON_RGB(obj,"background",var.background); \
+    GETJSON_UINT(obj,"halign",var.halign); \
+} while(0)
+
 #define GETJSON_TXTSTYLE(table, k, var) do { \
      json_t *_txtstyle=json_object_get(table,k); \
-     if(!_txtstyle) {                        \
-        json_not_found_str=k;                \
-        goto json_raise_notfound_error;      \
-     } \
      if(json_is_object(_txtstyle)) { \
-        GETJSON_STRING(_txtstyle,"font",var.font); \
-        GETJSON_REAL(_txtstyle,"fsize",var.fsize); \
-        GETJSON_RGB(_txtstyle,"color",var.color); \
-        GETJSON_RGB(_txtstyle,"background",var.background); \
-        GETJSON_UINT(_txtstyle,"halign",var.halign); \
+        GETJSON_TXTSTYLE_FIELDS(_txtstyle, var); \
      } \
 } while(0)
 
-#define GETJSON_REALARRAY(table, k, var) do { \
+#define GETJSON_REALARRAY(table, k, var, n) do { \
     json_t *_array = json_object_get(table, k); \
-    if(!_array){ \
-        json_not_found_str=k; \
-        goto json_raise_notfound_error; \
-    } \
     size_t _idx; \
     json_t *_val; \
     json_array_foreach(_array, _idx, _val) { \
-        var[_idx] = json_real_value(_val); \
+        if( _idx < (n) ) \
+            var[_idx] = json_number_value(_val); \
     } \
 } while(0)
 
 #define GETJSON_DYNCB(table, key) do { \
-    json_t *_elem=json_object_get(table, #key); \
-    if(!_elem) { \
-        json_not_found_str= #key; \
-        goto json_raise_notfound_error; \
-    } if( strlen(json_string_value(_elem)) != 0 ) \
-        hpdftbl_set_ ## key(t, json_string_value(_elem)); \
+    const char *_str=json_string_value(json_object_get(table, #key)); \
+    if( _str && strlen(_str) != 0 ) \
+        hpdftbl_set_ ## key(t, _str); \
 } while(0);
 
 #define GETJSON_CELLDYNCB(table, key, r, c) do { \
-    json_t *_elem=json_object_get(table,#key); \
-    if(!_elem) { \
-        json_not_found_str=#key; \
-        goto json_raise_notfound_error; \
-    } if( strlen(json_string_value(_elem)) != 0 ) \
-        hpdftbl_set_cell_ ## key(t, r, c, json_string_value(_elem)); \
+    const char *_str=json_string_value(json_object_get(table, #key)); \
+    if( _str && strlen(_str) != 0 ) \
+        hpdftbl_set_cell_ ## key(t, r, c, _str); \
 } while(0);
 
-#define GETJSON_CELLTXTSTYLE(table, key, r, c) do { \
+#define GETJSON_CELLTXTSTYLE(table, key, cell) do { \
     json_t *__elem=json_object_get(table, #key); \
-    if(!__elem) { \
-        json_not_found_str= #key; \
-        goto json_raise_notfound_error; \
-    } \
     if( json_is_object(__elem) ) {  \
-        GETJSON_STRING(__elem,"font",t->cells[t->cols*r+c].key.font); \
-        GETJSON_REAL(__elem,"fsize",t->cells[t->cols*r+c].key.fsize); \
-        GETJSON_RGB(__elem,"color",t->cells[t->cols*r+c].key.color);  \
-        GETJSON_RGB(__elem,"background",t->cells[t->cols*r+c].key.background); \
-        GETJSON_UINT(__elem,"halign",t->cells[t->cols*r+c].key.halign); \
-    } else {                                        \
+        hpdf_text_style_t __style; \
+        memset(&__style, 0, sizeof __style); \
+        GETJSON_TXTSTYLE_FIELDS(__elem, __style); \
+        if( __style.font ) { \
+            if( hpdftbl_intern_style(t, &__style, &(cell)->style_id) ) \
+                return -2; \
+            if( t->styles[(cell)->style_id - 1].font != __style.font ) \
+                hpdftbl_free(__style.font); \
+        } \
+    } else if( __elem ) {                           \
         json_not_found_str= #key;                   \
         goto json_raise_notfound_error;             \
     } \
@@ -199,20 +211,44 @@
  * @brief Load theme from a serialized string. This is the invert function
  * of hpdftbl_theme_dumps().
  *
+ * If the theme has conditional formatting rules they are allocated and should be
+ * freed with hpdftbl_theme_free_rules() when no table uses them any more.
+ *
  * @param theme Theme to load to.
  * @param buff Buffer which holds the previous serialized theme
  * @return 0 on success, -1 on failure
  *
- * @see hpdftbl_theme_dumps(), hpdftbl_theme_load(), hpdftbl_apply_theme()
+ * @see hpdftbl_theme_dumps(), hpdftbl_theme_load(), hpdftbl_apply_theme(), hpdftbl_theme_free_rules()
  */
 int
 hpdftbl_theme_loads(hpdftbl_theme_t *theme, char *buff) {
+    return theme_loadb(theme, buff, strlen(buff));
+}
+
+/**
+ * @brief Load a theme from a serialized buffer of known length.
+ *
+ * The buffer does not need to be NULL terminated which makes it possible
+ * to parse a memory mapped file directly.
+ *
+ * @param theme Theme to load to.
+ * @param buff Buffer which holds the previous serialized theme
+ * @param len Length of buffer
+ * @return 0 on success, -1 on parse error, -2 on missing fields
+ */
+static int
+theme_loadb(hpdftbl_theme_t *theme, const char *buff, size_t len) {
 
     hpdftbl_theme_t *t = theme;
     char *json_not_found_str = NULL;
+    hpdftbl_rule_t *rules = NULL;
+    size_t num_rules = 0;
+
+    // Fields not present in the serialized theme keep their default value
+    *t = *hpdftbl_get_builtin_theme(THEME_DEFAULT);
 
     json_error_t json_error;
-    json_t *root = json_loads(buff, 0, &json_error);
+    json_t *root = json_loadb(buff, len, 0, &json_error);
     if (!root) {
         goto json_raise_parse_error;
     }
@@ -221,10 +257,12 @@ hpdftbl_theme_loads(hpdftbl_theme_t *theme, char *buff) {
         json_t *version = json_object_get(root, "version");
 
         int v = json_integer_value(version);
+        json_not_found_str = "version";
         if (v != THEME_JSON_VERSION)
             goto json_raise_notfound_error;
 
         json_t *theme = json_object_get(root, "hpdftbl_theme");
+        json_not_found_str = "hpdftbl_theme";
         if (!theme)
             goto json_raise_notfound_error;
 
@@ -245,17 +283,53 @@ hpdftbl_theme_loads(hpdftbl_theme_t *theme, char *buff) {
         GETJSON_RGB(theme, "zebra_color1", t->zebra_color1);
         GETJSON_RGB(theme, "zebra_color2", t->zebra_color2);
         GETJSON_REAL(theme, "bottom_vmargin_factor", t->bottom_vmargin_factor);
+
+        json_t *rule_list = json_object_get(theme, "rules");
+        if (json_array_size(rule_list) > 0) {
+            num_rules = json_array_size(rule_list);
+#ifdef __cplusplus
+            rules = static_cast<hpdftbl_rule_t *>(hpdftbl_calloc(num_rules, sizeof(hpdftbl_rule_t)));
+#else
+            rules = hpdftbl_calloc(num_rules, sizeof(hpdftbl_rule_t));
+#endif
+            if (NULL == rules) {
+                json_decref(root);
+                _HPDFTBL_SET_ERR(NULL, -5, -1, -1);
+                return -1;
+            }
+            size_t idx;
+            json_t *rule;
+            json_array_foreach(rule_list, idx, rule) {
+                json_not_found_str = "rules";
+                if (!json_is_object(rule))
+                    goto json_raise_notfound_error;
+                json_t *col = json_object_get(rule, "col");
+                rules[idx].col = col ? (int) json_integer_value(col) : -1;
+                GETJSON_UINT(rule, "op", rules[idx].op);
+                GETJSON_REAL(rule, "value", rules[idx].value);
+                GETJSON_REAL(rule, "value2", rules[idx].value2);
+                GETJSON_STRING(rule, "str", rules[idx].str);
+                GETJSON_UINT(rule, "apply", rules[idx].apply);
+                GETJSON_TXTSTYLE(rule, "style", rules[idx].style);
+                json_not_found_str = "op";
+                if (rules[idx].op > RULE_BOTTOM_N)
+                    goto json_raise_notfound_error;
+            }
+            t->rules = rules;
+            t->num_rules = num_rules;
+        }
     }
 
+    json_decref(root);
     return 0;
 
     json_raise_notfound_error:
     fprintf(stderr, "JSON Not Found: '%s'\n", json_not_found_str);
-    hpdftbl_destroy_theme(t);
+    hpdftbl_rules_free(rules, num_rules);
+    json_decref(root);
     return -2;
     json_raise_parse_error:
     fprintf(stderr, "JSON Err: '%s' at line %d\n", json_error.text, json_error.line);
-    hpdftbl_destroy_theme(t);
     return -1;
 }
 
@@ -264,7 +338,7 @@ hpdftbl_theme_loads(hpdftbl_theme_t *theme, char *buff) {
  *
  * *Example:*
  * ```c
- * hpdftbl_t tbl = calloc(1, sizeof (struct hpdftbl));
+ * hpdftbl_t tbl = hpdftbl_calloc(1, sizeof (struct hpdftbl));
  * hpdftbl_theme_t theme;
  *  if( 0 == hpdftbl_load(tbl, "tests/tut_ex41.json") ) {
  *      if( 0 == hpdftbl_theme_load(&theme, "mytheme.json") ) {
@@ -274,26 +348,62 @@ hpdftbl_theme_loads(hpdftbl_theme_t *theme, char *buff) {
  *  }
  * ```
  *
+ * If the theme has conditional formatting rules they are allocated and should be
+ * freed with hpdftbl_theme_free_rules() when no table uses them any more.
+ *
  * @param theme Theme to read into
  * @param filename File to read from
  * @return 0 on success, -1 on failure
  */
 int
 hpdftbl_theme_load(hpdftbl_theme_t *theme, char *filename) {
-    const size_t buffsize = 2 * 1024; // 2k buffer
-    char *buff = calloc(buffsize, sizeof(char));
+    char *buff;
+    size_t size;
 
-    if (NULL == buff)
+    if (0 != hpdftbl_map_file(filename, &buff, &size))
         return -1;
 
-    if (0 == hpdftbl_read_file(buff, buffsize, filename)) {
-        if (0 == hpdftbl_theme_loads(theme, buff)) {
-            free(buff);
-            return 0;
-        }
+    int ret = theme_loadb(theme, buff, size);
+    hpdftbl_unmap_file(buff, size);
+    return 0 == ret ? 0 : -1;
+}
+
+/**
+ * @brief Reload a shared theme from a previous serialized theme in a named file.
+ *
+ * All tables that use the shared theme get the new styles the next time they are
+ * stroked. The cost of the reload does not depend on the number of tables that
+ * use the theme. If the file cannot be read the shared theme is left unchanged.
+ *
+ * @param shared Shared theme to reload
+ * @param filename File to read from
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_shared_theme_set(), hpdftbl_theme_load()
+ */
+int
+hpdftbl_shared_theme_load(hpdftbl_shared_theme_t shared, char *filename) {
+    if (NULL == shared) {
+        _HPDFTBL_SET_ERR(NULL, -9, -1, -1);
+        return -1;
     }
-    free(buff);
-    return -1;
+
+    hpdftbl_theme_t theme;
+    if (0 != hpdftbl_theme_load(&theme, filename))
+        return -1;
+    int ret = hpdftbl_shared_theme_set(shared, &theme);
+
+    // The font names that were read from the file are copied by the shared theme
+    const hpdftbl_theme_t *default_theme = hpdftbl_get_builtin_theme(THEME_DEFAULT);
+    if (theme.content_style.font != default_theme->content_style.font)
+        hpdftbl_free(theme.content_style.font);
+    if (theme.label_style.font != default_theme->label_style.font)
+        hpdftbl_free(theme.label_style.font);
+    if (theme.header_style.font != default_theme->header_style.font)
+        hpdftbl_free(theme.header_style.font);
+    if (theme.title_style.font != default_theme->title_style.font)
+        hpdftbl_free(theme.title_style.font);
+    hpdftbl_theme_free_rules(&theme);
+    return ret;
 }
 
 /**
@@ -303,16 +413,20 @@ hpdftbl_theme_load(hpdftbl_theme_t *theme, char *filename) {
  * it is easy to get it wrong. Some things to keep in mind while doing
  * manual changes.
  *
- *  - A real number must always be written as a decimal number with at least
- *  one decimal point (even if it .0)
+ *  - Only the number of rows and columns are mandatory. Any other field that
+ *  is left out gets the same default value as in a table created with hpdftbl_create().
  *  - Remember that the width of the table is specified manually and not
  *  automatically recalculated based on the text width.
  *
+ * There is no upper limit on the size of the file. The file is memory mapped
+ * (see hpdftbl_map_file()) and parsed in place so no intermediate copy of the
+ * file content is made.
+ *
  * After reading a serialized table it can asily be be stroked with only
  * two lines of code as the following code-snippet shows
  *
  * ```c
- *  hpdftbl_t tbl = calloc(1, sizeof (struct hpdftbl));
+ *  hpdftbl_t tbl = hpdftbl_calloc(1, sizeof (struct hpdftbl));
  *  if(0 == hpdftbl_load(tbl, "mytablefile.json") ) {
  *       hpdftbl_stroke_pos(pdf_doc, pdf_page, tbl);
  *  }
@@ -324,24 +438,20 @@ hpdftbl_theme_load(hpdftbl_theme_t *theme, char *filename) {
  *
  * @param tbl Table to read into
  * @param filename File to read from
- * @return  0 on success, -1 on file parse error, -2 on nay other error
+ * @return  0 on success, -1 on failure
+ * @see hpdftbl_map_file()
  */
 int
 hpdftbl_load(hpdftbl_t tbl, char *filename) {
-    const size_t buffsize = 100 * 1024; // 100k buffer
-    char *buff = calloc(buffsize, sizeof(char));
+    char *buff;
+    size_t size;
 
-    if (NULL == buff)
+    if (0 != hpdftbl_map_file(filename, &buff, &size))
         return -1;
 
-    if (0 == hpdftbl_read_file(buff, buffsize, filename)) {
-        if (0 == hpdftbl_loads(tbl, buff)) {
-            free(buff);
-            return 0;
-        }
-    }
-    free(buff);
-    return -1;
+    int ret = table_loadb(tbl, buff, size);
+    hpdftbl_unmap_file(buff, size);
+    return 0 == ret ? 0 : -1;
 }
 
 /**
@@ -354,7 +464,7 @@ hpdftbl_load(hpdftbl_t tbl, char *filename) {
  *
  * ```c
  *  char *mybuffer = ....
- *  hpdftbl_t tbl = calloc(1, sizeof (struct hpdftbl));
+ *  hpdftbl_t tbl = hpdftbl_calloc(1, sizeof (struct hpdftbl));
  *  if(0 == hpdftbl_load(tbl, mybuffer) ) {
  *       hpdftbl_stroke_pos(pdf_doc, pdf_page, tbl);
  *  }
@@ -367,12 +477,28 @@ hpdftbl_load(hpdftbl_t tbl, char *filename) {
  */
 int
 hpdftbl_loads(hpdftbl_t tbl, char *buff) {
+    return table_loadb(tbl, buff, strlen(buff));
+}
+
+/**
+ * @brief Import a table structure from a serialized json buffer of known length.
+ *
+ * The buffer does not need to be NULL terminated which makes it possible
+ * to parse a memory mapped file directly.
+ *
+ * @param tbl Reference to table handle to be populated
+ * @param buff Buffer with serialized data to read back
+ * @param len Length of buffer
+ * @return 0 on success, -1 on parse error, -2 on any other error
+ */
+static int
+table_loadb(hpdftbl_t tbl, const char *buff, size_t len) {
 
     hpdftbl_t t = tbl;
-    char *json_not_found_str = NULL;
+    char *json_not_found_str = "root";
 
     json_error_t json_error;
-    json_t *root = json_loads(buff, 0, &json_error);
+    json_t *root = json_loadb(buff, len, 0, &json_error);
     if (!root) {
         goto json_raise_parse_error;
     }
@@ -381,90 +507,29 @@ hpdftbl_loads(hpdftbl_t tbl, char *buff) {
         json_t *version = json_object_get(root, "version");
 
         int v = json_integer_value(version);
+        json_not_found_str = "version";
         if (v != TABLE_JSON_VERSION)
             goto json_raise_notfound_error;
 
         json_t *table = json_object_get(root, "table");
+        json_not_found_str = "table";
         if (!table)
             goto json_raise_notfound_error;
 
         if (json_is_object(table)) {
-            GETJSON_STRING(table, "tag", t->tag);
-            GETJSON_UINT(table, "rows", t->rows);
-            GETJSON_UINT(table, "cols", t->cols);
-            GETJSON_REAL(table, "posx", t->posx);
-            GETJSON_REAL(table, "posy", t->posy);
-            GETJSON_REAL(table, "width", t->width);
-            GETJSON_REAL(table, "height", t->height);
-            GETJSON_REAL(table, "minrowheight", t->minrowheight);
-            GETJSON_REAL(table, "bottom_vmargin_factor", t->bottom_vmargin_factor);
-            GETJSON_STRING(table, "title_txt", t->title_txt);
-            GETJSON_BOOLEAN(table, "use_header_row", t->use_header_row);
-            GETJSON_BOOLEAN(table, "use_cell_labels", t->use_cell_labels);
-            GETJSON_BOOLEAN(table, "use_label_grid_style", t->use_label_grid_style);
-            GETJSON_BOOLEAN(table, "use_zebra", t->use_zebra);
-            GETJSON_BOOLEAN(table, "anchor_is_top_left", t->anchor_is_top_left);
-            GETJSON_RGB(table, "zebra_color1", t->zebra_color1);
-            GETJSON_RGB(table, "zebra_color2", t->zebra_color2);
-
-            GETJSON_GRIDSTYLE(table, "outer_grid", t->outer_grid);
-            GETJSON_GRIDSTYLE(table, "inner_vgrid", t->inner_vgrid);
-            GETJSON_GRIDSTYLE(table, "inner_hgrid", t->inner_hgrid);
-            GETJSON_GRIDSTYLE(table, "inner_tgrid", t->inner_tgrid);
-
-            GETJSON_TXTSTYLE(table, "content_style", t->content_style);
-            GETJSON_TXTSTYLE(table, "title_style", t->title_style);
-            GETJSON_TXTSTYLE(table, "header_style", t->header_style);
-            GETJSON_TXTSTYLE(table, "label_style", t->label_style);
-            GETJSON_TXTSTYLE(table, "title_style", t->title_style);
-
-            t->col_width_percent = calloc(t->cols, sizeof(float));
-            GETJSON_REALARRAY(table, "col_width_percent", t->col_width_percent);
-
-            GETJSON_DYNCB(table, label_dyncb);
-            GETJSON_DYNCB(table, content_dyncb);
-            GETJSON_DYNCB(table, post_dyncb);
-            GETJSON_DYNCB(table, canvas_dyncb);
-            GETJSON_DYNCB(table, content_style_dyncb);
-
-            t->cells = calloc(t->cols * t->rows, sizeof(hpdftbl_cell_t));
+            if (table_load_fields(t, table))
+                goto json_raise_error;
+
             size_t idx;
             json_t *obj;
             json_t *array = json_object_get(table, "cells");
             if (json_is_array(array)) {
                 json_array_foreach(array, idx, obj) {
-                    GETJSON_UINT(obj, "row", t->cells[idx].row);
-                    GETJSON_UINT(obj, "col", t->cells[idx].col);
-                    GETJSON_STRING(obj, "label", t->cells[idx].label);
-                    GETJSON_STRING(obj, "content", t->cells[idx].content);
-                    GETJSON_UINT(obj, "rowspan", t->cells[idx].rowspan);
-                    GETJSON_UINT(obj, "colspan", t->cells[idx].colspan);
-                    GETJSON_REAL(obj, "height", t->cells[idx].height);
-                    GETJSON_REAL(obj, "width", t->cells[idx].width);
-                    GETJSON_REAL(obj, "delta_x", t->cells[idx].delta_x);
-                    GETJSON_REAL(obj, "delta_y", t->cells[idx].delta_y);
-                    GETJSON_REAL(obj, "textwidth", t->cells[idx].textwidth);
-
-                    GETJSON_CELLDYNCB(obj, content_dyncb, t->cells[idx].row, t->cells[idx].col);
-                    GETJSON_CELLDYNCB(obj, label_dyncb, t->cells[idx].row, t->cells[idx].col);
-                    GETJSON_CELLDYNCB(obj, content_style_dyncb, t->cells[idx].row, t->cells[idx].col);
-                    GETJSON_CELLDYNCB(obj, canvas_dyncb, t->cells[idx].row, t->cells[idx].col);
-
-                    GETJSON_CELLTXTSTYLE(obj, content_style, t->cells[idx].row, t->cells[idx].col);
-
-                    do {
-                        json_t *_parent = json_object_get(obj, "parent");
-                        if (_parent && json_is_object(_parent)) {
-                            size_t par_row = -1, par_col = -1;
-                            GETJSON_UINT(_parent, "row", par_row);
-                            GETJSON_UINT(_parent, "col", par_col);
-                            t->cells[t->cols * t->cells[idx].row + t->cells[idx].col].parent_cell = &t->cells[
-                                    t->cols * par_row + par_col];
-                        }
-                    } while (0);
+                    if (table_load_cell(t, obj))
+                        goto json_raise_error;
                 }
-                return 0;
             }
+            table_load_done(t);
         } else {
             goto json_raise_notfound_error;
         }
@@ -472,10 +537,13 @@ hpdftbl_loads(hpdftbl_t tbl, char *buff) {
         goto json_raise_notfound_error;
     }
 
+    json_decref(root);
     return 0;
 
     json_raise_notfound_error:
     fprintf(stderr, "JSON Not Found: '%s'\n", json_not_found_str);
+    json_raise_error:
+    json_decref(root);
     hpdftbl_destroy(t);
     return -2;
     json_raise_parse_error:
@@ -484,6 +552,480 @@ hpdftbl_loads(hpdftbl_t tbl, char *buff) {
     return -1;
 }
 
+/**
+ * @brief Populate all table fields, except the cells, from a JSON table object.
+ *
+ * This will also allocate the cells and the column widths. Fields that are
+ * not present get the same value as in a table created with hpdftbl_create().
+ * Only the number of rows and columns are mandatory.
+ *
+ * @param t Table to populate
+ * @param table The "table" JSON object
+ * @return 0 on success, -2 on a missing field, an invalid dimension or out of memory
+ */
+static int
+table_load_fields(hpdftbl_t t, json_t *table) {
+    char *json_not_found_str = NULL;
+
+    hpdftbl_apply_theme(t, hpdftbl_get_builtin_theme(THEME_DEFAULT));
+    t->anchor_is_top_left = TRUE;
+
+    GETJSON_REQUIRED(table, "rows");
+    GETJSON_REQUIRED(table, "cols");
+    GETJSON_STRING(table, "tag", t->tag);
+    GETJSON_UINT(table, "rows", t->rows);
+    GETJSON_UINT(table, "cols", t->cols);
+    GETJSON_REAL(table, "posx", t->posx);
+    GETJSON_REAL(table, "posy", t->posy);
+    GETJSON_REAL(table, "width", t->width);
+    GETJSON_REAL(table, "height", t->height);
+    GETJSON_REAL(table, "minrowheight", t->minrowheight);
+    GETJSON_REAL(table, "bottom_vmargin_factor", t->bottom_vmargin_factor);
+    GETJSON_STRING(table, "title_txt", t->title_txt);
+    GETJSON_BOOLEAN(table, "use_header_row", t->use_header_row);
+    GETJSON_BOOLEAN(table, "use_cell_labels", t->use_cell_labels);
+    GETJSON_BOOLEAN(table, "use_label_grid_style", t->use_label_grid_style);
+    GETJSON_BOOLEAN(table, "use_zebra", t->use_zebra);
+    GETJSON_UINT(table, "zebra_phase", t->zebra_phase);
+    GETJSON_BOOLEAN(table, "anchor_is_top_left", t->anchor_is_top_left);
+    GETJSON_RGB(table, "zebra_color1", t->zebra_color1);
+    GETJSON_RGB(table, "zebra_color2", t->zebra_color2);
+
+    GETJSON_GRIDSTYLE(table, "outer_grid", t->outer_grid);
+    GETJSON_GRIDSTYLE(table, "inner_vgrid", t->inner_vgrid);
+    GETJSON_GRIDSTYLE(table, "inner_hgrid", t->inner_hgrid);
+    GETJSON_GRIDSTYLE(table, "inner_tgrid", t->inner_tgrid);
+
+    GETJSON_TXTSTYLE(table, "content_style", t->content_style);
+    GETJSON_TXTSTYLE(table, "title_style", t->title_style);
+    GETJSON_TXTSTYLE(table, "header_style", t->header_style);
+    GETJSON_TXTSTYLE(table, "label_style", t->label_style);
+    GETJSON_TXTSTYLE(table, "title_style", t->title_style);
+
+    // The dimension is untrusted input and must be checked before it is used as an allocation size
+    if (t->rows == 0 || t->cols == 0 || t->rows > SIZE_MAX / sizeof(hpdftbl_cell_t) / t->cols) {
+        t->rows = t->cols = 0;
+        _HPDFTBL_SET_ERR(t, -2, -1, -1);
+        return -2;
+    }
+    t->col_width_percent = hpdftbl_calloc(t->cols, sizeof(float));
+    t->cells = hpdftbl_calloc(t->rows, t->cols * sizeof(hpdftbl_cell_t));
+    if (t->col_width_percent == NULL || t->cells == NULL) {
+        t->rows = t->cols = 0;
+        _HPDFTBL_SET_ERR(t, -5, -1, -1);
+        return -2;
+    }
+    // The position of a cell is set when it is read, see table_load_done()
+    for (size_t i = 0; i < t->rows * t->cols; i++) {
+        t->cells[i].row = CELL_NOT_LOADED;
+    }
+    GETJSON_REALARRAY(table, "col_width_percent", t->col_width_percent, t->cols);
+
+    // The styles are kept in the same order since the cells refer to them by index
+    json_t *styles = json_object_get(table, "styles");
+    size_t style_idx;
+    json_t *style_obj;
+    json_array_foreach(styles, style_idx, style_obj) {
+        hpdf_text_style_t style;
+        unsigned style_id;
+        memset(&style, 0, sizeof style);
+        GETJSON_TXTSTYLE_FIELDS(style_obj, style);
+        if (hpdftbl_add_style(t, &style, &style_id))
+            return -2;
+    }
+
+    GETJSON_DYNCB(table, label_dyncb);
+    GETJSON_DYNCB(table, content_dyncb);
+    GETJSON_DYNCB(table, post_dyncb);
+    GETJSON_DYNCB(table, canvas_dyncb);
+    GETJSON_DYNCB(table, content_style_dyncb);
+
+    return 0;
+
+    json_raise_notfound_error:
+    fprintf(stderr, "JSON Not Found: '%s'\n", json_not_found_str);
+    return -2;
+}
+
+/**
+ * @brief Populate one cell from a JSON cell object.
+ *
+ * The row and column of the cell, and of its parent cell if it is
+ * part of a spanning cell, are checked against the table dimension. The span
+ * must also be within the table and each cell may only be given once.
+ *
+ * @param t Table to populate. The cells must already have been allocated.
+ * @param obj JSON cell object
+ * @return 0 on success, -2 on a missing field, a cell or span outside the table or
+ * a cell given twice
+ */
+static int
+table_load_cell(hpdftbl_t t, json_t *obj) {
+    char *json_not_found_str = NULL;
+    size_t row = 0, col = 0;
+
+    GETJSON_REQUIRED(obj, "row");
+    GETJSON_REQUIRED(obj, "col");
+    GETJSON_UINT(obj, "row", row);
+    GETJSON_UINT(obj, "col", col);
+    if (row >= t->rows || col >= t->cols) {
+        fprintf(stderr, "JSON Cell (%zu,%zu) outside table\n", row, col);
+        _HPDFTBL_SET_ERR(t, -2, (int) row, (int) col);
+        return -2;
+    }
+
+    hpdftbl_cell_t *cell = &t->cells[_HPDFTBL_IDX(row, col)];
+    if (cell->row != CELL_NOT_LOADED) {
+        fprintf(stderr, "JSON Cell (%zu,%zu) given twice\n", row, col);
+        _HPDFTBL_SET_ERR(t, -2, (int) row, (int) col);
+        return -2;
+    }
+    cell->row = row;
+    cell->col = col;
+    GETJSON_UINT(obj, "rowspan", cell->rowspan);
+    GETJSON_UINT(obj, "colspan", cell->colspan);
+    // A span of 0 is written for a cell covered by another cell and is the same as 1
+    if (cell->rowspan > t->rows - row || cell->colspan > t->cols - col) {
+        fprintf(stderr, "JSON Cell (%zu,%zu) span %zux%zu outside table\n", row, col, cell->rowspan,
+                cell->colspan);
+        _HPDFTBL_SET_ERR(t, -2, (int) row, (int) col);
+        return -2;
+    }
+    GETJSON_STRING(obj, "label", cell->label);
+    GETJSON_STRING(obj, "content", cell->content);
+    GETJSON_REAL(obj, "height", cell->height);
+    GETJSON_REAL(obj, "width", cell->width);
+    GETJSON_REAL(obj, "delta_x", cell->delta_x);
+    GETJSON_REAL(obj, "delta_y", cell->delta_y);
+    GETJSON_REAL(obj, "textwidth", cell->textwidth);
+
+    GETJSON_CELLDYNCB(obj, content_dyncb, row, col);
+    GETJSON_CELLDYNCB(obj, label_dyncb, row, col);
+    GETJSON_CELLDYNCB(obj, content_style_dyncb, row, col);
+    GETJSON_CELLDYNCB(obj, canvas_dyncb, row, col);
+
+    GETJSON_CELLTXTSTYLE(obj, content_style, cell);
+
+    // In the compact format the cell refers to one of the table styles
+    json_t *style = json_object_get(obj, "style");
+    if (style) {
+        const size_t style_idx = (size_t) json_integer_value(style);
+        if (!json_is_integer(style) || style_idx >= t->num_styles) {
+            fprintf(stderr, "JSON Cell (%zu,%zu) style %zu not found\n", row, col, style_idx);
+            _HPDFTBL_SET_ERR(t, -2, (int) row, (int) col);
+            return -2;
+        }
+        cell->style_id = (unsigned) style_idx + 1;
+    }
+
+    json_t *parent = json_object_get(obj, "parent");
+    if (parent && json_is_object(parent)) {
+        size_t par_row = 0, par_col = 0;
+        GETJSON_REQUIRED(parent, "row");
+        GETJSON_REQUIRED(parent, "col");
+        GETJSON_UINT(parent, "row", par_row);
+        GETJSON_UINT(parent, "col", par_col);
+        if (par_row >= t->rows || par_col >= t->cols) {
+            fprintf(stderr, "JSON Parent cell (%zu,%zu) outside table\n", par_row, par_col);
+            _HPDFTBL_SET_ERR(t, -2, (int) par_row, (int) par_col);
+            return -2;
+        }
+        cell->parent_cell = &t->cells[_HPDFTBL_IDX(par_row, par_col)];
+    }
+
+    return 0;
+
+    json_raise_notfound_error:
+    fprintf(stderr, "JSON Not Found: '%s'\n", json_not_found_str);
+    return -2;
+}
+
+/**
+ * @brief Set the position of the cells that were not in the serialized table.
+ *
+ * @param t Table with all cells read
+ */
+static void
+table_load_done(hpdftbl_t t) {
+    for (size_t r = 0; r < t->rows; r++) {
+        for (size_t c = 0; c < t->cols; c++) {
+            t->cells[_HPDFTBL_IDX(r, c)].row = r;
+            t->cells[_HPDFTBL_IDX(r, c)].col = c;
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------
+ * Streaming load section.
+ *
+ * The streaming loader never builds a DOM for the whole document. It scans
+ * the top level objects by hand and lets jansson decode one member value,
+ * or one cell, at a time. Peak memory is therefore proportional to the
+ * largest single cell and not to the size of the table.
+ */
+
+/**
+ * @brief Scanner state for the streaming loader
+ */
+typedef struct json_scan {
+    const char *buff;   /**< Buffer to scan */
+    size_t len;         /**< Length of buffer */
+    size_t pos;         /**< Current scan position */
+    int line;           /**< Current line number, used in error messages */
+} json_scan_t;
+
+/**
+ * @brief Skip whitespace
+ * @param s Scanner
+ */
+static void
+scan_ws(json_scan_t *s) {
+    while (s->pos < s->len) {
+        const char c = s->buff[s->pos];
+        if (c == '\n')
+            s->line++;
+        else if (c != ' ' && c != '\t' && c != '\r')
+            break;
+        s->pos++;
+    }
+}
+
+/**
+ * @brief Skip whitespace and check if the next character is the given one. If it is it is consumed.
+ * @param s Scanner
+ * @param c Character to check for
+ * @return TRUE if character was found, FALSE otherwise
+ */
+static _Bool
+scan_accept(json_scan_t *s, char c) {
+    scan_ws(s);
+    if (s->pos < s->len && s->buff[s->pos] == c) {
+        s->pos++;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/**
+ * @brief Scan an object member name and the following ':'
+ * @param s Scanner
+ * @param key Buffer to store the name in
+ * @param keysize Size of buffer
+ * @return 0 on success, -1 on syntax error
+ */
+static int
+scan_key(json_scan_t *s, char *key, size_t keysize) {
+    if (!scan_accept(s, '"'))
+        return -1;
+    size_t n = 0;
+    while (s->pos < s->len && s->buff[s->pos] != '"') {
+        if (s->buff[s->pos] == '\\' || n + 1 >= keysize)
+            return -1;
+        key[n++] = s->buff[s->pos++];
+    }
+    if (s->pos >= s->len)
+        return -1;
+    s->pos++;
+    key[n] = '\0';
+    return scan_accept(s, ':') ? 0 : -1;
+}
+
+/**
+ * @brief Decode the next JSON value with jansson
+ * @param s Scanner
+ * @param json_error Set to the error on failure
+ * @return The decoded value (to be released with json_decref()) or NULL on error
+ */
+static json_t *
+scan_value(json_scan_t *s, json_error_t *json_error) {
+    scan_ws(s);
+    json_t *val = json_loadb(s->buff + s->pos, s->len - s->pos,
+                             JSON_DECODE_ANY | JSON_DISABLE_EOF_CHECK, json_error);
+    if (val == NULL) {
+        json_error->line += s->line - 1;
+        return NULL;
+    }
+    // With JSON_DISABLE_EOF_CHECK the position is the number of bytes consumed
+    for (size_t i = 0; i < (size_t) json_error->position; i++) {
+        if (s->buff[s->pos + i] == '\n')
+            s->line++;
+    }
+    s->pos += (size_t) json_error->position;
+    return val;
+}
+
+/**
+ * @brief Import a table from a serialized json buffer without building the full document in memory.
+ *
+ * The members of the table object are collected until the `cells` array is found.
+ * The table fields are then populated and the cells are decoded and stored one by
+ * one, each cell is checked against the table dimension as it is read. The `cells`
+ * array must therefore be the last member in the table object, which is how the
+ * table is written by hpdftbl_dump().
+ *
+ * @param t Table to populate
+ * @param buff Buffer with serialized table
+ * @param len Length of buffer
+ * @return 0 on success, -1 on parse error, -2 on any other error
+ */
+static int
+table_stream_loadb(hpdftbl_t t, const char *buff, size_t len) {
+    char *json_not_found_str = NULL;
+    json_error_t json_error;
+    json_scan_t scan = {buff, len, 0, 1};
+    json_scan_t *s = &scan;
+    char key[64];
+    json_t *table = NULL;
+    json_t *val;
+    _Bool have_version = FALSE;
+
+    snprintf(json_error.text, sizeof(json_error.text), "%s", "Syntax error");
+
+    if (!scan_accept(s, '{'))
+        goto json_raise_syntax_error;
+
+    do {
+        if (scan_key(s, key, sizeof key))
+            goto json_raise_syntax_error;
+
+        if (0 == strcmp(key, "table")) {
+            if (!have_version) {
+                json_not_found_str = "version";
+                goto json_raise_notfound_error;
+            }
+            // A second table would be read over the cells and strings of the first
+            if (t->cells) {
+                fprintf(stderr, "JSON Member 'table' given twice at line %d\n", s->line);
+                _HPDFTBL_SET_ERR(t, -2, -1, -1);
+                goto json_raise_error;
+            }
+            if (!scan_accept(s, '{'))
+                goto json_raise_syntax_error;
+
+            // Collect the scalar members of the table until the cells are found
+            table = json_object();
+            if (table == NULL) {
+                _HPDFTBL_SET_ERR(t, -5, -1, -1);
+                goto json_raise_error;
+            }
+            for (;;) {
+                if (scan_key(s, key, sizeof key))
+                    goto json_raise_syntax_error;
+                if (0 == strcmp(key, "cells"))
+                    break;
+                if ((val = scan_value(s, &json_error)) == NULL)
+                    goto json_raise_parse_error;
+                json_object_set_new(table, key, val);
+                if (!scan_accept(s, ',')) {
+                    json_not_found_str = "cells";
+                    goto json_raise_notfound_error;
+                }
+            }
+
+            if (table_load_fields(t, table))
+                goto json_raise_error;
+            json_decref(table);
+            table = NULL;
+
+            if (!scan_accept(s, '['))
+                goto json_raise_syntax_error;
+            if (!scan_accept(s, ']')) {
+                do {
+                    if ((val = scan_value(s, &json_error)) == NULL)
+                        goto json_raise_parse_error;
+                    const int ret = table_load_cell(t, val);
+                    json_decref(val);
+                    if (ret)
+                        goto json_raise_error;
+                } while (scan_accept(s, ','));
+                if (!scan_accept(s, ']'))
+                    goto json_raise_syntax_error;
+            }
+            table_load_done(t);
+            if (!scan_accept(s, '}'))
+                goto json_raise_syntax_error;
+        } else {
+            if ((val = scan_value(s, &json_error)) == NULL)
+                goto json_raise_parse_error;
+            if (0 == strcmp(key, "version")) {
+                if (json_integer_value(val) != TABLE_JSON_VERSION) {
+                    json_decref(val);
+                    json_not_found_str = "version";
+                    goto json_raise_notfound_error;
+                }
+                have_version = TRUE;
+            }
+            json_decref(val);
+        }
+    } while (scan_accept(s, ','));
+
+    if (!scan_accept(s, '}'))
+        goto json_raise_syntax_error;
+
+    if (t->cells == NULL) {
+        json_not_found_str = "table";
+        goto json_raise_notfound_error;
+    }
+    return 0;
+
+    json_raise_notfound_error:
+    fprintf(stderr, "JSON Not Found: '%s'\n", json_not_found_str);
+    json_raise_error:
+    json_decref(table);
+    hpdftbl_destroy(t);
+    return -2;
+    json_raise_syntax_error:
+    json_error.line = s->line;
+    json_raise_parse_error:
+    fprintf(stderr, "JSON Err: '%s' at line %d\n", json_error.text, json_error.line);
+    json_decref(table);
+    hpdftbl_destroy(t);
+    return -1;
+}
+
+/**
+ * @brief Import a table structure from a serialized json buffer with the streaming loader.
+ *
+ * This is functionally the same as hpdftbl_loads() but the full JSON document is never
+ * built in memory. Instead each cell is decoded, checked and stored in the table as the
+ * `cells` array is read. This keeps the peak memory usage during load independent of the
+ * table size and is the preferred way to read large tables.
+ *
+ * The streaming loader requires that the `cells` array is the last member of the table
+ * object which is always the case for tables serialized with hpdftbl_dump() or hpdftbl_dumps().
+ *
+ * @param tbl Reference to table handle to be populated
+ * @param buff Buffer with serialized data to read back
+ * @return 0 on success, -1 on file parse error, -2 on any other error
+ * @see hpdftbl_stream_load(), hpdftbl_loads()
+ */
+int
+hpdftbl_stream_loads(hpdftbl_t tbl, char *buff) {
+    return table_stream_loadb(tbl, buff, strlen(buff));
+}
+
+/**
+ * @brief Import a table structure from a serialized table on file with the streaming loader.
+ *
+ * The file is memory mapped and read with the same streaming loader as hpdftbl_stream_loads().
+ *
+ * @param tbl Table to read into
+ * @param filename File to read from
+ * @return  0 on success, -1 on failure
+ * @see hpdftbl_stream_loads(), hpdftbl_load()
+ */
+int
+hpdftbl_stream_load(hpdftbl_t tbl, char *filename) {
+    char *buff;
+    size_t size;
+
+    if (0 != hpdftbl_map_file(filename, &buff, &size))
+        return -1;
+
+    int ret = table_stream_loadb(tbl, buff, size);
+    hpdftbl_unmap_file(buff, size);
+    return 0 == ret ? 0 : -1;
+}
 
 #ifndef _MSC_VER
 #pragma GCC diagnostic pop
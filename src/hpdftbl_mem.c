@@ -0,0 +1,213 @@
+/**
+ * @file
+ * @brief   Memory allocation and accounting
+ * @author   Johan Persson (johan162@gmail.com)
+ *
+ * Copyright (C) 2022 Johan Persson
+ *
+ * @see LICENSE
+ *
+ * Released under the MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <hpdf.h>
+#include "hpdftbl.h"
+
+/** The allocation function used for all memory allocated by the library */
+static hpdftbl_malloc_func_t do_malloc = malloc;
+
+/** The reallocation function used for all memory allocated by the library */
+static hpdftbl_realloc_func_t do_realloc = realloc;
+
+/** The release function used for all memory allocated by the library */
+static hpdftbl_free_func_t do_free = free;
+
+/**
+ * @brief Set custom memory allocation functions.
+ *
+ * All memory allocated by the library, for tables, cells, strings, themes and caches, is
+ * allocated and released with these functions. This makes it possible to, for example, track
+ * and cap the memory used for each request in a server. Memory allocated by libharu, iconv and
+ * jansson is not affected.
+ *
+ * The functions must be set before any memory is allocated by the library and must not be
+ * changed as long as any memory allocated with the previous functions is still in use.
+ * Memory that is passed to the library and released by it, e.g. a table allocated by the
+ * caller for hpdftbl_load(), must then be allocated with hpdftbl_calloc() and memory that is
+ * returned by the library, e.g. the image from hpdftbl_dumpb(), must be released with hpdftbl_free().
+ *
+ * @code
+ * static _Thread_local size_t used;
+ *
+ * static void *
+ * capped_malloc(size_t size) {
+ *     size_t *p = NULL;
+ *     if (used + size <= MAX_REQUEST_MEMORY && (p = malloc(sizeof(size_t) + size))) {
+ *         *p = size;
+ *         used += size;
+ *         p++;
+ *     }
+ *     return p;
+ * }
+ * ...
+ * hpdftbl_set_alloc_funcs(capped_malloc, capped_realloc, capped_free);
+ * @endcode
+ *
+ * @param malloc_fn Allocation function
+ * @param realloc_fn Reallocation function
+ * @param free_fn Release function
+ * @return 0 on success, -1 on failure. Either all or none of the functions must be NULL. If all
+ * are NULL the standard `malloc()`, `realloc()` and `free()` are used again.
+ * @see hpdftbl_get_alloc_funcs()
+ */
+int
+hpdftbl_set_alloc_funcs(hpdftbl_malloc_func_t malloc_fn, hpdftbl_realloc_func_t realloc_fn,
+                        hpdftbl_free_func_t free_fn) {
+    if (NULL == malloc_fn && NULL == realloc_fn && NULL == free_fn) {
+        do_malloc = malloc;
+        do_realloc = realloc;
+        do_free = free;
+        return 0;
+    }
+    if (NULL == malloc_fn || NULL == realloc_fn || NULL == free_fn) {
+        _HPDFTBL_SET_ERR(NULL, -18, -1, -1);
+        return -1;
+    }
+    do_malloc = malloc_fn;
+    do_realloc = realloc_fn;
+    do_free = free_fn;
+    return 0;
+}
+
+/**
+ * @brief Get the memory allocation functions in use.
+ *
+ * @param[out] malloc_fn Allocation function, may be NULL
+ * @param[out] realloc_fn Reallocation function, may be NULL
+ * @param[out] free_fn Release function, may be NULL
+ * @see hpdftbl_set_alloc_funcs()
+ */
+void
+hpdftbl_get_alloc_funcs(hpdftbl_malloc_func_t *malloc_fn, hpdftbl_realloc_func_t *realloc_fn,
+                        hpdftbl_free_func_t *free_fn) {
+    if (malloc_fn)
+        *malloc_fn = do_malloc;
+    if (realloc_fn)
+        *realloc_fn = do_realloc;
+    if (free_fn)
+        *free_fn = do_free;
+}
+
+/**
+ * @brief Allocate memory with the library allocation function.
+ *
+ * @param size Number of bytes
+ * @return Pointer to the allocated memory, NULL if out of memory
+ * @see hpdftbl_set_alloc_funcs(), hpdftbl_free()
+ */
+void *
+hpdftbl_malloc(size_t size) {
+    return do_malloc(size);
+}
+
+/**
+ * @brief Allocate zero initialized memory with the library allocation function.
+ *
+ * @param num Number of elements
+ * @param size Size of each element
+ * @return Pointer to the allocated memory, NULL if out of memory
+ * @see hpdftbl_set_alloc_funcs(), hpdftbl_free()
+ */
+void *
+hpdftbl_calloc(size_t num, size_t size) {
+    if (size > 0 && num > SIZE_MAX / size)
+        return NULL;
+    void *p = do_malloc(num * size);
+    if (p)
+        memset(p, 0, num * size);
+    return p;
+}
+
+/**
+ * @brief Change the size of memory allocated with the library allocation function.
+ *
+ * @param ptr Previously allocated memory or NULL
+ * @param size New size in bytes
+ * @return Pointer to the reallocated memory, NULL if out of memory in which case the
+ * original memory is unchanged
+ * @see hpdftbl_set_alloc_funcs(), hpdftbl_free()
+ */
+void *
+hpdftbl_realloc(void *ptr, size_t size) {
+    return do_realloc(ptr, size);
+}
+
+/**
+ * @brief Duplicate a string with the library allocation function.
+ *
+ * @param s String to duplicate
+ * @return The new string, NULL if out of memory
+ * @see hpdftbl_set_alloc_funcs(), hpdftbl_free()
+ */
+char *
+hpdftbl_strdup(const char *s) {
+    const size_t len = strlen(s) + 1;
+#ifdef __cplusplus
+    char *d = static_cast<char*>(do_malloc(len));
+#else
+    char *d = do_malloc(len);
+#endif
+    if (d)
+        memcpy(d, s, len);
+    return d;
+}
+
+/**
+ * @brief Release memory allocated with the library allocation function.
+ *
+ * @param ptr Memory to release, may be NULL
+ * @see hpdftbl_set_alloc_funcs(), hpdftbl_malloc()
+ */
+void
+hpdftbl_free(void *ptr) {
+    if (ptr)
+        do_free(ptr);
+}
+
+/**
+ * @brief Get the number of bytes allocated by the library caches.
+ *
+ * This is the memory used by the glyph metrics cache and the widget cache. The memory is
+ * shared by all tables and is released with hpdftbl_clear_glyph_cache() and
+ * hpdftbl_clear_widget_cache(). There is no cache for the text encoding.
+ *
+ * @return Number of allocated bytes
+ * @see hpdftbl_get_memory_usage()
+ */
+size_t
+hpdftbl_get_cache_memory_usage(void) {
+    return hpdftbl_glyph_cache_memory_usage() + hpdftbl_widget_cache_memory_usage();
+}
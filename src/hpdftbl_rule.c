@@ -0,0 +1,331 @@
+/**
+ * @file
+ * @brief   Conditional formatting rules
+ * @author   Johan Persson (johan162@gmail.com)
+ *
+ * Copyright (C) 2022 Johan Persson
+ *
+ * @see LICENSE
+ *
+ * Released under the MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+#include <hpdf.h>
+#include "hpdftbl.h"
+
+/**
+ * @brief Set the conditional formatting rules for a table
+ *
+ * The rules are evaluated once for every cell, apart from the header row, when the
+ * table is stroked. A rule matches a cell in its scope when the predicate is true for
+ * the content of the cell and then sets the parts of the cell content style given by
+ * `apply`. All matching rules are applied in order. The background of a matching rule
+ * is drawn on top of the zebra rows.
+ *
+ * A style callback that returns TRUE for a cell takes precedence over the rules.
+ * The rules array is not copied and must be kept for as long as the table is used. The
+ * rules set on a table override the rules in a shared theme.
+ *
+ * @param t Table handle
+ * @param rules Array of rules or NULL to remove all rules
+ * @param num_rules Number of rules in the array
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_rule_t, hpdftbl_apply_theme()
+ */
+int
+hpdftbl_set_rules(hpdftbl_t t, const hpdftbl_rule_t *rules, size_t num_rules) {
+    _HPDFTBL_CHK_TABLE(t);
+    if (NULL == rules && num_rules > 0) {
+        _HPDFTBL_SET_ERR(t, -9, -1, -1);
+        return -1;
+    }
+    t->rules = rules;
+    t->num_rules = rules ? num_rules : 0;
+    t->theme_override |= THEME_OVR_RULES;
+    return 0;
+}
+
+/**
+ * @brief Internal function. Make a copy of an array of rules.
+ *
+ * The string operands and font names are copied as well.
+ *
+ * @param src Rules to copy
+ * @param num_rules Number of rules
+ * @param[out] dst Set to the new array, NULL if there are no rules
+ * @return 0 on success, -1 on out of memory
+ * @see hpdftbl_rules_free()
+ */
+int
+hpdftbl_rules_copy(const hpdftbl_rule_t *src, size_t num_rules, hpdftbl_rule_t **dst) {
+    *dst = NULL;
+    if (NULL == src || 0 == num_rules)
+        return 0;
+
+#ifdef __cplusplus
+    hpdftbl_rule_t *rules = static_cast<hpdftbl_rule_t *>(hpdftbl_calloc(num_rules, sizeof(hpdftbl_rule_t)));
+#else
+    hpdftbl_rule_t *rules = hpdftbl_calloc(num_rules, sizeof(hpdftbl_rule_t));
+#endif
+    if (NULL == rules) {
+        _HPDFTBL_SET_ERR(NULL, -5, -1, -1);
+        return -1;
+    }
+
+    for (size_t i = 0; i < num_rules; i++) {
+        rules[i] = src[i];
+        rules[i].str = NULL;
+        rules[i].style.font = NULL;
+        if ((src[i].str && NULL == (rules[i].str = hpdftbl_strdup(src[i].str))) ||
+            (src[i].style.font && NULL == (rules[i].style.font = hpdftbl_strdup(src[i].style.font)))) {
+            hpdftbl_rules_free(rules, i + 1);
+            _HPDFTBL_SET_ERR(NULL, -5, -1, -1);
+            return -1;
+        }
+    }
+    *dst = rules;
+    return 0;
+}
+
+/**
+ * @brief Internal function. Free an array of rules made by hpdftbl_rules_copy() or read by a loader.
+ *
+ * @param rules Rules to free
+ * @param num_rules Number of rules
+ */
+void
+hpdftbl_rules_free(hpdftbl_rule_t *rules, size_t num_rules) {
+    if (NULL == rules)
+        return;
+    for (size_t i = 0; i < num_rules; i++) {
+        hpdftbl_free(rules[i].str);
+        hpdftbl_free(rules[i].style.font);
+    }
+    hpdftbl_free(rules);
+}
+
+/**
+ * @brief Internal function. Parse cell content as a number.
+ *
+ * Leading and trailing white space is allowed but nothing else.
+ *
+ * @param content Cell content, may be NULL
+ * @param[out] val The number
+ * @return TRUE if the content is a number, FALSE otherwise
+ */
+static _Bool
+rule_number(const char *content, double *val) {
+    if (NULL == content)
+        return FALSE;
+    char *end;
+    *val = strtod(content, &end);
+    if (end == content)
+        return FALSE;
+    while (isspace((unsigned char) *end))
+        end++;
+    return '\0' == *end;
+}
+
+/**
+ * @brief Internal function. Check if a column is in the scope of a rule.
+ *
+ * @param rule The rule
+ * @param c Column
+ * @return TRUE if the rule applies to the column
+ */
+static _Bool
+rule_in_scope(const hpdftbl_rule_t *rule, size_t c) {
+    return rule->col < 0 || (size_t) rule->col == c;
+}
+
+/**
+ * @brief Internal function. Compare two numbers for qsort()
+ */
+static int
+cmp_double(const void *a, const void *b) {
+    const double x = *(const double *) a;
+    const double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Internal function. Calculate the limits of the ranking rules of a table.
+ *
+ * The RULE_TOP_N and RULE_BOTTOM_N rules depend on all cells in their scope. This
+ * is done in bulk, once before the table is stroked, by sorting the numbers in
+ * the scope of each ranking rule. A cell then matches the rule if its number is
+ * on the right side of the limit. Ties with the limit are included.
+ *
+ * @param t Table handle
+ * @param[out] limits Set to an array with one limit per rule or NULL if the table has no
+ * ranking rules. Free with hpdftbl_free().
+ * @return 0 on success, -1 on out of memory
+ * @see hpdftbl_rules_apply()
+ */
+int
+hpdftbl_rules_prepare(hpdftbl_t t, double **limits) {
+    *limits = NULL;
+
+    _Bool has_rank = FALSE;
+    for (size_t i = 0; i < t->num_rules; i++) {
+        if (RULE_TOP_N == t->rules[i].op || RULE_BOTTOM_N == t->rules[i].op)
+            has_rank = TRUE;
+    }
+    if (!has_rank)
+        return 0;
+
+#ifdef __cplusplus
+    double *lim = static_cast<double *>(hpdftbl_calloc(t->num_rules, sizeof(double)));
+    double *vals = static_cast<double *>(hpdftbl_calloc(t->rows * t->cols, sizeof(double)));
+#else
+    double *lim = hpdftbl_calloc(t->num_rules, sizeof(double));
+    double *vals = hpdftbl_calloc(t->rows * t->cols, sizeof(double));
+#endif
+    if (NULL == lim || NULL == vals) {
+        hpdftbl_free(lim);
+        hpdftbl_free(vals);
+        _HPDFTBL_SET_ERR(t, -5, -1, -1);
+        return -1;
+    }
+
+    for (size_t i = 0; i < t->num_rules; i++) {
+        const hpdftbl_rule_t *rule = &t->rules[i];
+        lim[i] = NAN;
+        if (RULE_TOP_N != rule->op && RULE_BOTTOM_N != rule->op)
+            continue;
+
+        size_t num_vals = 0;
+        for (size_t r = t->use_header_row ? 1 : 0; r < t->rows; r++) {
+            for (size_t c = 0; c < t->cols; c++) {
+                hpdftbl_cell_t *cell = &t->cells[_HPDFTBL_IDX(r, c)];
+                if (cell->parent_cell == NULL && rule_in_scope(rule, c) &&
+                    rule_number(hpdftbl_cell_content(t, cell, r, c), &vals[num_vals]))
+                    num_vals++;
+            }
+        }
+
+        size_t n = rule->value > 0 ? (size_t) rule->value : 0;
+        if (n > num_vals)
+            n = num_vals;
+        if (0 == n)
+            continue;
+        qsort(vals, num_vals, sizeof(double), cmp_double);
+        lim[i] = RULE_TOP_N == rule->op ? vals[num_vals - n] : vals[n - 1];
+    }
+
+    hpdftbl_free(vals);
+    *limits = lim;
+    return 0;
+}
+
+/**
+ * @brief Internal function. Apply the conditional formatting rules to a cell.
+ *
+ * @param t Table handle
+ * @param limits Limits for the ranking rules as calculated by hpdftbl_rules_prepare()
+ * @param r Row
+ * @param c Column
+ * @param content Content of the cell, may be NULL
+ * @param[in,out] style The style of the cell which is updated by the matching rules
+ * @return The parts of the style that were set by the matching rules as a bitmask of
+ * hpdftbl_rule_apply_t, 0 if no rule matched
+ * @see hpdftbl_rules_prepare()
+ */
+unsigned
+hpdftbl_rules_apply(hpdftbl_t t, const double *limits, size_t r, size_t c, const char *content,
+                    hpdf_text_style_t *style) {
+    if (t->use_header_row && 0 == r)
+        return 0;
+
+    unsigned applied = 0;
+    double val = 0;
+    const _Bool is_number = rule_number(content, &val);
+    const char *str = content ? content : "";
+
+    for (size_t i = 0; i < t->num_rules; i++) {
+        const hpdftbl_rule_t *rule = &t->rules[i];
+        if (!rule_in_scope(rule, c))
+            continue;
+
+        _Bool match = FALSE;
+        switch (rule->op) {
+            case RULE_LT:
+                match = is_number && val < rule->value;
+                break;
+            case RULE_LE:
+                match = is_number && val <= rule->value;
+                break;
+            case RULE_GT:
+                match = is_number && val > rule->value;
+                break;
+            case RULE_GE:
+                match = is_number && val >= rule->value;
+                break;
+            case RULE_EQ:
+                match = is_number && val == rule->value;
+                break;
+            case RULE_NE:
+                match = is_number && val != rule->value;
+                break;
+            case RULE_BETWEEN:
+                match = is_number && val >= rule->value && val <= rule->value2;
+                break;
+            case RULE_STR_EQ:
+                match = rule->str && 0 == strcmp(str, rule->str);
+                break;
+            case RULE_STR_CONTAINS:
+                match = rule->str && NULL != strstr(str, rule->str);
+                break;
+            case RULE_STR_PREFIX:
+                match = rule->str && 0 == strncmp(str, rule->str, strlen(rule->str));
+                break;
+            case RULE_TOP_N:
+                match = is_number && limits && val >= limits[i];
+                break;
+            case RULE_BOTTOM_N:
+                match = is_number && limits && val <= limits[i];
+                break;
+        }
+        if (!match)
+            continue;
+
+        applied |= rule->apply;
+        if (rule->apply & RULE_SET_FONT) {
+            if (rule->style.font)
+                style->font = rule->style.font;
+            if (rule->style.fsize > 0)
+                style->fsize = rule->style.fsize;
+        }
+        if (rule->apply & RULE_SET_COLOR)
+            style->color = rule->style.color;
+        if (rule->apply & RULE_SET_BACKGROUND)
+            style->background = rule->style.background;
+        if (rule->apply & RULE_SET_HALIGN)
+            style->halign = rule->style.halign;
+    }
+    return applied;
+}
@@ -0,0 +1,286 @@
+/**
+ * @file
+ * @brief   Instrumentation and render statistics of the stroking of tables
+ * @author   Johan Persson (johan162@gmail.com)
+ *
+ * Copyright (C) 2022 Johan Persson
+ *
+ * @see LICENSE
+ *
+ * Released under the MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <hpdf.h>
+#include "hpdftbl.h"
+
+/**
+ * @brief The counters of the instrumented operations.
+ *
+ * The counters are kept per thread in the same way as the error state.
+ */
+static HPDFTBL_THREAD_LOCAL hpdftbl_stat_t stats[STAT_NUM_COUNTERS];
+
+/**
+ * @brief Names of the counters as used in the JSON dump
+ */
+static const char *stat_names[STAT_NUM_COUNTERS] = {
+        "draw",
+        "layout",
+        "content_cb",
+        "label_cb",
+        "style_cb",
+        "canvas_cb",
+        "text_encoding",
+        "font_switch",
+        "grid",
+        "background"
+};
+
+/**
+ * @brief Check if the library is built with instrumentation.
+ *
+ * The instrumentation is enabled with `--enable-stats` when the library is configured.
+ * When it is not enabled the instrumented operations are compiled without any
+ * overhead and all counters are always zero.
+ *
+ * @return TRUE if the library is built with instrumentation, FALSE otherwise
+ * @see hpdftbl_get_stat()
+ */
+_Bool
+hpdftbl_stats_enabled(void) {
+#ifdef HPDFTBL_ENABLE_STATS
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+/**
+ * @brief Get the counter for an instrumented operation.
+ *
+ * The counters are accumulated for all tables stroked in the calling thread since
+ * the start of the program or the last call to hpdftbl_reset_stats(). The time spent in
+ * an operation includes the time of any instrumented operation it uses, e.g. the time for
+ * STAT_DRAW includes the time of all grid lines.
+ *
+ * @code
+ * hpdftbl_stat_t stat;
+ * hpdftbl_get_stat(STAT_TEXT_ENCODING, &stat);
+ * printf("%lu strings in %.3f ms\n", stat.calls, stat.seconds * 1000);
+ * @endcode
+ *
+ * @param id The operation
+ * @param stat Returned counter
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_stats_enabled(), hpdftbl_reset_stats(), hpdftbl_stats_dumps()
+ */
+int
+hpdftbl_get_stat(hpdftbl_stat_id_t id, hpdftbl_stat_t *stat) {
+    if ((unsigned) id >= STAT_NUM_COUNTERS || NULL == stat) {
+        _HPDFTBL_SET_ERR(NULL, -18, -1, -1);
+        return -1;
+    }
+    *stat = stats[id];
+    return 0;
+}
+
+/**
+ * @brief Get the name of an instrumented operation.
+ *
+ * @param id The operation
+ * @return The name as used in the JSON dump, NULL if the operation is not known
+ * @see hpdftbl_stats_dumps()
+ */
+const char *
+hpdftbl_get_stat_name(hpdftbl_stat_id_t id) {
+    return (unsigned) id < STAT_NUM_COUNTERS ? stat_names[id] : NULL;
+}
+
+/**
+ * @brief Reset all counters in the calling thread.
+ *
+ * @see hpdftbl_get_stat()
+ */
+void
+hpdftbl_reset_stats(void) {
+    memset(stats, 0, sizeof(stats));
+}
+
+/**
+ * @brief Write the counters as JSON to a string buffer.
+ *
+ * The counters are written as one object for each operation with the number of calls,
+ * the number of PDF operators and the cumulative time in seconds, e.g.
+ *
+ * @code
+ * {"enabled": true, "stats": {"draw": {"calls": 1, "ops": 0, "seconds": 0.000412}, ...}}
+ * @endcode
+ *
+ * @param buff Buffer to write the JSON to. 1k is enough for all counters.
+ * @param buffsize Buffer size (including ending string NULL)
+ * @return 0 on success, -1 if the buffer is too small
+ * @see hpdftbl_stats_dump(), hpdftbl_get_stat()
+ */
+int
+hpdftbl_stats_dumps(char *buff, size_t buffsize) {
+    int n = snprintf(buff, buffsize, "{\"enabled\": %s, \"stats\": {", hpdftbl_stats_enabled() ? "true" : "false");
+    size_t len = n < 0 ? buffsize : (size_t) n;
+    for (size_t i = 0; i < STAT_NUM_COUNTERS && len < buffsize; i++) {
+        n = snprintf(buff + len, buffsize - len, "%s\"%s\": {\"calls\": %lu, \"ops\": %lu, \"seconds\": %.6f}",
+                     i > 0 ? ", " : "", stat_names[i], stats[i].calls, stats[i].ops, stats[i].seconds);
+        len = n < 0 ? buffsize : len + (size_t) n;
+    }
+    if (len < buffsize) {
+        n = snprintf(buff + len, buffsize - len, "}}");
+        len = n < 0 ? buffsize : len + (size_t) n;
+    }
+    if (len >= buffsize) {
+        _HPDFTBL_SET_ERR(NULL, -18, -1, -1);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Write the counters as JSON to a file.
+ *
+ * @param filename Name of file to write to
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_stats_dumps()
+ */
+int
+hpdftbl_stats_dump(char *filename) {
+    char buff[1024];
+    if (-1 == hpdftbl_stats_dumps(buff, sizeof(buff)))
+        return -1;
+
+    FILE *fh = fopen(filename, "w");
+    if (!fh)
+        return -1;
+    fprintf(fh, "%s\n", buff);
+    fclose(fh);
+    return 0;
+}
+
+/**
+ * @brief Get the statistics for the last rendering of a table.
+ *
+ * The statistics are always collected, independent of the instrumentation counters, and
+ * are cheap enough to be logged for every table in production. They are reset when the
+ * layout of the table is calculated by hpdftbl_stroke() or hpdftbl_layout(). A table stroked with
+ * hpdftbl_stroke_layout() adds to the statistics from the layout.
+ *
+ * @code
+ * hpdftbl_render_stats_t stats;
+ * hpdftbl_stroke(pdf_doc, pdf_page, tbl, xpos, ypos, width, 0);
+ * hpdftbl_get_render_stats(tbl, &stats);
+ * if (stats.encoding_errors > 0) {
+ *     // Some text was written as "???"
+ * }
+ * @endcode
+ *
+ * @param t Table handle
+ * @param stats Returned statistics
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_render_stats_dumps()
+ */
+int
+hpdftbl_get_render_stats(hpdftbl_t t, hpdftbl_render_stats_t *stats) {
+    _HPDFTBL_CHK_TABLE(t);
+    if (NULL == stats) {
+        _HPDFTBL_SET_ERR(t, -18, -1, -1);
+        return -1;
+    }
+    *stats = t->stats;
+    return 0;
+}
+
+/**
+ * @brief Write the statistics for the last rendering of a table as JSON to a string buffer.
+ *
+ * The statistics are written on one line as a JSON object with the same field names as in
+ * hpdftbl_render_stats_t, e.g.
+ *
+ * @code
+ * {"cells": 40, "spanned_cells": 2, "content_cb_calls": 40, ... , "fill_ops": 21}
+ * @endcode
+ *
+ * @param t Table handle
+ * @param buff Buffer to write the JSON to. 512 bytes is always enough.
+ * @param buffsize Buffer size (including ending string NULL)
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_get_render_stats()
+ */
+int
+hpdftbl_render_stats_dumps(hpdftbl_t t, char *buff, size_t buffsize) {
+    _HPDFTBL_CHK_TABLE(t);
+    const hpdftbl_render_stats_t *st = &t->stats;
+    const int n = snprintf(buff, buffsize,
+                           "{\"cells\": %zu, \"spanned_cells\": %zu, \"content_cb_calls\": %zu, "
+                           "\"label_cb_calls\": %zu, \"style_cb_calls\": %zu, \"canvas_cb_calls\": %zu, "
+                           "\"text_bytes\": %zu, \"encoding_errors\": %zu, \"font_changes\": %zu, "
+                           "\"color_changes\": %zu, \"path_ops\": %zu, \"fill_ops\": %zu}",
+                           st->cells, st->spanned_cells, st->content_cb_calls, st->label_cb_calls,
+                           st->style_cb_calls, st->canvas_cb_calls, st->text_bytes, st->encoding_errors,
+                           st->font_changes, st->color_changes, st->path_ops, st->fill_ops);
+    if (n < 0 || (size_t) n >= buffsize) {
+        _HPDFTBL_SET_ERR(t, -18, -1, -1);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Internal function. Get the current time used to measure an operation.
+ *
+ * @return Time in seconds from an arbitrary starting point
+ * @see _HPDFTBL_STAT_BEGIN()
+ */
+double
+hpdftbl_stat_clock(void) {
+#ifdef _WIN32
+    return (double) clock() / CLOCKS_PER_SEC;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+#endif
+}
+
+/**
+ * @brief Internal function. Add a measured operation to its counter.
+ *
+ * @param id The operation
+ * @param nops Number of PDF operators written by the operation
+ * @param start Time when the operation started as returned by hpdftbl_stat_clock()
+ * @see _HPDFTBL_STAT_END()
+ */
+void
+hpdftbl_stat_add(hpdftbl_stat_id_t id, unsigned long nops, double start) {
+    stats[id].calls++;
+    stats[id].ops += nops;
+    stats[id].seconds += hpdftbl_stat_clock() - start;
+}
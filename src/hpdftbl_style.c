@@ -0,0 +1,138 @@
+/**
+ * @file
+ * @brief   Interned cell content styles
+ * @author   Johan Persson (johan162@gmail.com)
+ *
+ * Copyright (C) 2022 Johan Persson
+ *
+ * @see LICENSE
+ *
+ * Released under the MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <hpdf.h>
+#include "hpdftbl.h"
+
+/**
+ * @brief Initial number of entries in the style pool of a table
+ */
+#define STYLE_POOL_INIT_SIZE 8
+
+/**
+ * @brief Internal function. Compare two text styles.
+ *
+ * Font names are compared by value since the same font name can be stored in
+ * different strings.
+ *
+ * @param a First style
+ * @param b Second style
+ * @return TRUE if the styles are equal, FALSE otherwise
+ */
+static _Bool
+style_eq(const hpdf_text_style_t *a, const hpdf_text_style_t *b) {
+    if (a->fsize != b->fsize || a->halign != b->halign ||
+        a->color.r != b->color.r || a->color.g != b->color.g || a->color.b != b->color.b ||
+        a->background.r != b->background.r || a->background.g != b->background.g ||
+        a->background.b != b->background.b)
+        return FALSE;
+    if (a->font == b->font)
+        return TRUE;
+    return a->font && b->font && 0 == strcmp(a->font, b->font);
+}
+
+/**
+ * @brief Internal function. Add a style to the style pool of a table without checking for duplicates.
+ *
+ * This is used by the loaders where the order of the styles in the serialized table must
+ * be kept since the cells refer to the styles by their position.
+ *
+ * @param t Table handle
+ * @param style Style to add. The style is copied but the font name is only referenced.
+ * @param[out] id Set to the style id of the added style
+ * @return 0 on success, -1 on out of memory
+ * @see hpdftbl_intern_style()
+ */
+int
+hpdftbl_add_style(hpdftbl_t t, const hpdf_text_style_t *style, unsigned *id) {
+    _HPDFTBL_CHK_TABLE(t);
+    if (t->num_styles == t->styles_size) {
+        const size_t new_size = t->styles_size ? 2 * t->styles_size : STYLE_POOL_INIT_SIZE;
+#ifdef __cplusplus
+        hpdf_text_style_t *styles = static_cast<hpdf_text_style_t *>(hpdftbl_realloc(t->styles, new_size * sizeof(hpdf_text_style_t)));
+#else
+        hpdf_text_style_t *styles = hpdftbl_realloc(t->styles, new_size * sizeof(hpdf_text_style_t));
+#endif
+        if (NULL == styles) {
+            _HPDFTBL_SET_ERR(t, -5, -1, -1);
+            return -1;
+        }
+        t->styles = styles;
+        t->styles_size = new_size;
+    }
+    t->styles[t->num_styles++] = *style;
+    *id = (unsigned) t->num_styles;
+    return 0;
+}
+
+/**
+ * @brief Internal function. Get the id of a style in the style pool of a table.
+ *
+ * Each distinct cell content style is only stored once in the table and cells refer to it
+ * with a style id. If the style is not already in the pool it is added. Style ids start at 1,
+ * style id 0 in a cell means that the cell uses the table content style.
+ *
+ * @param t Table handle
+ * @param style Style to look up. The style is copied but the font name is only referenced.
+ * @param[out] id Set to the style id
+ * @return 0 on success, -1 on out of memory
+ * @see hpdftbl_cell_style()
+ */
+int
+hpdftbl_intern_style(hpdftbl_t t, const hpdf_text_style_t *style, unsigned *id) {
+    _HPDFTBL_CHK_TABLE(t);
+    // Most tables only have a handful of distinct styles so a linear search is sufficient
+    for (size_t i = 0; i < t->num_styles; i++) {
+        if (style_eq(&t->styles[i], style)) {
+            *id = (unsigned) i + 1;
+            return 0;
+        }
+    }
+    return hpdftbl_add_style(t, style, id);
+}
+
+/**
+ * @brief Internal function. Get the own content style of a cell.
+ *
+ * @param t Table handle
+ * @param cell The cell
+ * @return The content style of the cell or NULL if the cell uses the table content style
+ * @see hpdftbl_set_cell_content_style()
+ */
+const hpdf_text_style_t *
+hpdftbl_cell_style(hpdftbl_t t, const hpdftbl_cell_t *cell) {
+    if (0 == cell->style_id || cell->style_id > t->num_styles)
+        return NULL;
+    return &t->styles[cell->style_id - 1];
+}
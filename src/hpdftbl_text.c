@@ -0,0 +1,385 @@
+/**
+ * @file
+ * @brief   Text measurement with cached glyph metrics
+ * @author   Johan Persson (johan162@gmail.com)
+ *
+ * Copyright (C) 2022 Johan Persson
+ *
+ * @see LICENSE
+ *
+ * Released under the MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include <hpdf.h>
+#include "hpdftbl.h"
+
+/*-----------------------------------------------------------------------
+ * Glyph metrics cache.
+ *
+ * Measuring text with HPDF_Page_TextWidth() requires the font to be set on
+ * the page and walks through the libharu font objects for every call. Since
+ * the table layout measures every cell the advance width of all 256 byte
+ * values are instead read once per font and kept in a small cache. A text
+ * width is then just a sum over a lookup table.
+ *
+ * The cache is kept per thread so tables can be stroked concurrently in
+ * different threads without any locking.
+ */
+
+/**
+ * @brief Cached advance widths for one font
+ */
+typedef struct glyph_metrics {
+    char *fontname;                         /**< Name of font */
+    char *encoding;                         /**< Encoding the font was loaded with */
+    HPDF_UINT16 widths[256];                /**< Advance width for each byte value in 1/1000 of the font size */
+} glyph_metrics_t;
+
+/** The cached fonts */
+static HPDFTBL_THREAD_LOCAL glyph_metrics_t glyph_cache[HPDFTBL_GLYPH_CACHE_SIZE];
+
+/** Next cache slot to use when the cache is full */
+static HPDFTBL_THREAD_LOCAL size_t glyph_cache_next = 0;
+
+/** The last looked up font. Consecutive lookups are very often for the same font */
+static HPDFTBL_THREAD_LOCAL glyph_metrics_t *glyph_cache_last = NULL;
+
+/**
+ * @brief Internal function. Check if a cache slot holds the specified font and encoding.
+ * @param m Cache slot
+ * @param fontname Name of font
+ * @param encoding Encoding of font
+ * @return TRUE if the slot matches
+ */
+static _Bool
+glyph_cache_match(const glyph_metrics_t *m, const char *fontname, const char *encoding) {
+    return 0 == strcmp(m->fontname, fontname) && 0 == strcmp(m->encoding, encoding);
+}
+
+/**
+ * @brief Get the advance widths for all byte values in the specified font.
+ *
+ * The widths are read from the font once and then kept in a cache so that
+ * later calls are just a lookup. The font is loaded with the target encoding set
+ * by hpdftbl_set_text_encoding() which is also part of the cache key. The widths are specified in 1/1000 of the font
+ * size, i.e. the width in points of a glyph with byte value `b` at font size `fsize`
+ * is `widths[b] * fsize / 1000`.
+ *
+ * @param pdf_doc The HPDF document handle used to load the font if it is not already cached
+ * @param fontname Name of font
+ * @return A 256 element array of advance widths, NULL if the font could not be loaded
+ * @see hpdftbl_text_width(), hpdftbl_clear_glyph_cache()
+ */
+const HPDF_UINT16 *
+hpdftbl_get_glyph_widths(HPDF_Doc pdf_doc, const char *fontname) {
+    if (fontname == NULL)
+        return NULL;
+    const char *encoding = hpdftbl_get_target_encoding();
+
+    if (glyph_cache_last && glyph_cache_match(glyph_cache_last, fontname, encoding))
+        return glyph_cache_last->widths;
+
+    for (size_t i = 0; i < HPDFTBL_GLYPH_CACHE_SIZE && glyph_cache[i].fontname; i++) {
+        if (glyph_cache_match(&glyph_cache[i], fontname, encoding)) {
+            glyph_cache_last = &glyph_cache[i];
+            return glyph_cache_last->widths;
+        }
+    }
+
+    if (pdf_doc == NULL)
+        return NULL;
+    HPDF_Font font = HPDF_GetFont(pdf_doc, fontname, encoding);
+    if (font == NULL)
+        return NULL;
+
+    // Replace slots in round-robin order when the cache is full
+    glyph_metrics_t *m = &glyph_cache[glyph_cache_next];
+    glyph_cache_next = (glyph_cache_next + 1) % HPDFTBL_GLYPH_CACHE_SIZE;
+    if (glyph_cache_last == m)
+        glyph_cache_last = NULL;
+    hpdftbl_free(m->fontname);
+    hpdftbl_free(m->encoding);
+    m->fontname = hpdftbl_strdup(fontname);
+    m->encoding = hpdftbl_strdup(encoding);
+    if (m->fontname == NULL || m->encoding == NULL) {
+        // An empty slot must not have a name since the lookup stops at the first empty slot
+        hpdftbl_free(m->fontname);
+        hpdftbl_free(m->encoding);
+        m->fontname = m->encoding = NULL;
+        _HPDFTBL_SET_ERR(NULL, -5, -1, -1);
+        return NULL;
+    }
+    m->widths[0] = 0;
+    for (unsigned b = 1; b < 256; b++) {
+        const HPDF_BYTE glyph = (HPDF_BYTE) b;
+        m->widths[b] = (HPDF_UINT16) HPDF_Font_TextWidth(font, &glyph, 1).width;
+    }
+    glyph_cache_last = m;
+    return m->widths;
+}
+
+/**
+ * @brief Calculate the width of a text using the cached glyph metrics.
+ *
+ * This gives the same result as setting the font on a page and calling
+ * HPDF_Page_TextWidth() (with no extra character or word spacing) but does not
+ * need a page and is much faster when many texts are measured.
+ *
+ * @param pdf_doc The HPDF document handle
+ * @param fontname Name of font
+ * @param fsize Font size
+ * @param text Text to measure. May be NULL which gives a zero width.
+ * @return Width of text in points
+ * @see hpdftbl_get_glyph_widths()
+ */
+HPDF_REAL
+hpdftbl_text_width(HPDF_Doc pdf_doc, const char *fontname, HPDF_REAL fsize, const char *text) {
+    if (text == NULL || *text == '\0')
+        return 0;
+    const HPDF_UINT16 *widths = hpdftbl_get_glyph_widths(pdf_doc, fontname);
+    if (widths == NULL)
+        return 0;
+    unsigned long w = 0;
+    for (const unsigned char *p = (const unsigned char *) text; *p; p++) {
+        w += widths[*p];
+    }
+    return (HPDF_REAL) w * fsize / 1000.0f;
+}
+
+/**
+ * @brief Break a text into lines that fit within the specified width.
+ *
+ * This is a greedy line breaker. As many words as possible are put on each line and
+ * the line is broken at the last space that fits. A word that is wider than the
+ * available width on its own is broken between two characters. A newline in the
+ * text always starts a new line. The spaces where the lines are broken are not
+ * included in the lines.
+ *
+ * The text is scanned once using the cached glyph advance widths so the time is
+ * linear in the length of the text.
+ *
+ * If `lines` is NULL only the number of lines is calculated. If the text has more
+ * than `max_lines` lines only the first `max_lines` lines are stored but the total
+ * number of lines is still returned.
+ *
+ * @param pdf_doc The HPDF document handle
+ * @param fontname Name of font
+ * @param fsize Font size
+ * @param text Text to break into lines
+ * @param width The available width in points
+ * @param lines Array to store the lines in, may be NULL
+ * @param max_lines Size of the `lines` array
+ * @return The number of lines in the text, 0 for an empty or NULL text
+ * @see hpdftbl_text_width()
+ */
+size_t
+hpdftbl_wrap_text(HPDF_Doc pdf_doc, const char *fontname, HPDF_REAL fsize, const char *text, HPDF_REAL width,
+                  hpdftbl_text_line_t *lines, size_t max_lines) {
+    if (text == NULL || *text == '\0')
+        return 0;
+
+    // If the font is unknown the text is only broken at newlines
+    const HPDF_UINT16 *widths = hpdftbl_get_glyph_widths(pdf_doc, fontname);
+    const unsigned long max_w = widths == NULL || fsize <= 0 ? ULONG_MAX :
+                                width <= 0 ? 0 : (unsigned long) (width * 1000.0f / fsize);
+
+#define EMIT_LINE(s, l, w) do { if (lines && n < max_lines) { \
+        lines[n].start = (s); lines[n].len = (l); lines[n].width = (HPDF_REAL)(w) * fsize / 1000.0f; } \
+        n++; } while (0)
+
+    const unsigned char *p = (const unsigned char *) text;
+    size_t n = 0;
+    size_t start = 0;           // Start of current line
+    size_t brk = 0;             // Last space in the current line
+    _Bool has_brk = FALSE;
+    unsigned long w = 0;        // Width of current line
+    unsigned long w_brk = 0;    // Width of current line up to the last space
+    size_t i;
+    for (i = 0; p[i]; i++) {
+        if (p[i] == '\n') {
+            EMIT_LINE(start, i - start, w);
+            start = i + 1;
+            w = 0;
+            has_brk = FALSE;
+            continue;
+        }
+
+        const unsigned long gw = widths ? widths[p[i]] : 0;
+        if (p[i] == ' ') {
+            // A space never causes a break by itself, trailing spaces are dropped at the break
+            brk = i;
+            w_brk = w;
+            has_brk = TRUE;
+            w += gw;
+            continue;
+        }
+
+        if (w + gw > max_w && i > start) {
+            if (has_brk) {
+                EMIT_LINE(start, brk - start, w_brk);
+                w -= w_brk + widths[' '];
+                start = brk + 1;
+                has_brk = FALSE;
+            }
+            // The word is still too wide so break it. Never break inside a UTF-8 sequence.
+            if (w + gw > max_w && i > start && (p[i] & 0xC0) != 0x80) {
+                EMIT_LINE(start, i - start, w);
+                w = 0;
+                start = i;
+            }
+        }
+        w += gw;
+    }
+    if (i > start || n == 0) {
+        EMIT_LINE(start, i - start, w);
+    }
+
+#undef EMIT_LINE
+
+    return n;
+}
+
+/**
+ * @brief Find the longest start of a text that fits within the specified width.
+ *
+ * If the entire text fits it is returned as is. Otherwise the longest start of the
+ * text that, together with the optional `ellipsis` string, fits within the width is
+ * found. The text is never cut inside a UTF-8 sequence.
+ *
+ * The advance widths are summed once into an array of prefix widths, which is then
+ * binary searched for the break position. The text itself is never measured more than once.
+ *
+ * @param pdf_doc The HPDF document handle
+ * @param fontname Name of font
+ * @param fsize Font size
+ * @param text Text to fit
+ * @param width The available width in points
+ * @param ellipsis String that is written after a cut text, e.g. "...". May be NULL.
+ * @param fit_width Returned width of the part of the text that fits (not including the
+ * ellipsis). May be NULL.
+ * @return Number of bytes from the start of the text that fit
+ * @see hpdftbl_text_width(), hpdftbl_wrap_text()
+ */
+size_t
+hpdftbl_text_fit(HPDF_Doc pdf_doc, const char *fontname, HPDF_REAL fsize, const char *text, HPDF_REAL width,
+                 const char *ellipsis, HPDF_REAL *fit_width) {
+    if (fit_width)
+        *fit_width = 0;
+    if (text == NULL || *text == '\0')
+        return 0;
+    const size_t len = strlen(text);
+    const HPDF_UINT16 *widths = hpdftbl_get_glyph_widths(pdf_doc, fontname);
+    if (widths == NULL || fsize <= 0)
+        return len;
+
+    // prefix[k] is the width of the first k bytes of the text. Short texts, which is the
+    // common case in a table cell, do not need any allocation.
+    unsigned long stack_prefix[128];
+    unsigned long *prefix = stack_prefix;
+    if (len + 1 > sizeof(stack_prefix) / sizeof(stack_prefix[0])) {
+#ifdef __cplusplus
+        prefix = static_cast<unsigned long*>(hpdftbl_malloc((len + 1) * sizeof(unsigned long)));
+#else
+        prefix = hpdftbl_malloc((len + 1) * sizeof(unsigned long));
+#endif
+        if (prefix == NULL) {
+            _HPDFTBL_SET_ERR(NULL, -5, -1, -1);
+            return len;
+        }
+    }
+    const unsigned char *p = (const unsigned char *) text;
+    prefix[0] = 0;
+    for (size_t i = 0; i < len; i++) {
+        prefix[i + 1] = prefix[i] + widths[p[i]];
+    }
+
+    const unsigned long max_w = width <= 0 ? 0 : (unsigned long) (width * 1000.0f / fsize);
+    size_t k = len;
+    if (prefix[len] > max_w) {
+        unsigned long ellipsis_w = 0;
+        for (const unsigned char *e = (const unsigned char *) ellipsis; e && *e; e++) {
+            ellipsis_w += widths[*e];
+        }
+        const unsigned long avail = max_w > ellipsis_w ? max_w - ellipsis_w : 0;
+
+        // Largest k with prefix[k] <= avail. prefix[0] == 0 <= avail always holds.
+        size_t lo = 0;
+        size_t hi = len;
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo + 1) / 2;
+            if (prefix[mid] <= avail)
+                lo = mid;
+            else
+                hi = mid - 1;
+        }
+        k = lo;
+        while (k > 0 && (p[k] & 0xC0) == 0x80) {
+            k--;
+        }
+    }
+
+    if (fit_width)
+        *fit_width = (HPDF_REAL) prefix[k] * fsize / 1000.0f;
+    if (prefix != stack_prefix)
+        hpdftbl_free(prefix);
+    return k;
+}
+
+/**
+ * @brief Free all memory used by the glyph metrics cache of the calling thread.
+ *
+ * The cache is automatically filled again the next time a text is measured. Each thread
+ * has its own cache so a thread that has stroked tables should call this before it exits.
+ */
+void
+hpdftbl_clear_glyph_cache(void) {
+    for (size_t i = 0; i < HPDFTBL_GLYPH_CACHE_SIZE; i++) {
+        hpdftbl_free(glyph_cache[i].fontname);
+        hpdftbl_free(glyph_cache[i].encoding);
+        glyph_cache[i].fontname = NULL;
+        glyph_cache[i].encoding = NULL;
+    }
+    glyph_cache_next = 0;
+    glyph_cache_last = NULL;
+}
+
+/**
+ * @brief Internal function. Get the number of bytes allocated by the glyph metrics cache of the calling thread.
+ *
+ * The cache slots themselves are statically allocated and are not included.
+ *
+ * @return Number of allocated bytes
+ * @see hpdftbl_get_cache_memory_usage()
+ */
+size_t
+hpdftbl_glyph_cache_memory_usage(void) {
+    size_t bytes = 0;
+    for (size_t i = 0; i < HPDFTBL_GLYPH_CACHE_SIZE; i++) {
+        if (glyph_cache[i].fontname)
+            bytes += strlen(glyph_cache[i].fontname) + strlen(glyph_cache[i].encoding) + 2;
+    }
+    return bytes;
+}
@@ -31,6 +31,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #if !(defined _WIN32 || defined __WIN32__)
 
@@ -42,8 +43,24 @@
 
 #include "hpdftbl.h"
 
-/* Default styles */
-#ifdef __cplusplus
+/*
+ * Reference counts and the lock of shared themes. A shared theme may be replaced in one
+ * thread while tables that use it are stroked in other threads.
+ */
+#if defined(_MSC_VER)
+#include <windows.h>
+#define THEME_REF_INC(p) InterlockedIncrement(p)
+#define THEME_REF_DEC(p) InterlockedDecrement(p)
+#define THEME_LOCK(p) while (InterlockedExchange((p), 1)) YieldProcessor()
+#define THEME_UNLOCK(p) InterlockedExchange((p), 0)
+#else
+#define THEME_REF_INC(p) __atomic_add_fetch((p), 1, __ATOMIC_ACQ_REL)
+#define THEME_REF_DEC(p) __atomic_sub_fetch((p), 1, __ATOMIC_ACQ_REL)
+#define THEME_LOCK(p) while (__atomic_exchange_n((p), 1, __ATOMIC_ACQUIRE)) {}
+#define THEME_UNLOCK(p) __atomic_store_n((p), 0, __ATOMIC_RELEASE)
+#endif
+
+/* Default styles. Plain initializers so they can be used to initialize the static built-in themes */
 
 /**
  * @brief Default style for table title
@@ -52,109 +69,125 @@
 
 /**
  * @brief Default style for table header row
- * @see hpdftbl_set_header_style()
  */
 #define HPDFTBL_DEFAULT_HEADER_STYLE {HPDF_FF_HELVETICA_BOLD,10,{0,0,0},{0.9f,0.9f,0.97f}, CENTER}
 
 /**
- * @brief Default style for table header row
- * @see hpdftbl_set_label_style()
+ * @brief Default style for table cell labels
  */
 #define HPDFTBL_DEFAULT_LABEL_STYLE {HPDF_FF_TIMES_ITALIC,9,{0.4f,0.4f,0.4f},{1,1,1}, LEFT}
 
 /**
- * @brief Default style for table header row
- * @see hpdftbl_set_content_style()
+ * @brief Default style for table cell content
  */
 #define HPDFTBL_DEFAULT_CONTENT_STYLE {HPDF_FF_COURIER,10,{0.2f,0.2f,0.2f},{1,1,1}, LEFT}
 
 /**
  * @brief Default style for table vertical inner grid
- * @see hpdftbl_set_inner_vgrid_style()
  */
-#define HPDFTBL_DEFAULT_INNER_VGRID_STYLE {0.7, {0.5f,0.5f,0.5f},hpdftbl_line_dashstyle_t(0)}
+#define HPDFTBL_DEFAULT_INNER_VGRID_STYLE {0.7f, {0.5f,0.5f,0.5f}, LINE_SOLID}
 
 /**
  * @brief Default style for table horizontal inner grid
- * @see hpdftbl_set_inner_hgrid_style()
  */
-#define HPDFTBL_DEFAULT_INNER_HGRID_STYLE {0.7, {0.5f,0.5f,0.5f},hpdftbl_line_dashstyle_t(0)}
+#define HPDFTBL_DEFAULT_INNER_HGRID_STYLE {0.7f, {0.5f,0.5f,0.5f}, LINE_SOLID}
 
 /**
  * @brief Default style for table outer grid (border)
  * @see hpdftbl_set_outer_grid_style()
  */
-#define HPDFTBL_DEFAULT_OUTER_GRID_STYLE {1.0f, {0.2f,0.2f,0.2f},hpdftbl_line_dashstyle_t(0)}
+#define HPDFTBL_DEFAULT_OUTER_GRID_STYLE {1.0f, {0.2f,0.2f,0.2f}, LINE_SOLID}
 
 /**
  * @brief Default style for alternating row backgrounds color 1
- *
  */
 #define HPDFTBL_DEFAULT_ZEBRA_COLOR1 {1.0f,1.0f,1.0f}
 
 /**
  * @brief Default style for alternating row backgrounds color 2
- *
  */
 #define HPDFTBL_DEFAULT_ZEBRA_COLOR2 {0.95f,0.95f,0.95f}
 
-#else
-
 /**
- * @brief Default style for table title
- */
-#define HPDFTBL_DEFAULT_TITLE_STYLE (hpdf_text_style_t){HPDF_FF_HELVETICA_BOLD,11,(HPDF_RGBColor){0,0,0},(HPDF_RGBColor){0.9f,0.9f,0.9f}, LEFT}
-
-/**
- * @brief Default style for table header row
- * @see hpdftbl_set_header_style()
- */
-#define HPDFTBL_DEFAULT_HEADER_STYLE (hpdf_text_style_t){HPDF_FF_HELVETICA_BOLD,10,(HPDF_RGBColor){0,0,0},(HPDF_RGBColor){0.9f,0.9f,0.97f}, CENTER}
-
-/**
- * @brief Default style for table header row
- * @see hpdftbl_set_label_style()
- */
-#define HPDFTBL_DEFAULT_LABEL_STYLE (hpdf_text_style_t){HPDF_FF_TIMES_ITALIC,9,(HPDF_RGBColor){0.4f,0.4f,0.4f},(HPDF_RGBColor){1,1,1}, LEFT}
-
-/**
- * @brief Default style for table header row
- * @see hpdftbl_set_content_style()
- */
-#define HPDFTBL_DEFAULT_CONTENT_STYLE (hpdf_text_style_t){HPDF_FF_COURIER,10,(HPDF_RGBColor){0.2f,0.2f,0.2f},(HPDF_RGBColor){1,1,1}, LEFT}
-
-/**
- * @brief Default style for table vertical inner grid
- * @see hpdftbl_set_inner_vgrid_style()
- */
-#define HPDFTBL_DEFAULT_INNER_VGRID_STYLE (hpdftbl_grid_style_t){0.7, (HPDF_RGBColor){0.5f,0.5f,0.5f},0}
-
-/**
- * @brief Default style for table horizontal inner grid
- * @see hpdftbl_set_inner_hgrid_style()
- */
-#define HPDFTBL_DEFAULT_INNER_HGRID_STYLE (hpdftbl_grid_style_t){0.7, (HPDF_RGBColor){0.5f,0.5f,0.5f},0}
-
-/**
- * @brief Default style for table outer grid (border)
- * @see hpdftbl_set_outer_grid_style()
- */
-#define HPDFTBL_DEFAULT_OUTER_GRID_STYLE (hpdftbl_grid_style_t){1.0f, (HPDF_RGBColor){0.2f,0.2f,0.2f},0}
-
-/**
- * @brief Default style for alternating row backgrounds color 1
+ * @brief The built-in themes
+ *
+ * The themes are immutable and are used directly without any allocation. The order
+ * must be the same as in hpdftbl_builtin_theme_t.
+ * @see hpdftbl_get_builtin_theme()
  */
-#define HPDFTBL_DEFAULT_ZEBRA_COLOR1    HPDF_COLOR_WHITE
+static const hpdftbl_theme_t builtin_themes[] = {
+        // THEME_DEFAULT
+        {
+                HPDFTBL_DEFAULT_CONTENT_STYLE,
+                HPDFTBL_DEFAULT_LABEL_STYLE,
+                HPDFTBL_DEFAULT_HEADER_STYLE,
+                HPDFTBL_DEFAULT_TITLE_STYLE,
+                HPDFTBL_DEFAULT_OUTER_GRID_STYLE,
+                FALSE, FALSE, FALSE,
+                HPDFTBL_DEFAULT_INNER_VGRID_STYLE,
+                HPDFTBL_DEFAULT_INNER_HGRID_STYLE,
+                HPDFTBL_DEFAULT_INNER_HGRID_STYLE,
+                FALSE, 0,
+                HPDFTBL_DEFAULT_ZEBRA_COLOR1,
+                HPDFTBL_DEFAULT_ZEBRA_COLOR2,
+                DEFAULT_AUTO_VBOTTOM_MARGIN_FACTOR,
+                NULL, 0
+        },
+        // THEME_ZEBRA
+        {
+                {HPDF_FF_HELVETICA, 10, {0.2f, 0.2f, 0.2f}, {1, 1, 1}, LEFT},
+                {HPDF_FF_TIMES_ITALIC, 9, {0.4f, 0.4f, 0.4f}, {1, 1, 1}, LEFT},
+                {HPDF_FF_HELVETICA_BOLD, 10, {1, 1, 1}, {0.25f, 0.35f, 0.55f}, CENTER},
+                {HPDF_FF_HELVETICA_BOLD, 11, {0, 0, 0}, {0.9f, 0.9f, 0.9f}, LEFT},
+                {1.0f, {0.2f, 0.2f, 0.2f}, LINE_SOLID},
+                FALSE, FALSE, TRUE,
+                {0.5f, {0.7f, 0.7f, 0.7f}, LINE_SOLID},
+                {0.5f, {0.7f, 0.7f, 0.7f}, LINE_SOLID},
+                {1.0f, {0.2f, 0.2f, 0.2f}, LINE_SOLID},
+                TRUE, 0,
+                {1.0f, 1.0f, 1.0f},
+                {0.92f, 0.94f, 0.98f},
+                DEFAULT_AUTO_VBOTTOM_MARGIN_FACTOR,
+                NULL, 0
+        },
+        // THEME_LABELS
+        {
+                HPDFTBL_DEFAULT_CONTENT_STYLE,
+                HPDFTBL_DEFAULT_LABEL_STYLE,
+                HPDFTBL_DEFAULT_HEADER_STYLE,
+                HPDFTBL_DEFAULT_TITLE_STYLE,
+                HPDFTBL_DEFAULT_OUTER_GRID_STYLE,
+                TRUE, TRUE, FALSE,
+                HPDFTBL_DEFAULT_INNER_VGRID_STYLE,
+                HPDFTBL_DEFAULT_INNER_HGRID_STYLE,
+                HPDFTBL_DEFAULT_INNER_HGRID_STYLE,
+                FALSE, 0,
+                HPDFTBL_DEFAULT_ZEBRA_COLOR1,
+                HPDFTBL_DEFAULT_ZEBRA_COLOR2,
+                DEFAULT_AUTO_VBOTTOM_MARGIN_FACTOR,
+                NULL, 0
+        }
+};
 
 /**
- * @brief Default style for alternating row backgrounds color 2
+ * @brief Get one of the built-in themes
+ *
+ * The built-in themes are static and must not be modified or destroyed. Since no
+ * memory is allocated this is the preferred way to get a theme to apply to a table.
+ * To make changes to a built-in theme first make a copy with a struct assignment.
+ *
+ * @param which The built-in theme
+ * @return The theme, NULL if `which` is not a built-in theme
+ * @see hpdftbl_create_with_theme(), hpdftbl_apply_theme()
  */
-#define HPDFTBL_DEFAULT_ZEBRA_COLOR2    HPDF_COLOR_XLIGHT_GRAY
-#endif
-
-#ifdef _MSC_VER
-#define strdup _strdup
-#endif
+const hpdftbl_theme_t *
+hpdftbl_get_builtin_theme(hpdftbl_builtin_theme_t which) {
+    if ((size_t) which >= sizeof(builtin_themes) / sizeof(builtin_themes[0])) {
+        _HPDFTBL_SET_ERR(NULL, -9, -1, -1);
+        return NULL;
+    }
+    return &builtin_themes[which];
+}
 
 
 /**
@@ -166,33 +199,44 @@
  * is stored in a theme. Not individal cells.
  *
  * The default table theme can be retrieved with
- * hpdftbl_get_default_theme()
+ * hpdftbl_get_default_theme() or, without any allocation, with
+ * hpdftbl_get_builtin_theme()
+ *
+ * If the table uses a shared theme it is released and the table will from now
+ * on use the styles from the applied theme.
  * @param t Table handle
  * @param theme Theme reference
  * @return 0 on success, -1 on failure
  *
- * @see hpdftbl_get_default_theme()
+ * @see hpdftbl_get_default_theme(), hpdftbl_get_builtin_theme()
  */
 int
-hpdftbl_apply_theme(hpdftbl_t t, hpdftbl_theme_t *theme) {
+hpdftbl_apply_theme(hpdftbl_t t, const hpdftbl_theme_t *theme) {
     _HPDFTBL_CHK_TABLE(t);
     if (theme) {
+        // Applying a theme replaces any shared theme. All styles and rules that could refer to
+        // the version of the shared theme are replaced below.
+        hpdftbl_release_theme(t);
+        t->theme_override = 0;
+        // The style blocks have the same types in the table and the theme so they are copied directly
         t->use_header_row = theme->use_header_row;
         t->use_cell_labels = theme->use_labels;
         t->use_label_grid_style = theme->use_label_grid_style;
-        hpdftbl_set_label_style(t, theme->label_style.font, theme->label_style.fsize, theme->label_style.color, theme->label_style.background);
-        hpdftbl_set_header_style(t, theme->header_style.font, theme->header_style.fsize, theme->header_style.color, theme->header_style.background);
-        hpdftbl_set_header_halign(t, theme->header_style.halign);
-        hpdftbl_set_title_style(t, theme->title_style.font, theme->title_style.fsize, theme->title_style.color, theme->title_style.background);
-        hpdftbl_set_title_halign(t, theme->title_style.halign);
-        hpdftbl_set_content_style(t, theme->content_style.font, theme->content_style.fsize,theme->content_style.color, theme->content_style.background);
-        hpdftbl_set_inner_vgrid_style(t, theme->inner_vborder.width, theme->inner_vborder.color, theme->inner_vborder.line_dashstyle);
-        hpdftbl_set_inner_hgrid_style(t, theme->inner_hborder.width, theme->inner_hborder.color, theme->inner_hborder.line_dashstyle);
-        hpdftbl_set_inner_tgrid_style(t, theme->inner_tborder.width, theme->inner_tborder.color, theme->inner_tborder.line_dashstyle);
-        hpdftbl_set_outer_grid_style(t, theme->outer_border.width, theme->outer_border.color, theme->outer_border.line_dashstyle);
-        hpdftbl_set_zebra(t, theme->use_zebra, theme->zebra_phase);
-        hpdftbl_set_zebra_color(t, theme->zebra_color1, theme->zebra_color2);
-        hpdftbl_set_bottom_vmargin_factor(t, theme->bottom_vmargin_factor);
+        t->label_style = theme->label_style;
+        t->header_style = theme->header_style;
+        t->title_style = theme->title_style;
+        t->content_style = theme->content_style;
+        t->inner_vgrid = theme->inner_vborder;
+        t->inner_hgrid = theme->inner_hborder;
+        t->inner_tgrid = theme->inner_tborder;
+        t->outer_grid = theme->outer_border;
+        t->use_zebra = theme->use_zebra;
+        t->zebra_phase = theme->zebra_phase;
+        t->zebra_color1 = theme->zebra_color1;
+        t->zebra_color2 = theme->zebra_color2;
+        t->bottom_vmargin_factor = theme->bottom_vmargin_factor;
+        t->rules = theme->rules;
+        t->num_rules = theme->num_rules;
         return 0;
     }
     _HPDFTBL_SET_ERR(t, -9, -1, -1);
@@ -210,6 +254,9 @@ hpdftbl_apply_theme(hpdftbl_t t, hpdftbl_theme_t *theme) {
  * despite the structure. This mean only settings that are generic to a table
  * is stored in a theme. Not individal cells.
  *
+ * The font names and rules in the theme are those of the table. If the table uses a shared
+ * theme they are only valid as long as the table is not resolved again or destroyed.
+ *
  * @param tbl Table handle for table to have its settings extracted
  * @param theme Theme to be read out to.
  * @return 0 on success, -1 on failure
@@ -218,6 +265,7 @@ int
 hpdftbl_get_theme(hpdftbl_t tbl, hpdftbl_theme_t *theme) {
     _HPDFTBL_CHK_TABLE(tbl);
     if (theme) {
+        hpdftbl_resolve_theme(tbl);
         theme->title_style = tbl->title_style;
         theme->use_header_row = tbl->use_header_row;
         theme->use_labels = tbl->use_cell_labels;
@@ -236,6 +284,8 @@ hpdftbl_get_theme(hpdftbl_t tbl, hpdftbl_theme_t *theme) {
         theme->zebra_color1 = tbl->zebra_color1;
         theme->zebra_color2 = tbl->zebra_color2;
         theme->bottom_vmargin_factor = tbl->bottom_vmargin_factor;
+        theme->rules = tbl->rules;
+        theme->num_rules = tbl->num_rules;
         return 0;
     } else
         return -1;
@@ -259,35 +309,16 @@ hpdftbl_theme_t *
 hpdftbl_get_default_theme(void) {
 
 #ifdef __cplusplus
-    hpdftbl_theme_t *t = static_cast<hpdftbl_theme_t*>(calloc(1,sizeof(hpdftbl_theme_t)));
+    hpdftbl_theme_t *t = static_cast<hpdftbl_theme_t*>(hpdftbl_calloc(1,sizeof(hpdftbl_theme_t)));
 #else
-    hpdftbl_theme_t *theme = calloc(1, sizeof(hpdftbl_theme_t));
+    hpdftbl_theme_t *theme = hpdftbl_calloc(1, sizeof(hpdftbl_theme_t));
 #endif
     if (NULL == theme) {
         _HPDFTBL_SET_ERR(NULL, -5, -1, -1);
         return NULL;
     }
 
-    // Disable labels and label short style grid by default
-    theme->use_labels = FALSE;
-    theme->use_label_grid_style = FALSE;
-    theme->use_header_row = FALSE;
-
-    theme->title_style = HPDFTBL_DEFAULT_TITLE_STYLE;
-    theme->header_style = HPDFTBL_DEFAULT_HEADER_STYLE;
-    theme->label_style = HPDFTBL_DEFAULT_LABEL_STYLE;
-    theme->content_style = HPDFTBL_DEFAULT_CONTENT_STYLE;
-    theme->outer_border = HPDFTBL_DEFAULT_OUTER_GRID_STYLE;
-    theme->inner_vborder = HPDFTBL_DEFAULT_INNER_VGRID_STYLE;
-    theme->inner_hborder = HPDFTBL_DEFAULT_INNER_HGRID_STYLE;
-    theme->inner_tborder = HPDFTBL_DEFAULT_INNER_HGRID_STYLE;
-
-    theme->use_zebra = FALSE;
-    theme->zebra_color1 = HPDFTBL_DEFAULT_ZEBRA_COLOR1;
-    theme->zebra_color2 = HPDFTBL_DEFAULT_ZEBRA_COLOR2;
-    theme->zebra_phase = 0;
-    theme->bottom_vmargin_factor = DEFAULT_AUTO_VBOTTOM_MARGIN_FACTOR;
-
+    *theme = builtin_themes[THEME_DEFAULT];
     return theme;
 }
 
@@ -304,6 +335,329 @@ hpdftbl_destroy_theme(hpdftbl_theme_t *theme) {
         _HPDFTBL_SET_ERR(NULL, -9, -1, -1);
         return -1;
     }
-    free(theme);
+    hpdftbl_free(theme);
+    return 0;
+}
+
+/**
+ * @brief Free the conditional formatting rules read by hpdftbl_theme_load()
+ *
+ * The rules in a theme are not owned by the theme. This is only needed for a
+ * theme that has been read back with hpdftbl_theme_load() or hpdftbl_theme_loads()
+ * in which case the rules were allocated by the loader. The rules must not be used
+ * by any table after they have been freed.
+ *
+ * @param theme The theme
+ * @see hpdftbl_theme_load()
+ */
+void
+hpdftbl_theme_free_rules(hpdftbl_theme_t *theme) {
+    if (NULL == theme)
+        return;
+    hpdftbl_rules_free((hpdftbl_rule_t *) theme->rules, theme->num_rules);
+    theme->rules = NULL;
+    theme->num_rules = 0;
+}
+
+/**
+ * @brief Create a new version of a shared theme with its own copy of the font names and rules
+ *
+ * @param theme The theme
+ * @return The new version with one reference, NULL on out of memory
+ */
+static struct hpdftbl_theme_version *
+theme_version_new(const hpdftbl_theme_t *theme) {
+#ifdef __cplusplus
+    struct hpdftbl_theme_version *v = static_cast<struct hpdftbl_theme_version *>(hpdftbl_calloc(1, sizeof(struct hpdftbl_theme_version)));
+#else
+    struct hpdftbl_theme_version *v = hpdftbl_calloc(1, sizeof(struct hpdftbl_theme_version));
+#endif
+    if (NULL == v) {
+        _HPDFTBL_SET_ERR(NULL, -5, -1, -1);
+        return NULL;
+    }
+
+    v->theme = *theme;
+    char **fonts[] = {&v->theme.content_style.font, &v->theme.label_style.font,
+                      &v->theme.header_style.font, &v->theme.title_style.font};
+    const size_t num_fonts = sizeof(fonts) / sizeof(fonts[0]);
+    for (size_t i = 0; i < num_fonts; i++) {
+        if (*fonts[i] && NULL == (*fonts[i] = hpdftbl_strdup(*fonts[i]))) {
+            for (size_t j = 0; j < i; j++)
+                hpdftbl_free(*fonts[j]);
+            hpdftbl_free(v);
+            _HPDFTBL_SET_ERR(NULL, -5, -1, -1);
+            return NULL;
+        }
+    }
+
+    hpdftbl_rule_t *rules;
+    if (-1 == hpdftbl_rules_copy(theme->rules, theme->num_rules, &rules)) {
+        for (size_t j = 0; j < num_fonts; j++)
+            hpdftbl_free(*fonts[j]);
+        hpdftbl_free(v);
+        return NULL;
+    }
+    v->theme.rules = rules;
+    v->theme.num_rules = rules ? theme->num_rules : 0;
+    v->refcnt = 1;
+    return v;
+}
+
+/**
+ * @brief Release a reference to a version of a shared theme
+ *
+ * The version, its font names and rules are freed when the last reference is released.
+ *
+ * @param v Version
+ */
+static void
+theme_version_release(struct hpdftbl_theme_version *v) {
+    if (0 == THEME_REF_DEC(&v->refcnt)) {
+        hpdftbl_free(v->theme.content_style.font);
+        hpdftbl_free(v->theme.label_style.font);
+        hpdftbl_free(v->theme.header_style.font);
+        hpdftbl_free(v->theme.title_style.font);
+        hpdftbl_rules_free((hpdftbl_rule_t *) v->theme.rules, v->theme.num_rules);
+        hpdftbl_free(v);
+    }
+}
+
+/**
+ * @brief Get a reference to the current version of a shared theme
+ *
+ * @param shared Shared theme
+ * @return The current version. The reference must be released with theme_version_release()
+ */
+static struct hpdftbl_theme_version *
+theme_version_acquire(hpdftbl_shared_theme_t shared) {
+    THEME_LOCK(&shared->lock);
+    struct hpdftbl_theme_version *v = shared->version;
+    THEME_REF_INC(&v->refcnt);
+    THEME_UNLOCK(&shared->lock);
+    return v;
+}
+
+/**
+ * @brief Create a shared theme
+ *
+ * A shared theme is a reference counted theme that can be used by many tables at the
+ * same time, see hpdftbl_use_shared_theme(). The returned shared theme has one reference
+ * owned by the caller that must be released with hpdftbl_shared_theme_release(). The
+ * shared theme is freed when the last table using it has been destroyed.
+ *
+ * @code
+ * hpdftbl_shared_theme_t corporate = hpdftbl_shared_theme_create(NULL);
+ * hpdftbl_shared_theme_load(corporate, "corporate_theme.json");
+ * hpdftbl_use_shared_theme(tbl1, corporate);
+ * hpdftbl_use_shared_theme(tbl2, corporate);
+ * hpdftbl_shared_theme_release(corporate);
+ * @endcode
+ *
+ * @param theme Initial theme. This is copied. If NULL the default theme is used.
+ * @return A new shared theme, NULL on out of memory
+ * @see hpdftbl_shared_theme_set(), hpdftbl_shared_theme_load(), hpdftbl_shared_theme_release()
+ */
+hpdftbl_shared_theme_t
+hpdftbl_shared_theme_create(const hpdftbl_theme_t *theme) {
+#ifdef __cplusplus
+    hpdftbl_shared_theme_t shared = static_cast<hpdftbl_shared_theme_t>(hpdftbl_calloc(1, sizeof(struct hpdftbl_shared_theme)));
+#else
+    hpdftbl_shared_theme_t shared = hpdftbl_calloc(1, sizeof(struct hpdftbl_shared_theme));
+#endif
+    if (NULL == shared) {
+        _HPDFTBL_SET_ERR(NULL, -5, -1, -1);
+        return NULL;
+    }
+
+    shared->version = theme_version_new(theme ? theme : &builtin_themes[THEME_DEFAULT]);
+    if (NULL == shared->version) {
+        hpdftbl_free(shared);
+        return NULL;
+    }
+    shared->refcnt = 1;
+    return shared;
+}
+
+/**
+ * @brief Release a reference to a shared theme
+ *
+ * The shared theme is freed when the last reference is released. A table that has been
+ * resolved from the shared theme keeps its current version until the table is destroyed.
+ *
+ * @param shared Shared theme
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_shared_theme_create()
+ */
+int
+hpdftbl_shared_theme_release(hpdftbl_shared_theme_t shared) {
+    if (NULL == shared) {
+        _HPDFTBL_SET_ERR(NULL, -9, -1, -1);
+        return -1;
+    }
+    if (0 == THEME_REF_DEC(&shared->refcnt)) {
+        theme_version_release(shared->version);
+        hpdftbl_free(shared);
+    }
     return 0;
 }
+
+/**
+ * @brief Replace the theme in a shared theme
+ *
+ * All tables that use the shared theme get the new styles the next time they are laid
+ * out, stroked or serialized. The cost does not depend on the number of tables that use
+ * the theme. The theme is copied, including the font names and the conditional formatting
+ * rules, so it does not have to be kept by the caller.
+ *
+ * The copy becomes a new version of the shared theme. The previous version is not changed and
+ * is kept until no table refers to it, so it is safe to replace the theme while tables that use
+ * it are stroked in other threads. Such a table is drawn completely with the version it was
+ * laid out with.
+ *
+ * @param shared Shared theme
+ * @param theme The new theme
+ * @return 0 on success, -1 on failure in which case the shared theme is unchanged
+ * @see hpdftbl_shared_theme_load(), hpdftbl_use_shared_theme()
+ */
+int
+hpdftbl_shared_theme_set(hpdftbl_shared_theme_t shared, const hpdftbl_theme_t *theme) {
+    if (NULL == shared || NULL == theme) {
+        _HPDFTBL_SET_ERR(NULL, -9, -1, -1);
+        return -1;
+    }
+
+    struct hpdftbl_theme_version *v = theme_version_new(theme);
+    if (NULL == v)
+        return -1;
+
+    THEME_LOCK(&shared->lock);
+    struct hpdftbl_theme_version *old = shared->version;
+    shared->version = v;
+    THEME_UNLOCK(&shared->lock);
+    theme_version_release(old);
+    return 0;
+}
+
+/**
+ * @brief Use a shared theme for the styles of a table
+ *
+ * The table keeps a reference to the shared theme and takes its styles from it each time
+ * it is laid out, stroked or serialized. A style that is set on the table after this call,
+ * for example with hpdftbl_set_content_style(), is kept as an override of the shared theme
+ * for this table only. Any previous overrides are cleared.
+ *
+ * @param t Table handle
+ * @param shared Shared theme. If NULL the table stops using a shared theme and keeps
+ * its current styles.
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_shared_theme_create(), hpdftbl_shared_theme_set()
+ */
+int
+hpdftbl_use_shared_theme(hpdftbl_t t, hpdftbl_shared_theme_t shared) {
+    _HPDFTBL_CHK_TABLE(t);
+    if (shared)
+        THEME_REF_INC(&shared->refcnt);
+    if (t->shared_theme)
+        hpdftbl_shared_theme_release(t->shared_theme);
+    // The version the styles were resolved from is kept since the current styles use it
+    t->shared_theme = shared;
+    t->theme_override = 0;
+    hpdftbl_resolve_theme(t);
+    return 0;
+}
+
+/**
+ * @brief Internal function. Stop using a shared theme and release the version of it.
+ *
+ * Must only be called when none of the styles and rules of the table refer to the version.
+ *
+ * @param t Table handle
+ */
+void
+hpdftbl_release_theme(hpdftbl_t t) {
+    if (t->shared_theme) {
+        hpdftbl_shared_theme_release(t->shared_theme);
+        t->shared_theme = NULL;
+    }
+    if (t->theme_version) {
+        theme_version_release(t->theme_version);
+        t->theme_version = NULL;
+    }
+}
+
+/**
+ * @brief Internal function. Update the styles of a table from its shared theme.
+ *
+ * Only the theme elements that have not been overridden in the table are updated.
+ *
+ * @param t Table handle
+ * @see hpdftbl_use_shared_theme()
+ */
+void
+hpdftbl_resolve_theme(hpdftbl_t t) {
+    if (NULL == t->shared_theme)
+        return;
+
+    // The font names and rules of the version are used by the table until it is resolved again
+    struct hpdftbl_theme_version *v = theme_version_acquire(t->shared_theme);
+    const hpdftbl_theme_t *theme = &v->theme;
+    const unsigned ovr = t->theme_override;
+
+    if (!(ovr & THEME_OVR_CONTENT_STYLE)) {
+        const HPDF_RGBColor background = t->content_style.background;
+        t->content_style = theme->content_style;
+        if (ovr & THEME_OVR_CONTENT_BACKGROUND)
+            t->content_style.background = background;
+    }
+    if (!(ovr & THEME_OVR_LABEL_STYLE))
+        t->label_style = theme->label_style;
+    if (!(ovr & THEME_OVR_HEADER_STYLE)) {
+        const hpdftbl_text_align_t halign = t->header_style.halign;
+        t->header_style = theme->header_style;
+        if (ovr & THEME_OVR_HEADER_HALIGN)
+            t->header_style.halign = halign;
+    } else if (!(ovr & THEME_OVR_HEADER_HALIGN)) {
+        t->header_style.halign = theme->header_style.halign;
+    }
+    if (!(ovr & THEME_OVR_TITLE_STYLE)) {
+        const hpdftbl_text_align_t halign = t->title_style.halign;
+        t->title_style = theme->title_style;
+        if (ovr & THEME_OVR_TITLE_HALIGN)
+            t->title_style.halign = halign;
+    } else if (!(ovr & THEME_OVR_TITLE_HALIGN)) {
+        t->title_style.halign = theme->title_style.halign;
+    }
+    if (!(ovr & THEME_OVR_OUTER_GRID))
+        t->outer_grid = theme->outer_border;
+    if (!(ovr & THEME_OVR_INNER_VGRID))
+        t->inner_vgrid = theme->inner_vborder;
+    if (!(ovr & THEME_OVR_INNER_HGRID))
+        t->inner_hgrid = theme->inner_hborder;
+    if (!(ovr & THEME_OVR_INNER_TGRID))
+        t->inner_tgrid = theme->inner_tborder;
+    if (!(ovr & THEME_OVR_USE_HEADER))
+        t->use_header_row = theme->use_header_row;
+    if (!(ovr & THEME_OVR_USE_LABELS))
+        t->use_cell_labels = theme->use_labels;
+    if (!(ovr & THEME_OVR_USE_LABELGRID))
+        t->use_label_grid_style = theme->use_label_grid_style;
+    if (!(ovr & THEME_OVR_ZEBRA)) {
+        t->use_zebra = theme->use_zebra;
+        t->zebra_phase = theme->zebra_phase;
+    }
+    if (!(ovr & THEME_OVR_ZEBRA_COLOR)) {
+        t->zebra_color1 = theme->zebra_color1;
+        t->zebra_color2 = theme->zebra_color2;
+    }
+    if (!(ovr & THEME_OVR_VMARGIN))
+        t->bottom_vmargin_factor = theme->bottom_vmargin_factor;
+    if (!(ovr & THEME_OVR_RULES)) {
+        t->rules = theme->rules;
+        t->num_rules = theme->num_rules;
+    }
+
+    if (t->theme_version)
+        theme_version_release(t->theme_version);
+    t->theme_version = v;
+}
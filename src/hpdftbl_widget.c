@@ -46,37 +46,298 @@
 #define TRUE 1     /**< C Boolean truth value */
 #define FALSE 0    /**< C Boolean false value */
 
+/*-----------------------------------------------------------------------
+ * Widget appearance cache.
+ *
+ * Most widgets only have a few distinct appearances (on/off, 0-N segments)
+ * but are often drawn in thousands of cells. When the cache is enabled each
+ * distinct appearance is recorded once as a Form XObject and then only placed
+ * by reference which makes the PDF both much smaller and faster to render.
+ * An appearance is identified by a key string with the widget name, size, state
+ * and colors.
+ */
+
+/** @brief Number of hash buckets in the widget cache */
+#define WIDGET_CACHE_BUCKETS 256
+
+/** @brief Maximum length of a widget cache key */
+#define WIDGET_CACHE_KEYLEN 256
+
+/** @brief Extra space around a widget in its form to not cut line widths */
+#define WIDGET_FORM_PAD 2.0f
+
+/** @brief Extra space to the right of a widget in its form for the value text */
+#define WIDGET_FORM_VAL_WIDTH 35.0f
+
+/**
+ * @brief An entry in the widget cache
+ */
+typedef struct widget_cache_entry {
+    HPDF_Doc doc;                       /**< Document the form belongs to */
+    char *key;                          /**< Appearance key */
+    HPDF_XObject xobject;               /**< Recorded form */
+    HPDF_UINT32 obj_id;                 /**< Object id of the form in the document */
+    struct widget_cache_entry *next;    /**< Next entry in same bucket */
+} widget_cache_entry_t;
+
+/** The hash buckets of the cache. Each thread has its own cache. */
+static HPDFTBL_THREAD_LOCAL widget_cache_entry_t *widget_cache[WIDGET_CACHE_BUCKETS];
+
+/** Number of cached appearances */
+static HPDFTBL_THREAD_LOCAL size_t widget_cache_num = 0;
+
+/** Flag if widgets should be drawn through the cache */
+static _Bool widget_cache_used = FALSE;
+
+/**
+ * @brief Internal function. Calculate the bucket for a key.
+ * @param doc Document handle
+ * @param key Appearance key
+ * @return Bucket index
+ */
+static size_t
+widget_cache_bucket(HPDF_Doc doc, const char *key) {
+    // FNV-1a
+    unsigned long h = 2166136261UL ^ (unsigned long) (size_t) doc;
+    for (const unsigned char *p = (const unsigned char *) key; *p; p++) {
+        h = (h ^ *p) * 16777619UL;
+    }
+    return h % WIDGET_CACHE_BUCKETS;
+}
+
+/**
+ * @brief Internal function. Check that a cached form is still an object in the document.
+ *
+ * A new document may be allocated at the address of a freed document whose forms are
+ * still in the cache. The form is therefore looked up by its object id in the
+ * cross-reference table of the document, which never holds a form of another document.
+ *
+ * @param doc Document handle
+ * @param e Cache entry for the document
+ * @return TRUE if the form can be placed in the document
+ */
+static _Bool
+widget_cache_valid(HPDF_Doc doc, const widget_cache_entry_t *e) {
+#ifdef HPDF_SHARED
+    return FALSE;
+#else
+    HPDF_Xref xref = doc->xref;
+    if (xref == NULL || e->obj_id < xref->start_offset)
+        return FALSE;
+    HPDF_XrefEntry x = (HPDF_XrefEntry) HPDF_List_ItemAt(xref->entries, e->obj_id - xref->start_offset);
+    return x != NULL && x->obj == e->xobject;
+#endif
+}
+
+/**
+ * @brief Internal function. Remove an entry from the cache.
+ * @param prev Link to the entry
+ */
+static void
+widget_cache_remove(widget_cache_entry_t **prev) {
+    widget_cache_entry_t *e = *prev;
+    *prev = e->next;
+    hpdftbl_free(e->key);
+    hpdftbl_free(e);
+    widget_cache_num--;
+}
+
+/**
+ * @brief Internal function. Start drawing a widget through the cache.
+ *
+ * If the appearance is already cached it is placed on the page and the widget
+ * does not need to be drawn. Otherwise recording of a new form is started and the
+ * widget should be drawn with its lower left corner at (0,0) followed by a call
+ * to hpdftbl_widget_cache_end().
+ *
+ * @param doc Document handle
+ * @param page Page handle
+ * @param key Appearance key
+ * @param bbox Bounding box of the widget in widget coordinates
+ * @param xpos X-position of widget
+ * @param ypos Y-position of widget
+ * @param rec Recording state
+ * @return 1 if the widget was placed from the cache, 0 if recording has started and
+ * -1 if the widget should be drawn directly on the page
+ */
+int
+hpdftbl_widget_cache_begin(HPDF_Doc doc, HPDF_Page page, const char *key, HPDF_Rect bbox,
+                           HPDF_REAL xpos, HPDF_REAL ypos, hpdftbl_xobject_rec_t *rec) {
+    rec->xobject = NULL;
+    if (!widget_cache_used || key[0] == '\0')
+        return -1;
+
+    for (widget_cache_entry_t **prev = &widget_cache[widget_cache_bucket(doc, key)]; *prev; prev = &(*prev)->next) {
+        widget_cache_entry_t *e = *prev;
+        if (e->doc == doc && 0 == strcmp(e->key, key)) {
+            if (widget_cache_valid(doc, e))
+                return 0 == hpdftbl_xobject_place(page, e->xobject, xpos, ypos) ? 1 : -1;
+            // The form belonged to a freed document at the same address
+            widget_cache_remove(prev);
+            break;
+        }
+    }
+
+    if (widget_cache_num >= HPDFTBL_WIDGET_CACHE_MAX)
+        return -1;
+    return hpdftbl_xobject_begin(doc, page, bbox, rec) ? 0 : -1;
+}
+
+/**
+ * @brief Internal function. Finish a widget started with hpdftbl_widget_cache_begin().
+ *
+ * The recorded form is stored in the cache and placed on the page.
+ * Does nothing if no recording was started.
+ *
+ * @param key Appearance key
+ * @param xpos X-position of widget
+ * @param ypos Y-position of widget
+ * @param rec Recording state
+ */
+void
+hpdftbl_widget_cache_end(const char *key, HPDF_REAL xpos, HPDF_REAL ypos, hpdftbl_xobject_rec_t *rec) {
+    if (rec->xobject == NULL)
+        return;
+
+    HPDF_Doc doc = rec->pdf_doc;
+    HPDF_Page page = rec->pdf_page;
+    HPDF_XObject xobject = hpdftbl_xobject_end(rec);
+    if (xobject == NULL)
+        return;
+
+    // A new form can not already be in the cache so an entry with the same form
+    // belonged to a freed document and would otherwise pass widget_cache_valid()
+    for (size_t i = 0; i < WIDGET_CACHE_BUCKETS; i++) {
+        widget_cache_entry_t **prev = &widget_cache[i];
+        while (*prev) {
+            if ((*prev)->doc == doc && (*prev)->xobject == xobject)
+                widget_cache_remove(prev);
+            else
+                prev = &(*prev)->next;
+        }
+    }
+
+#ifdef __cplusplus
+    widget_cache_entry_t *e = static_cast<widget_cache_entry_t*>(hpdftbl_calloc(1, sizeof(widget_cache_entry_t)));
+#else
+    widget_cache_entry_t *e = hpdftbl_calloc(1, sizeof(widget_cache_entry_t));
+#endif
+    if (e == NULL || (e->key = hpdftbl_strdup(key)) == NULL) {
+        hpdftbl_free(e);
+        _HPDFTBL_SET_ERR(NULL, -5, -1, -1);
+    } else {
+        const size_t b = widget_cache_bucket(doc, key);
+        e->doc = doc;
+        e->xobject = xobject;
+#ifndef HPDF_SHARED
+        e->obj_id = xobject->header.obj_id & 0x00FFFFFF;
+#endif
+        e->next = widget_cache[b];
+        widget_cache[b] = e;
+        widget_cache_num++;
+    }
+    hpdftbl_xobject_place(page, xobject, xpos, ypos);
+}
+
+/**
+ * @brief Internal function. Create a widget bounding box.
+ * @param width Width of widget
+ * @param height Height of widget
+ * @param extra_right Extra space to the right for text
+ * @return Bounding box with some padding
+ */
+static HPDF_Rect
+widget_bbox(HPDF_REAL width, HPDF_REAL height, HPDF_REAL extra_right) {
+    HPDF_Rect bbox;
+    bbox.left = -WIDGET_FORM_PAD;
+    bbox.bottom = -WIDGET_FORM_PAD;
+    bbox.right = width + extra_right + WIDGET_FORM_PAD;
+    bbox.top = height + WIDGET_FORM_PAD;
+    return bbox;
+}
+
+/**
+ * @brief Draw widgets through a cache of their distinct appearances.
+ *
+ * When enabled each distinct appearance of the slide button, segment bar, strength meter
+ * and letter button widgets, as well as the positioning grid, is recorded once as a PDF Form XObject. All widgets with the same
+ * appearance are then placed by a reference to the form instead of repeating all the drawing
+ * operations. This makes documents with many widgets much smaller and faster to render. The
+ * cache is disabled by default.
+ *
+ * The cache is kept per thread. It keeps references to objects in the PDF documents and checks
+ * that a cached appearance still belongs to the document before it is used, but the memory
+ * for the appearances of a freed document is only released by hpdftbl_clear_widget_cache().
+ * Call it when a document is freed with HPDF_Free() and before a thread that has drawn
+ * widgets exits.
+ *
+ * @param use TRUE to enable the cache
+ * @see hpdftbl_clear_widget_cache()
+ */
+void
+hpdftbl_use_widget_cache(_Bool use) {
+    widget_cache_used = use;
+}
+
+/**
+ * @brief Remove all appearances from the widget cache of the calling thread.
+ *
+ * @see hpdftbl_use_widget_cache()
+ */
+void
+hpdftbl_clear_widget_cache(void) {
+    for (size_t b = 0; b < WIDGET_CACHE_BUCKETS; b++) {
+        widget_cache_entry_t *e = widget_cache[b];
+        while (e) {
+            widget_cache_entry_t *next = e->next;
+            hpdftbl_free(e->key);
+            hpdftbl_free(e);
+            e = next;
+        }
+        widget_cache[b] = NULL;
+    }
+    widget_cache_num = 0;
+}
+
+/**
+ * @brief Internal function. Get the number of bytes allocated by the widget cache of the calling thread.
+ *
+ * The recorded forms are owned by the PDF documents and are not included.
+ *
+ * @return Number of allocated bytes
+ * @see hpdftbl_get_cache_memory_usage()
+ */
+size_t
+hpdftbl_widget_cache_memory_usage(void) {
+    size_t bytes = 0;
+    for (size_t b = 0; b < WIDGET_CACHE_BUCKETS; b++) {
+        for (widget_cache_entry_t *e = widget_cache[b]; e; e = e->next) {
+            bytes += sizeof(widget_cache_entry_t) + strlen(e->key) + 1;
+        }
+    }
+    return bytes;
+}
+
+/**
+ * @brief Internal function. Format a color as part of a cache key.
+ */
+#define _WIDGET_KEY_RGB(c) (double)(c).r, (double)(c).g, (double)(c).b
+
 // Silent gcc about unused "arg"in the widget functions
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 
 
 /**
- * @brief Display an array of letters as a table where each letter is its own "mini" cell  
- * and sorrounded by a frame. Each boxed letter can be in an "on" state or "off" state
- * which is illustrated with different font and fac colors
- *
- * @param doc HPDF document handle
- * @param page HPDF page handle
- * @param xpos X-öosition of cell
- * @param ypos Y-Position of cell
- * @param width Width of cell
- * @param height Height of cell
- * @param on_color The font color in "on" state
- * @param off_color The font color in "off" state
- * @param on_background The face color in "on" state
- * @param off_background The face color in "off" state
- * @param fsize The font size
- * @param letters What letters to have in the boxes
- * @param state What state each boxed letter should be  (0=off, 1=pn)
+ * @brief Internal function. Draw the widget, see the public function.
  */
-void
-hpdftbl_table_widget_letter_buttons(HPDF_Doc doc, HPDF_Page page,
-                                    HPDF_REAL xpos, HPDF_REAL ypos, HPDF_REAL width, HPDF_REAL height,
-                                    const HPDF_RGBColor on_color, const HPDF_RGBColor off_color,
-                                    const HPDF_RGBColor on_background, const HPDF_RGBColor off_background,
-                                    const HPDF_REAL fsize,
-                                    const char *letters, _Bool *state ) {
+static void
+letter_buttons_draw(HPDF_Doc doc, HPDF_Page page,
+                    HPDF_REAL xpos, HPDF_REAL ypos, HPDF_REAL width, HPDF_REAL height,
+                    const HPDF_RGBColor on_color, const HPDF_RGBColor off_color,
+                    const HPDF_RGBColor on_background, const HPDF_RGBColor off_background,
+                    const HPDF_REAL fsize,
+                    const char *letters, _Bool *state ) {
 
     // Text colors
     const size_t num=strlen(letters);
@@ -118,15 +379,10 @@ hpdftbl_table_widget_letter_buttons(HPDF_Doc doc, HPDF_Page page,
     }
 }
 
-
-
 /**
- * @brief Table widget that draws a sliding on/off switch. Meant to be used in a canvas
- * callback to display a boolean value.
- *
- * This function can not be used directly as a canvas callback since it needs the state
- * of the button as an argument. Instead create a simple canvas callback that determines
- * the wanted state and then just passes on all argument to this widget function.
+ * @brief Display an array of letters as a table where each letter is its own "mini" cell  
+ * and sorrounded by a frame. Each boxed letter can be in an "on" state or "off" state
+ * which is illustrated with different font and fac colors
  *
  * @param doc HPDF document handle
  * @param page HPDF page handle
@@ -134,11 +390,61 @@ hpdftbl_table_widget_letter_buttons(HPDF_Doc doc, HPDF_Page page,
  * @param ypos Y-Position of cell
  * @param width Width of cell
  * @param height Height of cell
- * @param state State of button On/Off
+ * @param on_color The font color in "on" state
+ * @param off_color The font color in "off" state
+ * @param on_background The face color in "on" state
+ * @param off_background The face color in "off" state
+ * @param fsize The font size
+ * @param letters What letters to have in the boxes
+ * @param state What state each boxed letter should be  (0=off, 1=pn)
+ * @see hpdftbl_use_widget_cache()
  */
 void
-hpdftbl_widget_slide_button(HPDF_Doc doc, HPDF_Page page,
-                            HPDF_REAL xpos, HPDF_REAL ypos, HPDF_REAL width, HPDF_REAL height, _Bool state) {
+hpdftbl_table_widget_letter_buttons(HPDF_Doc doc, HPDF_Page page,
+                                    HPDF_REAL xpos, HPDF_REAL ypos, HPDF_REAL width, HPDF_REAL height,
+                                    const HPDF_RGBColor on_color, const HPDF_RGBColor off_color,
+                                    const HPDF_RGBColor on_background, const HPDF_RGBColor off_background,
+                                    const HPDF_REAL fsize,
+                                    const char *letters, _Bool *state ) {
+    char key[WIDGET_CACHE_KEYLEN] = "";
+    hpdftbl_xobject_rec_t rec;
+    HPDF_REAL x0 = xpos, y0 = ypos;
+
+    if (widget_cache_used) {
+        int n = snprintf(key, sizeof(key), "letter|%.3f|%.3f|%.4f %.4f %.4f|%.4f %.4f %.4f|%.4f %.4f %.4f|%.4f %.4f %.4f|%.2f|%s|",
+                         (double) width, (double) height, _WIDGET_KEY_RGB(on_color), _WIDGET_KEY_RGB(off_color),
+                         _WIDGET_KEY_RGB(on_background), _WIDGET_KEY_RGB(off_background), (double) fsize, letters);
+        for (size_t i = 0; letters[i] && n > 0 && (size_t) n < sizeof(key) - 1; i++) {
+            key[n++] = state[i] ? '1' : '0';
+            key[n] = '\0';
+        }
+        // Too long keys are not cached
+        if (n < 0 || (size_t) n >= sizeof(key) - 1)
+            key[0] = '\0';
+    }
+
+    switch (hpdftbl_widget_cache_begin(doc, page, key, widget_bbox(width, height, 0), xpos, ypos, &rec)) {
+        case 1:
+            return;
+        case 0:
+            x0 = y0 = 0;
+            break;
+        default:
+            break;
+    }
+    letter_buttons_draw(doc, page, x0, y0, width, height, on_color, off_color, on_background, off_background,
+                        fsize, letters, state);
+    hpdftbl_widget_cache_end(key, xpos, ypos, &rec);
+}
+
+
+
+/**
+ * @brief Internal function. Draw the widget, see the public function.
+ */
+static void
+slide_button_draw(HPDF_Doc doc, HPDF_Page page,
+                  HPDF_REAL xpos, HPDF_REAL ypos, HPDF_REAL width, HPDF_REAL height, _Bool state) {
 
     const HPDF_RGBColor red = HPDF_COLOR_FROMRGB(210,42,0);
     const HPDF_RGBColor green = HPDF_COLOR_FROMRGB(60,179,113);
@@ -219,6 +525,46 @@ hpdftbl_widget_slide_button(HPDF_Doc doc, HPDF_Page page,
 
 }
 
+/**
+ * @brief Table widget that draws a sliding on/off switch. Meant to be used in a canvas
+ * callback to display a boolean value.
+ *
+ * This function can not be used directly as a canvas callback since it needs the state
+ * of the button as an argument. Instead create a simple canvas callback that determines
+ * the wanted state and then just passes on all argument to this widget function.
+ *
+ * @param doc HPDF document handle
+ * @param page HPDF page handle
+ * @param xpos X-öosition of cell
+ * @param ypos Y-Position of cell
+ * @param width Width of cell
+ * @param height Height of cell
+ * @param state State of button On/Off
+ * @see hpdftbl_use_widget_cache()
+ */
+void
+hpdftbl_widget_slide_button(HPDF_Doc doc, HPDF_Page page,
+                            HPDF_REAL xpos, HPDF_REAL ypos, HPDF_REAL width, HPDF_REAL height, _Bool state) {
+    char key[WIDGET_CACHE_KEYLEN] = "";
+    hpdftbl_xobject_rec_t rec;
+    HPDF_REAL x0 = xpos, y0 = ypos;
+
+    if (widget_cache_used)
+        snprintf(key, sizeof(key), "slide|%.3f|%.3f|%d", (double) width, (double) height, state ? 1 : 0);
+
+    switch (hpdftbl_widget_cache_begin(doc, page, key, widget_bbox(width, height, 0), xpos, ypos, &rec)) {
+        case 1:
+            return;
+        case 0:
+            x0 = y0 = 0;
+            break;
+        default:
+            break;
+    }
+    slide_button_draw(doc, page, x0, y0, width, height, state);
+    hpdftbl_widget_cache_end(key, xpos, ypos, &rec);
+}
+
 /**
  * @brief Draw a horizontal partially filled bar to indicate an analog (percentage) value
  *
@@ -279,32 +625,14 @@ hpdftbl_widget_hbar(const HPDF_Doc doc, const HPDF_Page page,
 }
 
 /**
- * @brief Draw a horizontal segment meter that can be used to visualize a discrete value
- *
- * This function can not be used directly as a canvas callback since it needs additional
- * parameters. Instead create a simple canvas callback that gives the additional parameters.
- *
- * @param doc HPDF Document handle
- * @param page HPDF Page handle
- * @param xpos Lower left x
- * @param ypos Lower left y
- * @param width Width of meter
- * @param height Height of meter
- * @param num_segments Total number of segments
- * @param on_color Color for "on" segment
- * @param val_percent To what extent should the bars be filled (as a value 0.0 - 1.0)
- * @param hide_val TRUE to hide the value (in percent) at the right end of the entire bar
+ * @brief Internal function. Draw the widget, see the public function.
  */
-void
-hpdftbl_widget_segment_hbar(const HPDF_Doc doc, const HPDF_Page page,
-                            const HPDF_REAL xpos, const HPDF_REAL ypos, const HPDF_REAL width, const HPDF_REAL height,
-                            const size_t num_segments, const HPDF_RGBColor on_color, const double val_percent,
-                            const _Bool hide_val) {
+static void
+segment_hbar_draw(const HPDF_Doc doc, const HPDF_Page page,
+                  const HPDF_REAL xpos, const HPDF_REAL ypos, const HPDF_REAL width, const HPDF_REAL height,
+                  const size_t num_segments, const HPDF_RGBColor on_color, const size_t num_on_segments,
+                  const char *val_text) {
 
-    double _val_percent =0;
-    if( val_percent <= 1.0 && val_percent >= 0 ) {
-        _val_percent = val_percent;
-    }
     const HPDF_RGBColor segment_border_color = HPDF_COLOR_FROMRGB(128,128,128);
     const HPDF_RGBColor segment_off_color = HPDF_COLOR_FROMRGB(240,240,240);
     const HPDF_RGBColor segment_text_color = HPDF_COLOR_FROMRGB(40,40,40);
@@ -318,8 +646,6 @@ hpdftbl_widget_segment_hbar(const HPDF_Doc doc, const HPDF_Page page,
     HPDF_Page_SetRGBStroke(page,segment_border_color.r,segment_border_color.g,segment_border_color.b);
     HPDF_Page_SetRGBFill(page, on_color.r, on_color.g, on_color.b);
 
-    const size_t num_on_segments=lround(_val_percent*num_segments);
-
     HPDF_REAL x=xpos;
     HPDF_REAL y=ypos;
 
@@ -354,17 +680,15 @@ hpdftbl_widget_segment_hbar(const HPDF_Doc doc, const HPDF_Page page,
     }
     */
     
-    if( !hide_val ) {
-        char buf[8];
-        snprintf(buf,sizeof(buf),"%.0lf%%",val_percent*100);
-        HPDF_Page_TextOut(page, xpos+width+5, ypos+(height-fsize)/2.0+1, buf);        
+    if( val_text ) {
+        HPDF_Page_TextOut(page, xpos+width+5, ypos+(height-fsize)/2.0+1, val_text);
     }
 
     HPDF_Page_EndText(page);
 }
 
 /**
- * @brief Draw a phone strength meter
+ * @brief Draw a horizontal segment meter that can be used to visualize a discrete value
  *
  * This function can not be used directly as a canvas callback since it needs additional
  * parameters. Instead create a simple canvas callback that gives the additional parameters.
@@ -377,12 +701,55 @@ hpdftbl_widget_segment_hbar(const HPDF_Doc doc, const HPDF_Page page,
  * @param height Height of meter
  * @param num_segments Total number of segments
  * @param on_color Color for "on" segment
- * @param num_on_segments Number of on segments
+ * @param val_percent To what extent should the bars be filled (as a value 0.0 - 1.0)
+ * @param hide_val TRUE to hide the value (in percent) at the right end of the entire bar
+ * @see hpdftbl_use_widget_cache()
  */
 void
-hpdftbl_widget_strength_meter(const HPDF_Doc doc, const HPDF_Page page,
-                              const HPDF_REAL xpos, const HPDF_REAL ypos, const HPDF_REAL width, const HPDF_REAL height,
-                              const size_t num_segments, const HPDF_RGBColor on_color, const size_t num_on_segments) {
+hpdftbl_widget_segment_hbar(const HPDF_Doc doc, const HPDF_Page page,
+                            const HPDF_REAL xpos, const HPDF_REAL ypos, const HPDF_REAL width, const HPDF_REAL height,
+                            const size_t num_segments, const HPDF_RGBColor on_color, const double val_percent,
+                            const _Bool hide_val) {
+    char key[WIDGET_CACHE_KEYLEN] = "";
+    hpdftbl_xobject_rec_t rec;
+    HPDF_REAL x0 = xpos, y0 = ypos;
+
+    // A value out of range is shown with all segments off
+    double _val_percent = 0;
+    if (val_percent <= 1.0 && val_percent >= 0) {
+        _val_percent = val_percent;
+    }
+    const size_t num_on_segments = lround(_val_percent * num_segments);
+    char val_text[8];
+    snprintf(val_text, sizeof(val_text), "%.0lf%%", val_percent * 100);
+
+    // The key is made from exactly what is drawn
+    if (widget_cache_used)
+        snprintf(key, sizeof(key), "segment|%.3f|%.3f|%zu|%.4f %.4f %.4f|%zu|%s", (double) width, (double) height,
+                 num_segments, _WIDGET_KEY_RGB(on_color), num_on_segments, hide_val ? "" : val_text);
+
+    switch (hpdftbl_widget_cache_begin(doc, page, key, widget_bbox(width, height, hide_val ? 0 : WIDGET_FORM_VAL_WIDTH),
+                                       xpos, ypos, &rec)) {
+        case 1:
+            return;
+        case 0:
+            x0 = y0 = 0;
+            break;
+        default:
+            break;
+    }
+    segment_hbar_draw(doc, page, x0, y0, width, height, num_segments, on_color, num_on_segments,
+                      hide_val ? NULL : val_text);
+    hpdftbl_widget_cache_end(key, xpos, ypos, &rec);
+}
+
+/**
+ * @brief Internal function. Draw the widget, see the public function.
+ */
+static void
+strength_meter_draw(const HPDF_Doc doc, const HPDF_Page page,
+                    const HPDF_REAL xpos, const HPDF_REAL ypos, const HPDF_REAL width, const HPDF_REAL height,
+                    const size_t num_segments, const HPDF_RGBColor on_color, const size_t num_on_segments) {
 
     const HPDF_RGBColor segment_border_color = HPDF_COLOR_FROMRGB(128,128,128);
     const HPDF_RGBColor segment_off_color = HPDF_COLOR_FROMRGB(240,240,240);
@@ -417,6 +784,347 @@ hpdftbl_widget_strength_meter(const HPDF_Doc doc, const HPDF_Page page,
     HPDF_Page_FillStroke(page);
 }
 
+/**
+ * @brief Draw a phone strength meter
+ *
+ * This function can not be used directly as a canvas callback since it needs additional
+ * parameters. Instead create a simple canvas callback that gives the additional parameters.
+ *
+ * @param doc HPDF Document handle
+ * @param page HPDF Page handle
+ * @param xpos Lower left x
+ * @param ypos Lower left y
+ * @param width Width of meter
+ * @param height Height of meter
+ * @param num_segments Total number of segments
+ * @param on_color Color for "on" segment
+ * @param num_on_segments Number of on segments
+ * @see hpdftbl_use_widget_cache()
+ */
+void
+hpdftbl_widget_strength_meter(const HPDF_Doc doc, const HPDF_Page page,
+                              const HPDF_REAL xpos, const HPDF_REAL ypos, const HPDF_REAL width, const HPDF_REAL height,
+                              const size_t num_segments, const HPDF_RGBColor on_color, const size_t num_on_segments) {
+    char key[WIDGET_CACHE_KEYLEN] = "";
+    hpdftbl_xobject_rec_t rec;
+    HPDF_REAL x0 = xpos, y0 = ypos;
+
+    if (widget_cache_used)
+        snprintf(key, sizeof(key), "strength|%.3f|%.3f|%zu|%.4f %.4f %.4f|%zu", (double) width, (double) height,
+                 num_segments, _WIDGET_KEY_RGB(on_color), num_on_segments);
+
+    switch (hpdftbl_widget_cache_begin(doc, page, key, widget_bbox(width, height, 0), xpos, ypos, &rec)) {
+        case 1:
+            return;
+        case 0:
+            x0 = y0 = 0;
+            break;
+        default:
+            break;
+    }
+    strength_meter_draw(doc, page, x0, y0, width, height, num_segments, on_color, num_on_segments);
+    hpdftbl_widget_cache_end(key, xpos, ypos, &rec);
+}
+
+/*-----------------------------------------------------------------------
+ * Chart widgets.
+ *
+ * The chart widgets take an array of values of any length. To keep the size
+ * of the drawn paths bounded the values are downsampled to at most one point
+ * per point (1/72 inch) of the widget width. Apart from a first pass to find
+ * the range of values the downsampling is done while the path is drawn so no
+ * extra memory is needed.
+ */
+
+/**
+ * @brief Internal function. Find the smallest and largest value.
+ * @param values Array of values
+ * @param num_values Number of values
+ * @param vmin Smallest value
+ * @param vmax Largest value
+ */
+static void
+chart_value_range(const double *values, const size_t num_values, double *vmin, double *vmax) {
+    *vmin = *vmax = values[0];
+    for (size_t i = 1; i < num_values; i++) {
+        if (values[i] < *vmin)
+            *vmin = values[i];
+        else if (values[i] > *vmax)
+            *vmax = values[i];
+    }
+}
+
+/**
+ * @brief Internal function. Calculate the scale factor from values to points.
+ * @param vmin Smallest value
+ * @param vmax Largest value
+ * @param height Available height
+ * @return Scale factor. 0 if all values are equal.
+ */
+static double
+chart_scale(const double vmin, const double vmax, const HPDF_REAL height) {
+    return vmax > vmin ? height / (vmax - vmin) : 0;
+}
+
+/**
+ * @brief Draw a sparkline, i.e. a small line chart without axis, of an array of values
+ *
+ * The values are downsampled with the Largest-Triangle-Three-Buckets (LTTB) algorithm
+ * to at most one point per point of width. LTTB keeps the visual shape of the line,
+ * including peaks, much better than just picking every n:th value.
+ *
+ * This function can not be used directly as a canvas callback since it needs additional
+ * parameters. Instead create a simple canvas callback that gives the additional parameters.
+ *
+ * @param doc HPDF Document handle
+ * @param page HPDF Page handle
+ * @param xpos Lower left x
+ * @param ypos Lower left y
+ * @param width Width of chart
+ * @param height Height of chart
+ * @param color Line color
+ * @param values The values. All values must be finite.
+ * @param num_values Number of values
+ */
+void
+hpdftbl_widget_sparkline(const HPDF_Doc doc, const HPDF_Page page,
+                         const HPDF_REAL xpos, const HPDF_REAL ypos, const HPDF_REAL width, const HPDF_REAL height,
+                         const HPDF_RGBColor color, const double *values, const size_t num_values) {
+    if (values == NULL || num_values < 2 || width <= 0)
+        return;
+
+    const HPDF_REAL line_width = 0.8;
+    double vmin, vmax;
+    chart_value_range(values, num_values, &vmin, &vmax);
+    const double yscale = chart_scale(vmin, vmax, height - line_width);
+    const double xscale = width / (double) (num_values - 1);
+    // A flat line is drawn in the middle
+    const double y0 = yscale > 0 ? ypos + line_width / 2 : ypos + height / 2;
+
+#define _SPARK_X(i) (HPDF_REAL) (xpos + (double) (i) * xscale)
+#define _SPARK_Y(v) (HPDF_REAL) (y0 + ((v) - vmin) * yscale)
+
+    HPDF_Page_SetLineWidth(page, line_width);
+    HPDF_Page_SetRGBStroke(page, color.r, color.g, color.b);
+    HPDF_Page_MoveTo(page, _SPARK_X(0), _SPARK_Y(values[0]));
+
+    const size_t num_points = width < 3 ? 3 : (size_t) width;
+    if (num_values <= num_points) {
+        for (size_t i = 1; i < num_values; i++) {
+            HPDF_Page_LineTo(page, _SPARK_X(i), _SPARK_Y(values[i]));
+        }
+    } else {
+        // LTTB. The first and last values are always kept and the rest are split
+        // in num_points-2 buckets. From each bucket the value forming the largest triangle
+        // with the previous selected value and the average of the next bucket is selected.
+        const double bucket_size = (double) (num_values - 2) / (double) (num_points - 2);
+        size_t a = 0;
+        for (size_t b = 0; b < num_points - 2; b++) {
+            const size_t start = (size_t) (b * bucket_size) + 1;
+            const size_t end = (size_t) ((b + 1) * bucket_size) + 1;
+            size_t next_start = end;
+            size_t next_end = (size_t) ((b + 2) * bucket_size) + 1;
+            if (next_end > num_values)
+                next_end = num_values;
+            if (next_start >= next_end)
+                next_start = next_end - 1;
+
+            double avg_x = 0, avg_y = 0;
+            for (size_t i = next_start; i < next_end; i++) {
+                avg_x += (double) i;
+                avg_y += values[i];
+            }
+            avg_x /= (double) (next_end - next_start);
+            avg_y /= (double) (next_end - next_start);
+
+            double max_area = -1;
+            size_t selected = start;
+            for (size_t i = start; i < end && i < num_values; i++) {
+                // Twice the triangle area, which is enough for comparison
+                double area = ((double) a - avg_x) * (values[i] - values[a]) -
+                              ((double) a - (double) i) * (avg_y - values[a]);
+                if (area < 0)
+                    area = -area;
+                if (area > max_area) {
+                    max_area = area;
+                    selected = i;
+                }
+            }
+            HPDF_Page_LineTo(page, _SPARK_X(selected), _SPARK_Y(values[selected]));
+            a = selected;
+        }
+        HPDF_Page_LineTo(page, _SPARK_X(num_values - 1), _SPARK_Y(values[num_values - 1]));
+    }
+    HPDF_Page_Stroke(page);
+
+#undef _SPARK_X
+#undef _SPARK_Y
+}
+
+/**
+ * @brief Draw a small bar chart of an array of values
+ *
+ * The bars start from 0 so positive values goes up and negative values goes down. If there
+ * are more values than fits with a bar width of at least @ref HPDFTBL_MINIBAR_MIN_WIDTH the
+ * values are split into buckets and each bar shows the value in the bucket furthest from 0.
+ *
+ * This function can not be used directly as a canvas callback since it needs additional
+ * parameters. Instead create a simple canvas callback that gives the additional parameters.
+ *
+ * @param doc HPDF Document handle
+ * @param page HPDF Page handle
+ * @param xpos Lower left x
+ * @param ypos Lower left y
+ * @param width Width of chart
+ * @param height Height of chart
+ * @param pos_color Color for positive bars
+ * @param neg_color Color for negative bars
+ * @param values The values. All values must be finite.
+ * @param num_values Number of values
+ */
+void
+hpdftbl_widget_minibar(const HPDF_Doc doc, const HPDF_Page page,
+                       const HPDF_REAL xpos, const HPDF_REAL ypos, const HPDF_REAL width, const HPDF_REAL height,
+                       const HPDF_RGBColor pos_color, const HPDF_RGBColor neg_color,
+                       const double *values, const size_t num_values) {
+    if (values == NULL || num_values == 0 || width <= 0)
+        return;
+
+    double vmin, vmax;
+    chart_value_range(values, num_values, &vmin, &vmax);
+    if (vmin > 0)
+        vmin = 0;
+    if (vmax < 0)
+        vmax = 0;
+    const double yscale = chart_scale(vmin, vmax, height);
+    const HPDF_REAL base = (HPDF_REAL) (ypos - vmin * yscale);
+
+    size_t num_bars = (size_t) (width / HPDFTBL_MINIBAR_MIN_WIDTH);
+    if (num_bars == 0)
+        num_bars = 1;
+    if (num_bars > num_values)
+        num_bars = num_values;
+    const HPDF_REAL bar_step = width / num_bars;
+    const HPDF_REAL bar_width = bar_step * 0.8f;
+
+    // Draw all positive bars as one path and then all negative bars
+    for (int sign = 1; sign >= -1; sign -= 2) {
+        const HPDF_RGBColor color = sign > 0 ? pos_color : neg_color;
+        _Bool has_bars = FALSE;
+        for (size_t b = 0; b < num_bars; b++) {
+            const size_t start = b * num_values / num_bars;
+            const size_t end = (b + 1) * num_values / num_bars;
+            double v = values[start];
+            for (size_t i = start + 1; i < end; i++) {
+                if (fabs(values[i]) > fabs(v))
+                    v = values[i];
+            }
+            if ((sign > 0 && v > 0) || (sign < 0 && v < 0)) {
+                HPDF_Page_Rectangle(page, xpos + b * bar_step + (bar_step - bar_width) / 2, base,
+                                    bar_width, (HPDF_REAL) (v * yscale));
+                has_bars = TRUE;
+            }
+        }
+        if (has_bars) {
+            HPDF_Page_SetRGBFill(page, color.r, color.g, color.b);
+            HPDF_Page_Fill(page);
+        }
+    }
+}
+
+/**
+ * @brief Draw a min/max band chart of an array of values
+ *
+ * The values are split into buckets of one point width. A band between the smallest and
+ * largest value in each bucket is drawn together with a line for the average value in each
+ * bucket. This gives a good overview of both trend and spread for very long series of values.
+ *
+ * This function can not be used directly as a canvas callback since it needs additional
+ * parameters. Instead create a simple canvas callback that gives the additional parameters.
+ *
+ * @param doc HPDF Document handle
+ * @param page HPDF Page handle
+ * @param xpos Lower left x
+ * @param ypos Lower left y
+ * @param width Width of chart
+ * @param height Height of chart
+ * @param band_color Fill color for the min/max band
+ * @param line_color Color for the average line
+ * @param values The values. All values must be finite.
+ * @param num_values Number of values
+ */
+void
+hpdftbl_widget_minmax_band(const HPDF_Doc doc, const HPDF_Page page,
+                           const HPDF_REAL xpos, const HPDF_REAL ypos, const HPDF_REAL width, const HPDF_REAL height,
+                           const HPDF_RGBColor band_color, const HPDF_RGBColor line_color,
+                           const double *values, const size_t num_values) {
+    if (values == NULL || num_values < 2 || width <= 0)
+        return;
+
+    const HPDF_REAL line_width = 0.6;
+    double vmin, vmax;
+    chart_value_range(values, num_values, &vmin, &vmax);
+    const double yscale = chart_scale(vmin, vmax, height);
+    const double y0 = yscale > 0 ? ypos : ypos + height / 2;
+
+    size_t num_buckets = (size_t) width;
+    if (num_buckets < 2)
+        num_buckets = 2;
+    if (num_buckets > num_values)
+        num_buckets = num_values;
+    const double xstep = width / (double) (num_buckets - 1);
+
+#define _BAND_START(b) ((b) * num_values / num_buckets)
+#define _BAND_END(b) (((b) + 1) * num_values / num_buckets)
+#define _BAND_X(b) (HPDF_REAL) (xpos + (double) (b) * xstep)
+#define _BAND_Y(v) (HPDF_REAL) (y0 + ((v) - vmin) * yscale)
+
+    // The band is the max values from left to right and then the min values back
+    for (size_t b = 0; b < num_buckets; b++) {
+        double m = values[_BAND_START(b)];
+        for (size_t i = _BAND_START(b) + 1; i < _BAND_END(b); i++) {
+            if (values[i] > m)
+                m = values[i];
+        }
+        if (b == 0)
+            HPDF_Page_MoveTo(page, _BAND_X(b), _BAND_Y(m));
+        else
+            HPDF_Page_LineTo(page, _BAND_X(b), _BAND_Y(m));
+    }
+    for (size_t b = num_buckets; b-- > 0;) {
+        double m = values[_BAND_START(b)];
+        for (size_t i = _BAND_START(b) + 1; i < _BAND_END(b); i++) {
+            if (values[i] < m)
+                m = values[i];
+        }
+        HPDF_Page_LineTo(page, _BAND_X(b), _BAND_Y(m));
+    }
+    HPDF_Page_ClosePath(page);
+    HPDF_Page_SetRGBFill(page, band_color.r, band_color.g, band_color.b);
+    HPDF_Page_Fill(page);
+
+    // Average line
+    HPDF_Page_SetLineWidth(page, line_width);
+    HPDF_Page_SetRGBStroke(page, line_color.r, line_color.g, line_color.b);
+    for (size_t b = 0; b < num_buckets; b++) {
+        double sum = 0;
+        for (size_t i = _BAND_START(b); i < _BAND_END(b); i++) {
+            sum += values[i];
+        }
+        const double avg = sum / (double) (_BAND_END(b) - _BAND_START(b));
+        if (b == 0)
+            HPDF_Page_MoveTo(page, _BAND_X(b), _BAND_Y(avg));
+        else
+            HPDF_Page_LineTo(page, _BAND_X(b), _BAND_Y(avg));
+    }
+    HPDF_Page_Stroke(page);
+
+#undef _BAND_START
+#undef _BAND_END
+#undef _BAND_X
+#undef _BAND_Y
+}
+
 #pragma GCC diagnostic pop
 
 /* EOF */
@@ -0,0 +1,276 @@
+/**
+ * @file
+ * @brief   Recording of drawing operations into reusable PDF Form XObjects
+ * @author   Johan Persson (johan162@gmail.com)
+ *
+ * Copyright (C) 2022 Johan Persson
+ *
+ * @see LICENSE
+ *
+ * Released under the MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <hpdf.h>
+#include "hpdftbl.h"
+
+/*-----------------------------------------------------------------------
+ * Form XObjects.
+ *
+ * libharu has no public API to draw into a Form XObject. Instead the content
+ * stream of the page is temporarily replaced with the stream of a new form so
+ * that all the ordinary HPDF_Page_xxx() drawing functions write into the form.
+ * In the same way the font and XObject resources of the page are replaced with
+ * new dictionaries which then become the resources of the form. The form will
+ * then only refer to the resources actually used in the recording.
+ * This uses the libharu object internals which are only available when the
+ * library is used as a static or non-DLL shared library (HPDF_SHARED not defined).
+ */
+
+/**
+ * @brief Start recording drawing operations on a page into a new Form XObject.
+ *
+ * All drawing done on the page after this call and until hpdftbl_xobject_end() is
+ * called is written to the form instead of the page. The drawing is done in the
+ * coordinate system of the form, i.e. the lower left corner of the form is (0,0)
+ * and anything outside the bounding box is cut. The recorded form can then be placed
+ * any number of times, on any page in the same document, with hpdftbl_xobject_place().
+ * The PDF file only holds one copy of the drawing operations.
+ *
+ * Recordings can not be nested on the same page.
+ *
+ * @param pdf_doc The HPDF document handle
+ * @param page The page to record from. Nothing is written to the page.
+ * @param bbox Bounding box of the form in form coordinates
+ * @param rec Recording state to be passed to hpdftbl_xobject_end()
+ * @return The new form, NULL if the form could not be created
+ * @see hpdftbl_xobject_end(), hpdftbl_xobject_place()
+ */
+HPDF_XObject
+hpdftbl_xobject_begin(HPDF_Doc pdf_doc, HPDF_Page page, HPDF_Rect bbox, hpdftbl_xobject_rec_t *rec) {
+    if (pdf_doc == NULL || page == NULL || rec == NULL) {
+        _HPDFTBL_SET_ERR(NULL, -17, -1, -1);
+        return NULL;
+    }
+    memset(rec, 0, sizeof(*rec));
+
+#ifdef HPDF_SHARED
+    _HPDFTBL_SET_ERR(NULL, -17, -1, -1);
+    return NULL;
+#else
+    HPDF_PageAttr attr = (HPDF_PageAttr) page->attr;
+    HPDF_Dict form = HPDF_DictStream_New(pdf_doc->mmgr, pdf_doc->xref);
+    if (form == NULL) {
+        _HPDFTBL_SET_ERR(NULL, -17, -1, -1);
+        return NULL;
+    }
+    form->header.obj_class |= HPDF_OSUBCLASS_XOBJECT;
+    // Use the same compression as the page content
+    form->filter = attr->contents->filter;
+
+    HPDF_Dict fonts = HPDF_Dict_New(pdf_doc->mmgr);
+    HPDF_Dict xobjects = HPDF_Dict_New(pdf_doc->mmgr);
+    HPDF_Dict res = HPDF_Dict_New(pdf_doc->mmgr);
+    if (fonts == NULL || xobjects == NULL || res == NULL) {
+        _HPDFTBL_SET_ERR(NULL, -17, -1, -1);
+        return NULL;
+    }
+
+    HPDF_Box box;
+    box.left = bbox.left;
+    box.bottom = bbox.bottom;
+    box.right = bbox.right;
+    box.top = bbox.top;
+    HPDF_STATUS ret = HPDF_Dict_AddName(form, "Type", "XObject");
+    ret += HPDF_Dict_AddName(form, "Subtype", "Form");
+    ret += HPDF_Dict_Add(form, "BBox", HPDF_Box_Array_New(pdf_doc->mmgr, box));
+    ret += HPDF_Dict_Add(res, "Font", fonts);
+    ret += HPDF_Dict_Add(res, "XObject", xobjects);
+    ret += HPDF_Dict_Add(form, "Resources", res);
+    if (ret != HPDF_OK) {
+        _HPDFTBL_SET_ERR(NULL, -17, -1, -1);
+        return NULL;
+    }
+
+    rec->pdf_doc = pdf_doc;
+    rec->pdf_page = page;
+    rec->xobject = form;
+    rec->page_stream = attr->stream;
+    rec->page_fonts = attr->fonts;
+    rec->page_xobjects = attr->xobjects;
+    attr->stream = form->stream;
+    attr->fonts = fonts;
+    attr->xobjects = xobjects;
+
+    // Save and restore the graphic state within the form so the state
+    // kept by libharu for the page is unchanged after the recording
+    HPDF_Page_GSave(page);
+    return form;
+#endif
+}
+
+/**
+ * @brief Stop recording drawing operations started with hpdftbl_xobject_begin().
+ *
+ * The page is restored to write to its own content and resources again.
+ *
+ * @param rec Recording state from hpdftbl_xobject_begin()
+ * @return The recorded form, NULL on error
+ * @see hpdftbl_xobject_begin(), hpdftbl_xobject_place()
+ */
+HPDF_XObject
+hpdftbl_xobject_end(hpdftbl_xobject_rec_t *rec) {
+    if (rec == NULL || rec->xobject == NULL) {
+        _HPDFTBL_SET_ERR(NULL, -17, -1, -1);
+        return NULL;
+    }
+
+#ifdef HPDF_SHARED
+    _HPDFTBL_SET_ERR(NULL, -17, -1, -1);
+    return NULL;
+#else
+    HPDF_PageAttr attr = (HPDF_PageAttr) rec->pdf_page->attr;
+    HPDF_Page_GRestore(rec->pdf_page);
+    attr->stream = (HPDF_Stream) rec->page_stream;
+    attr->fonts = (HPDF_Dict) rec->page_fonts;
+    attr->xobjects = (HPDF_Dict) rec->page_xobjects;
+
+    HPDF_XObject form = rec->xobject;
+    memset(rec, 0, sizeof(*rec));
+    return form;
+#endif
+}
+
+/**
+ * @brief Place a recorded Form XObject on a page.
+ *
+ * The form coordinate (0,0) is placed at the specified position.
+ *
+ * @param page Page to place the form on
+ * @param xobject Form from hpdftbl_xobject_end()
+ * @param xpos X-position on page
+ * @param ypos Y-position on page
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_xobject_begin()
+ */
+int
+hpdftbl_xobject_place(HPDF_Page page, HPDF_XObject xobject, HPDF_REAL xpos, HPDF_REAL ypos) {
+    if (page == NULL || xobject == NULL) {
+        _HPDFTBL_SET_ERR(NULL, -17, -1, -1);
+        return -1;
+    }
+    HPDF_Page_GSave(page);
+    HPDF_Page_Concat(page, 1, 0, 0, 1, xpos, ypos);
+    const HPDF_STATUS ret = HPDF_Page_ExecuteXObject(page, xobject);
+    HPDF_Page_GRestore(page);
+    if (ret != HPDF_OK) {
+        _HPDFTBL_SET_ERR(NULL, -17, -1, -1);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Extra space around a table in its form to not cut the outer grid lines
+ */
+#define STAMP_FORM_PAD 5.0f
+
+/**
+ * @brief Render a table once into a Form XObject that can be placed on any page.
+ *
+ * This is useful for a static table, e.g. a legend or terms, that is repeated on many
+ * pages in a document. The PDF will only hold one copy of the table and each placement
+ * is just a reference to it. The table is laid out in the same way as with hpdftbl_stroke()
+ * and all callbacks are called once when the stamp is created. The table can be destroyed
+ * once the stamp has been created.
+ *
+ * @param pdf_doc The HPDF document handle
+ * @param page A page in the document. Nothing is written to the page.
+ * @param t Table handle
+ * @param width Width of table
+ * @param height Height of table. If 0 the height is calculated
+ * @param stamp The created stamp
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_stamp_place()
+ */
+int
+hpdftbl_stamp_create(HPDF_Doc pdf_doc, HPDF_Page page, hpdftbl_t t, HPDF_REAL width, HPDF_REAL height,
+                     hpdftbl_stamp_t *stamp) {
+    _HPDFTBL_CHK_TABLE(t);
+    if (stamp == NULL) {
+        _HPDFTBL_SET_ERR(t, -17, -1, -1);
+        return -1;
+    }
+    memset(stamp, 0, sizeof(*stamp));
+
+    hpdftbl_layout_t layout;
+    if (hpdftbl_layout(pdf_doc, t, width, height, &layout))
+        return -1;
+
+    // The form has the lower left corner of the table at (0,0)
+    HPDF_Rect bbox;
+    bbox.left = -STAMP_FORM_PAD;
+    bbox.bottom = -STAMP_FORM_PAD;
+    bbox.right = layout.width + STAMP_FORM_PAD;
+    bbox.top = layout.total_height + STAMP_FORM_PAD;
+
+    hpdftbl_xobject_rec_t rec;
+    if (NULL == hpdftbl_xobject_begin(pdf_doc, page, bbox, &rec))
+        return -1;
+    const int ret = hpdftbl_stroke_layout(pdf_doc, page, t, 0, t->anchor_is_top_left ? layout.total_height : 0);
+    HPDF_XObject xobject = hpdftbl_xobject_end(&rec);
+    if (ret || xobject == NULL)
+        return -1;
+
+    stamp->xobject = xobject;
+    stamp->width = layout.width;
+    stamp->height = layout.total_height;
+    stamp->anchor_is_top_left = t->anchor_is_top_left;
+    return 0;
+}
+
+/**
+ * @brief Place a table stamp on a page.
+ *
+ * The position is interpreted in the same way as for hpdftbl_stroke() using
+ * the anchor the table had when the stamp was created.
+ *
+ * @param page Page to place the table on
+ * @param stamp Stamp created with hpdftbl_stamp_create()
+ * @param xpos X-position of table
+ * @param ypos Y-position of table
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_stamp_create()
+ */
+int
+hpdftbl_stamp_place(HPDF_Page page, const hpdftbl_stamp_t *stamp, HPDF_REAL xpos, HPDF_REAL ypos) {
+    if (stamp == NULL) {
+        _HPDFTBL_SET_ERR(NULL, -17, -1, -1);
+        return -1;
+    }
+    return hpdftbl_xobject_place(page, stamp->xobject, xpos,
+                                 stamp->anchor_is_top_left ? ypos - stamp->height : ypos);
+}
+
+/* EOF */
@@ -29,33 +29,170 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !(defined _WIN32 || defined __WIN32__)
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#endif
+
 #include <hpdf.h>
 #include "hpdftbl.h"
+
 /**
  * @brief Read content of file into a specified buffer
+ *
+ * The file is read in one go and the buffer is NULL terminated. Since the
+ * size of the buffer must be known in advance this is mostly useful for
+ * small files. For files of arbitrary size use hpdftbl_map_file() instead.
+ *
  * @param buff Destination buffer
  * @param buffsize Size of buffer
  * @param filename Name of file to read from
- * @return -1 on failure, 0 on success
+ * @return -1 on failure, -2 if the file is larger than the buffer, 0 on success
+ * @see hpdftbl_map_file()
  */
 int
 hpdftbl_read_file(char *buff, size_t buffsize, char *filename) {
+    if (buffsize == 0)
+        return -2;
+
     FILE *fh = fopen(filename, "r");
     if (fh == NULL) {
         return -1;
     }
 
-    const int linesize = 1024;
-    char line[linesize];
+    size_t len = fread(buff, sizeof(char), buffsize - 1, fh);
+    buff[len] = '\0';
+    if (ferror(fh)) {
+        fclose(fh);
+        return -1;
+    }
+    if (len == buffsize - 1 && fgetc(fh) != EOF) {
+        // Truncation error
+        fclose(fh);
+        return -2;
+    }
+
+    fclose(fh);
+    return 0;
+}
+
+/**
+ * @brief Map the entire content of a file into memory read-only.
+ *
+ * On POSIX systems the file is mapped with `mmap()` so no copy of the data is made
+ * and there is no upper limit on the file size. On other systems the file is read
+ * with a single `fread()` into a buffer that is allocated with the exact size of the
+ * file as reported by the OS.
+ *
+ * The returned buffer is **not** NULL terminated and must be released with
+ * hpdftbl_unmap_file() using the same size as was returned.
+ *
+ * *Example:*
+ * ```c
+ * char *buff;
+ * size_t size;
+ * if( 0 == hpdftbl_map_file("mytable.json", &buff, &size) ) {
+ *     // ... use buff[0] to buff[size-1]
+ *     hpdftbl_unmap_file(buff, size);
+ * }
+ * ```
+ *
+ * @param filename Name of file to map
+ * @param[out] buff Set to point to the file content. Set to NULL for an empty file.
+ * @param[out] size Set to the size of the file in bytes
+ * @return 0 on success, -1 on failure
+ * @see hpdftbl_unmap_file()
+ */
+int
+hpdftbl_map_file(const char *filename, char **buff, size_t *size) {
+    *buff = NULL;
+    *size = 0;
+
+#if !(defined _WIN32 || defined __WIN32__)
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return -1;
+    }
+
+    if (st.st_size > 0) {
+        void *p = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            return -1;
+        }
+        *buff = (char *) p;
+        *size = (size_t) st.st_size;
+    }
 
-    while (fgets(line, linesize, fh) != NULL) {
-        if (xstrlcat(buff, line, buffsize) >= buffsize) {
-            // Truncation error
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+    return 0;
+
+#else
+
+    FILE *fh = fopen(filename, "rb");
+    if (fh == NULL)
+        return -1;
+
+    if (fseek(fh, 0, SEEK_END) != 0) {
+        fclose(fh);
+        return -1;
+    }
+    long len = ftell(fh);
+    if (len < 0 || fseek(fh, 0, SEEK_SET) != 0) {
+        fclose(fh);
+        return -1;
+    }
+
+    if (len > 0) {
+        char *p = hpdftbl_malloc((size_t) len);
+        if (p == NULL) {
+            fclose(fh);
+            return -1;
+        }
+        if (fread(p, sizeof(char), (size_t) len, fh) != (size_t) len) {
+            hpdftbl_free(p);
             fclose(fh);
-            return -2;
+            return -1;
         }
+        *buff = p;
+        *size = (size_t) len;
     }
 
     fclose(fh);
     return 0;
+
+#endif
+}
+
+/**
+ * @brief Release a file buffer previously returned by hpdftbl_map_file()
+ *
+ * @param buff Buffer returned by hpdftbl_map_file(). May be NULL.
+ * @param size Size returned by hpdftbl_map_file()
+ * @see hpdftbl_map_file()
+ */
+void
+hpdftbl_unmap_file(char *buff, size_t size) {
+    if (buff == NULL)
+        return;
+#if !(defined _WIN32 || defined __WIN32__)
+    munmap(buff, size);
+#else
+    (void) size;
+    hpdftbl_free(buff);
+#endif
 }